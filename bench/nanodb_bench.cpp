@@ -0,0 +1,273 @@
+// nanodb_bench: micro and macro benchmarks over generated data.
+//
+//   nanodb_bench [--rows N] [--min-time SECONDS] [--filter SUBSTRING]
+//
+// Prints one JSON document to stdout: the configuration, then one entry per
+// benchmark with ops/sec, ns/row and the peak resident set size reached
+// while it ran (VmHWM, reset between benchmarks where the kernel allows).
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "nanodb/nanodb.hpp"
+
+using namespace nanodb;
+
+namespace {
+
+struct Config {
+    size_t rows = 100000;
+    double minTime = 0.5;
+    std::string filter;
+};
+
+struct Result {
+    std::string name;
+    uint64_t ops = 0;           // Statements (or parses) executed
+    uint64_t rows = 0;          // Rows processed across all ops
+    double seconds = 0;
+    long peakRssKb = 0;
+};
+
+// Swallows executeSQL's acknowledgements while data is loaded
+class QuietCout {
+public:
+    QuietCout() : saved_(std::cout.rdbuf(&sink_)) {}
+    ~QuietCout() { std::cout.rdbuf(saved_); }
+
+private:
+    struct NullBuf : std::streambuf {
+        int overflow(int c) override { return c; }
+    } sink_;
+    std::streambuf* saved_;
+};
+
+void resetPeakRss() {
+    // "5" resets VmHWM (Linux 4.0+); harmless if unsupported
+    std::ofstream clear("/proc/self/clear_refs");
+    if (clear) clear << "5";
+}
+
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+class Bench {
+public:
+    explicit Bench(const Config& config) : config_(config) {}
+
+    // Repeats op until minTime has passed (at least once); op returns the
+    // number of rows it processed
+    void run(const std::string& name, const std::function<uint64_t()>& op) {
+        if (!config_.filter.empty() && name.find(config_.filter) == std::string::npos) return;
+
+        resetPeakRss();
+        Result result;
+        result.name = name;
+        auto start = std::chrono::steady_clock::now();
+        do {
+            result.rows += op();
+            ++result.ops;
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (result.seconds < config_.minTime);
+        result.peakRssKb = peakRssKb();
+        results_.push_back(result);
+        std::cerr << name << ": " << result.ops << " ops in " << result.seconds << " s\n";
+    }
+
+    void printJson() const {
+        std::printf("{\n  \"rows\": %zu,\n  \"min_time\": %.3f,\n  \"benchmarks\": [\n",
+                    config_.rows, config_.minTime);
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            double opsPerSec = r.ops / r.seconds;
+            double nsPerRow = r.rows > 0 ? r.seconds * 1e9 / static_cast<double>(r.rows) : 0.0;
+            std::printf("    {\"name\": \"%s\", \"ops\": %llu, \"rows\": %llu, \"seconds\": %.6f, "
+                        "\"ops_per_sec\": %.3f, \"ns_per_row\": %.3f, \"peak_rss_kb\": %ld}%s\n",
+                        r.name.c_str(), static_cast<unsigned long long>(r.ops),
+                        static_cast<unsigned long long>(r.rows), r.seconds, opsPerSec, nsPerRow,
+                        r.peakRssKb, i + 1 < results_.size() ? "," : "");
+        }
+        std::printf("  ],\n  \"peak_rss_kb\": %ld\n}\n", peakRssKb());
+    }
+
+private:
+    const Config& config_;
+    std::vector<Result> results_;
+};
+
+// Loads rows (id, grp, val, name) with id = 0..rows-1, grp = id % groups
+void loadTable(NanoDB& db, const std::string& table, size_t rows, size_t groups, uint32_t seed) {
+    QuietCout quiet;
+    db.executeSQL("CREATE TABLE " + table + " (id INT, grp INT, val INT, name STRING)");
+    std::mt19937 rng(seed);
+    const size_t kBatch = 1000;
+    for (size_t start = 0; start < rows; start += kBatch) {
+        std::string sql = "INSERT INTO " + table + " VALUES ";
+        for (size_t id = start; id < std::min(rows, start + kBatch); ++id) {
+            if (id > start) sql += ", ";
+            sql += "(" + std::to_string(id) + ", " + std::to_string(id % groups) + ", " +
+                   std::to_string(rng() % 1000000) + ", 'name" + std::to_string(rng() % 10000) + "')";
+        }
+        db.executeSQL(sql);
+    }
+}
+
+uint64_t runQuery(NanoDB& db, const std::string& sql) {
+    ResultSet rs = db.query(sql);
+    if (!rs.ok()) {
+        std::cerr << "benchmark query failed: " << sql << ": " << rs.error() << "\n";
+        std::exit(1);
+    }
+    return rs.rowCount();
+}
+
+void benchParser(Bench& bench) {
+    const std::vector<std::string> statements = {
+        "SELECT id, name FROM t WHERE val > 100 AND grp = 3 ORDER BY id DESC LIMIT 10",
+        "INSERT INTO t VALUES (1, 2, 3, 'some text'), (4, 5, 6, 'more text')",
+        "UPDATE t SET val = 10, name = 'x' WHERE id IN (1, 2, 3, 4, 5)",
+        "SELECT grp, COUNT(*), SUM(val) FROM t GROUP BY grp HAVING COUNT(*) > 5",
+        "SELECT a.id, b.val FROM a LEFT JOIN b ON a.id = b.id WHERE a.val < 50",
+    };
+    bench.run("parser/mixed", [&]() -> uint64_t {
+        for (const auto& sql : statements) {
+            if (!SQLParser::parse(sql)) std::exit(1);
+        }
+        return statements.size();
+    });
+}
+
+void benchInsert(Bench& bench, size_t rows) {
+    bench.run("insert/single_row", [&]() -> uint64_t {
+        NanoDB db;
+        QuietCout quiet;
+        db.executeSQL("CREATE TABLE t (id INT, name STRING)");
+        size_t n = std::min<size_t>(rows, 20000);
+        for (size_t i = 0; i < n; ++i) {
+            db.executeSQL("INSERT INTO t VALUES (" + std::to_string(i) + ", 'row')");
+        }
+        return n;
+    });
+    bench.run("insert/single_row_in_transaction", [&]() -> uint64_t {
+        NanoDB db;
+        QuietCout quiet;
+        db.executeSQL("CREATE TABLE t (id INT, name STRING)");
+        size_t n = std::min<size_t>(rows, 20000);
+        db.executeSQL("BEGIN");
+        for (size_t i = 0; i < n; ++i) {
+            db.executeSQL("INSERT INTO t VALUES (" + std::to_string(i) + ", 'row')");
+        }
+        db.executeSQL("COMMIT");
+        return n;
+    });
+    bench.run("insert/multi_row_1000", [&]() -> uint64_t {
+        NanoDB db;
+        loadTable(db, "t", rows, 100, 1);
+        return rows;
+    });
+    bench.run("insert/prepared", [&]() -> uint64_t {
+        NanoDB db;
+        QuietCout quiet;
+        db.executeSQL("CREATE TABLE t (id INT, name STRING)");
+        auto stmt = db.prepare("INSERT INTO t VALUES (?, ?)");
+        size_t n = std::min<size_t>(rows, 20000);
+        for (size_t i = 0; i < n; ++i) {
+            db.execute(*stmt, {Value(static_cast<int>(i)), Value(std::string("row"))});
+        }
+        return n;
+    });
+}
+
+void benchScans(Bench& bench, size_t rows) {
+    NanoDB db;
+    loadTable(db, "t", rows, 100, 2);
+    // ns/row is per table row scanned, or per row returned for lookups
+    auto scan = [&](const std::string& name, const std::string& sql, bool perResultRow = false) {
+        bench.run(name, [&]() -> uint64_t {
+            uint64_t returned = runQuery(db, sql);
+            return perResultRow ? returned : rows;
+        });
+    };
+    scan("scan/filter_1pct", "SELECT id, val FROM t WHERE val < 10000");
+    scan("scan/filter_50pct", "SELECT id, val FROM t WHERE val < 500000");
+    scan("scan/filter_and_or", "SELECT * FROM t WHERE grp = 7 AND val > 1000 OR id < 100");
+    scan("scan/order_by_limit", "SELECT * FROM t ORDER BY val DESC LIMIT 10");
+    scan("scan/distinct", "SELECT DISTINCT grp FROM t");
+    scan("scan/count_where", "SELECT COUNT(*) FROM t WHERE val > 250000");
+
+    {
+        QuietCout quiet;
+        db.executeSQL("CREATE INDEX t_id ON t (id) USING HASH");
+    }
+    scan("scan/point_lookup_hash", "SELECT * FROM t WHERE id = " + std::to_string(rows / 2), true);
+}
+
+void benchGroupBy(Bench& bench, size_t rows) {
+    for (size_t groups : {10, 1000, 100000}) {
+        if (groups > rows) continue;
+        NanoDB db;
+        loadTable(db, "t", rows, groups, 3);
+        bench.run("group_by/groups_" + std::to_string(groups), [&]() -> uint64_t {
+            runQuery(db, "SELECT grp, COUNT(*), SUM(val) FROM t GROUP BY grp");
+            return rows;
+        });
+    }
+}
+
+void benchJoins(Bench& bench, size_t rows) {
+    for (size_t inner : {size_t(100), rows / 10, rows}) {
+        if (inner == 0) continue;
+        NanoDB db;
+        loadTable(db, "a", rows, 100, 4);
+        loadTable(db, "b", inner, 100, 5);
+        bench.run("join/inner_" + std::to_string(rows) + "x" + std::to_string(inner), [&]() -> uint64_t {
+            runQuery(db, "SELECT a.id, b.val FROM a JOIN b ON a.id = b.id");
+            return rows + inner;
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rows" && i + 1 < argc) {
+            config.rows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            config.minTime = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            config.filter = argv[++i];
+        } else {
+            std::cerr << "Usage: nanodb_bench [--rows N] [--min-time SECONDS] [--filter SUBSTRING]\n";
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (config.rows == 0) config.rows = 1;
+
+    Bench bench(config);
+    benchParser(bench);
+    benchInsert(bench, config.rows);
+    benchScans(bench, config.rows);
+    benchGroupBy(bench, config.rows);
+    benchJoins(bench, config.rows);
+    bench.printJson();
+    return 0;
+}
@@ -0,0 +1,215 @@
+// nanodb_loadtest: load generator for nanodb_server.
+//
+//   nanodb_loadtest [--host H] [--port N | --unix PATH] [--connections N]
+//                   [--pipeline N] [--iterations N] [--setup FILE] LOG
+//       Runs the statements of LOG (one per line; blank and -- lines are
+//       skipped) N times over, spread across client connections that each
+//       keep up to --pipeline statements in flight, and prints throughput
+//       and latency percentiles as JSON. The setup script runs first, on a
+//       connection of its own. A statement's latency runs from sending it
+//       to receiving its result, so with pipelining it includes the time
+//       spent behind the statements ahead of it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nanodb/server/client.hpp"
+#include "nanodb/server/server.hpp"
+
+using namespace nanodb;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: nanodb_loadtest [--host H] [--port N | --unix PATH] [--connections N]\n"
+              << "                       [--pipeline N] [--iterations N] [--setup FILE] LOG\n";
+}
+
+struct Target {
+    std::string host = "127.0.0.1";
+    uint16_t port = Server::kDefaultPort;
+    std::string unixPath;
+
+    bool connect(Client& client, std::string& error) const {
+        return unixPath.empty() ? client.connectTcp(host, port, error) : client.connectUnix(unixPath, error);
+    }
+};
+
+// Statements of a script or log, one per line, without trailing ';'
+bool readStatements(const std::string& path, std::vector<std::string>& statements) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error: Cannot open file '" << path << "'.\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line.compare(start, 2, "--") == 0) continue;
+        size_t end = line.find_last_not_of(" \t\r;");
+        if (end != std::string::npos && end >= start) {
+            statements.push_back(line.substr(start, end - start + 1));
+        }
+    }
+    return true;
+}
+
+double percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Target target;
+    std::string setupPath;
+    std::string logPath;
+    size_t connections = 1;
+    size_t pipeline = 1;
+    size_t iterations = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            target.host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            target.port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--unix" && i + 1 < argc) {
+            target.unixPath = argv[++i];
+        } else if (arg == "--connections" && i + 1 < argc) {
+            connections = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            pipeline = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--setup" && i + 1 < argc) {
+            setupPath = argv[++i];
+        } else if (logPath.empty() && arg[0] != '-') {
+            logPath = arg;
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (logPath.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::string> setup;
+    std::vector<std::string> log;
+    if ((!setupPath.empty() && !readStatements(setupPath, setup)) || !readStatements(logPath, log)) {
+        return 1;
+    }
+    if (log.empty()) {
+        std::cerr << "Error: No statements in '" << logPath << "'.\n";
+        return 1;
+    }
+
+    std::string error;
+    if (!setup.empty()) {
+        Client client;
+        if (!target.connect(client, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        for (const auto& sql : setup) client.send(sql);
+        while (client.pending() > 0) {
+            ResultSet result = client.receive();
+            if (!client.connected()) {
+                std::cerr << "Error: " << result.error() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    std::vector<Client> clients(connections);
+    for (auto& client : clients) {
+        if (!target.connect(client, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+
+    // Connections claim log entries from a shared counter until the
+    // requested number of executions has been handed out
+    const size_t total = log.size() * iterations;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> ready{0};
+    std::atomic<size_t> errors{0};
+    std::atomic<bool> go{false};
+    std::vector<std::vector<uint64_t>> latencies(connections);
+    std::vector<std::string> failures(connections);
+
+    std::vector<std::thread> workers;
+    for (size_t c = 0; c < connections; ++c) {
+        workers.emplace_back([&, c] {
+            Client& client = clients[c];
+            latencies[c].reserve(total / connections + 1);
+            std::deque<std::chrono::steady_clock::time_point> inFlight;
+
+            ++ready;
+            while (!go.load()) std::this_thread::yield();
+
+            size_t i = next++;
+            while (true) {
+                while (inFlight.size() < pipeline && i < total) {
+                    client.send(log[i % log.size()]);
+                    inFlight.push_back(std::chrono::steady_clock::now());
+                    i = next++;
+                }
+                if (inFlight.empty()) break;
+
+                ResultSet result = client.receive();
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - inFlight.front()).count();
+                inFlight.pop_front();
+                if (!client.connected()) {
+                    failures[c] = result.error();
+                    break;
+                }
+                if (!result.ok()) ++errors;
+                latencies[c].push_back(static_cast<uint64_t>(ns));
+            }
+        });
+    }
+    while (ready.load() < connections) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& worker : workers) worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    for (const auto& failure : failures) {
+        if (!failure.empty()) {
+            std::cerr << "Error: " << failure << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<uint64_t> all;
+    all.reserve(total);
+    for (const auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (uint64_t ns : all) sum += static_cast<double>(ns);
+
+    std::printf("{\n  \"statements\": %zu,\n  \"connections\": %zu,\n  \"pipeline\": %zu,\n"
+                "  \"executions\": %zu,\n  \"errors\": %zu,\n"
+                "  \"seconds\": %.6f,\n  \"ops_per_sec\": %.3f,\n  \"latency_us\": {\"mean\": %.3f, "
+                "\"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}\n}\n",
+                log.size(), connections, pipeline, all.size(), errors.load(), elapsed.count(),
+                static_cast<double>(all.size()) / elapsed.count(),
+                all.empty() ? 0.0 : sum / static_cast<double>(all.size()) / 1000.0,
+                percentile(all, 50), percentile(all, 90), percentile(all, 95), percentile(all, 99),
+                percentile(all, 99.9), percentile(all, 100));
+    return 0;
+}
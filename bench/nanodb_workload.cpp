@@ -0,0 +1,245 @@
+// nanodb_workload: synthetic data generation and query log replay.
+//
+//   nanodb_workload generate [--out DIR] [--scale F] [--seed N] SPEC...
+//       Writes DIR/<table>.bin (binary COPY format) for every table SPEC
+//       (see TableSpec::parse) and DIR/load.sql, which creates the tables
+//       and loads the files. Row counts are multiplied by the scale factor.
+//
+//   nanodb_workload replay [--setup FILE] [--threads N] [--iterations N] [--stats FILE] LOG
+//       Runs the statements of LOG (one per line; blank and -- lines are
+//       skipped) N times over, spread across worker threads, and prints
+//       throughput and latency percentiles as JSON. The setup script loads
+//       one database, which every worker then queries through a session of
+//       its own (see NanoDB::openSession). --stats writes the
+//       engine metrics of the replay phase (see Metrics::dump) to FILE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nanodb/nanodb.hpp"
+#include "nanodb/workload/data_generator.hpp"
+
+using namespace nanodb;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: nanodb_workload generate [--out DIR] [--scale F] [--seed N] SPEC...\n"
+              << "       nanodb_workload replay [--setup FILE] [--threads N] [--iterations N] [--stats FILE] LOG\n"
+              << "SPEC is 'table:rows col:type:dist ...' with type int|string and dist\n"
+              << "seq, uniform(N), zipf(N[,skew]) or corr(col[,spread]), e.g.\n"
+              << "  'orders:100000 id:int:seq cust:int:zipf(5000,1.1) total:int:corr(cust,100)'\n";
+}
+
+// Swallows statement acknowledgements while workers run
+class QuietCout {
+public:
+    QuietCout() : saved_(std::cout.rdbuf(&sink_)) {}
+    ~QuietCout() { std::cout.rdbuf(saved_); }
+
+private:
+    struct NullBuf : std::streambuf {
+        int overflow(int c) override { return c; }
+    } sink_;
+    std::streambuf* saved_;
+};
+
+int runGenerate(int argc, char** argv) {
+    std::string outDir = ".";
+    double scale = 1.0;
+    uint64_t seed = 42;
+    std::vector<TableSpec> specs;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--scale" && i + 1 < argc) {
+            scale = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            TableSpec spec;
+            std::string error;
+            if (!TableSpec::parse(arg, spec, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+            specs.push_back(std::move(spec));
+        }
+    }
+    if (specs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::ofstream loadScript(outDir + "/load.sql");
+    if (!loadScript) {
+        std::cerr << "Error: Cannot open file '" << outDir << "/load.sql' for writing.\n";
+        return 1;
+    }
+    for (TableSpec& spec : specs) {
+        spec.rows = static_cast<size_t>(static_cast<double>(spec.rows) * scale);
+        std::string path = outDir + "/" + spec.name + ".bin";
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        DataGenerator generator(spec, seed);
+        if (!generator.writeSnapshot(path, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << spec.name << ": " << spec.rows << " rows -> " << path << " (" << elapsed.count() << " s)\n";
+        loadScript << spec.createSQL() << ";\n"
+                   << "COPY " << spec.name << " FROM '" << path << "' (FORMAT BINARY);\n";
+    }
+    return 0;
+}
+
+// Statements of a script or log, one per line, without trailing ';'
+bool readStatements(const std::string& path, std::vector<std::string>& statements) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error: Cannot open file '" << path << "'.\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line.compare(start, 2, "--") == 0) continue;
+        size_t end = line.find_last_not_of(" \t\r;");
+        if (end != std::string::npos && end >= start) {
+            statements.push_back(line.substr(start, end - start + 1));
+        }
+    }
+    return true;
+}
+
+double percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1000.0;
+}
+
+int runReplay(int argc, char** argv) {
+    std::string setupPath;
+    std::string statsPath;
+    std::string logPath;
+    size_t threads = 1;
+    size_t iterations = 1;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--setup" && i + 1 < argc) {
+            setupPath = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsPath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (logPath.empty() && arg[0] != '-') {
+            logPath = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (logPath.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::string> setup;
+    std::vector<std::string> log;
+    if ((!setupPath.empty() && !readStatements(setupPath, setup)) || !readStatements(logPath, log)) {
+        return 1;
+    }
+    if (log.empty()) {
+        std::cerr << "Error: No statements in '" << logPath << "'.\n";
+        return 1;
+    }
+
+    // Workers claim log entries from a shared counter until the requested
+    // number of executions has been handed out
+    const size_t total = log.size() * iterations;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::vector<uint64_t>> latencies(threads);
+    std::chrono::steady_clock::time_point start;
+
+    {
+        QuietCout quiet;
+        NanoDB db;
+        db.setOutputMode(OutputMode::NONE);
+        for (const auto& sql : setup) db.executeSQL(sql);
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t, session = db.openSession()] {
+                session->setOutputMode(OutputMode::NONE);
+                latencies[t].reserve(total / threads + 1);
+
+                ++ready;
+                while (!go.load()) std::this_thread::yield();
+
+                for (size_t i = next++; i < total; i = next++) {
+                    auto begin = std::chrono::steady_clock::now();
+                    session->executeSQL(log[i % log.size()]);
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - begin).count();
+                    latencies[t].push_back(static_cast<uint64_t>(ns));
+                }
+            });
+        }
+        while (ready.load() < threads) std::this_thread::yield();
+        Metrics::reset();
+        start = std::chrono::steady_clock::now();
+        go = true;
+        for (auto& worker : workers) worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::string error;
+    if (!statsPath.empty() && !Metrics::dump(statsPath, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<uint64_t> all;
+    all.reserve(total);
+    for (const auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    double sum = 0;
+    for (uint64_t ns : all) sum += static_cast<double>(ns);
+
+    std::printf("{\n  \"statements\": %zu,\n  \"threads\": %zu,\n  \"executions\": %zu,\n"
+                "  \"seconds\": %.6f,\n  \"ops_per_sec\": %.3f,\n  \"latency_us\": {\"mean\": %.3f, "
+                "\"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}\n}\n",
+                log.size(), threads, all.size(), elapsed.count(),
+                static_cast<double>(all.size()) / elapsed.count(),
+                all.empty() ? 0.0 : sum / static_cast<double>(all.size()) / 1000.0,
+                percentile(all, 50), percentile(all, 90), percentile(all, 95), percentile(all, 99),
+                percentile(all, 99.9), percentile(all, 100));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "generate") {
+        return runGenerate(argc - 2, argv + 2);
+    }
+    if (command == "replay") {
+        return runReplay(argc - 2, argv + 2);
+    }
+    printUsage();
+    return command == "-h" || command == "--help" ? 0 : 1;
+}
@@ -1,18 +1,36 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
+#include <memory>
 #include <unordered_map>
 
 #include "nanodb/core/types.hpp"
+#include "nanodb/index/index.hpp"
 
 namespace nanodb {
 
+// Approximate heap footprint of a table, see Catalog::memoryUsage
+struct TableMemory {
+    size_t rows = 0;          // Live rows
+    size_t dataBytes = 0;     // Rows, including ended versions not yet compacted
+    size_t indexBytes = 0;    // All indexes on the table
+};
+
+// The catalog does no locking of its own: every statement that touches it
+// holds a StatementLock for its duration (see below)
 class Catalog {
 public:
     Catalog() = default;
     ~Catalog() = default; 
 
+    // Snapshots and commits for the row versions of every table
+    TransactionManager& transactions() { return transactions_; }
+
     bool createTable(const std::string& name, const std::vector<Column>& columns);
     bool dropTable(const std::string& name);
     bool tableExists(const std::string& name) const;
@@ -20,9 +38,104 @@ public:
     Table* getTable(const std::string& name);
     // Const version
     const Table* getTable(const std::string& name) const;
+    std::vector<std::string> tableNames() const;
+    // Bumped by every table or index create/drop; cached plans parsed
+    // under an older version are discarded
+    uint64_t schemaVersion() const { return schemaVersion_.load(std::memory_order_acquire); }
+
+    // Takes ownership and populates the index from the table's row versions.
+    // Returns false if the name is taken or the table does not exist.
+    bool createIndex(std::unique_ptr<Index> index);
+    bool dropIndex(const std::string& indexName);
+    bool indexExists(const std::string& indexName) const;
+    // Indexes defined on a table, in creation order (empty if none)
+    const std::vector<std::unique_ptr<Index>>& getIndexes(const std::string& tableName) const;
+    // Returns nullptr if the column has no index of that type
+    const Index* findIndex(const std::string& tableName, const std::string& column, IndexType type) const;
+
+    // Walks every row and index of the table, so cost grows with its size
+    TableMemory memoryUsage(const Table& table) const;
+
+    // Physically removes row versions no transaction can see any more and
+    // rebuilds the table's indexes; returns the number reclaimed. Needs the
+    // table to itself (StatementLock::Access::EXCLUSIVE). Tables with
+    // uncommitted writes are left alone until those transactions end.
+    size_t compactTable(Table& table);
+    // Whether enough ended versions have piled up to pay for compaction
+    bool compactionDue(const Table& table) const;
+    // Compacts every table that is due; returns the number of versions
+    // reclaimed. Without wait, tables in use right now are skipped, so it
+    // can run behind any workload without holding anything up; with wait,
+    // it queues for each due table like a VACUUM would.
+    size_t collectGarbage(bool wait = false);
+
+    // Guards the table's index structures. Writers hold it exclusively
+    // while they add entries, readers shared while they look at entries;
+    // a statement never holds it twice. Table scans do not need it.
+    std::shared_mutex& indexLatch(const std::string& tableName) const;
+
+    // Compaction threshold: at least this many ended versions...
+    static constexpr size_t kCompactionMinDeleted = 1024;
+    // ...making up at least this fraction (in percent) of the table
+    static constexpr size_t kCompactionDeletedPercent = 25;
 
 private:
+    friend class StatementLock;
+
+    // Locks of one table, see StatementLock
+    struct TableLocks {
+        std::shared_mutex table;      // Shared by statements using it, exclusive for compaction
+        std::mutex writer;            // Held by the statement writing it
+        std::shared_mutex indexes;    // See indexLatch()
+    };
+
     std::unordered_map<std::string, Table> tables_;
+    // Keyed by table name
+    std::unordered_map<std::string, std::vector<std::unique_ptr<Index>>> indexes_;
+    std::atomic<uint64_t> schemaVersion_{0};
+    TransactionManager transactions_;
+
+    // Held exclusively by schema changes, shared by everything else
+    std::shared_mutex schemaMutex_;
+    // Keyed by table name
+    std::unordered_map<std::string, std::unique_ptr<TableLocks>> tableLocks_;
+};
+
+// The locks one statement holds, released on destruction. A schema change
+// holds the whole catalog exclusively. Any other statement holds it shared,
+// plus a lock on each table it uses. Row versions (see Transaction) let
+// readers and the writer of a table run side by side, so reads and writes
+// both hold the table shared; writes also take its writer lock, one writer
+// per table at a time. Compaction moves rows and holds the table
+// exclusively. Tables are locked in name order, which rules out deadlocks
+// between statements. Locks are not reentrant: a statement takes one
+// StatementLock.
+class StatementLock {
+public:
+    enum class Mode { SHARED, SCHEMA };
+    enum class Access { READ, WRITE, EXCLUSIVE };
+
+    StatementLock() = default;
+    StatementLock(Catalog& catalog, Mode mode);
+    StatementLock(StatementLock&&) = default;
+    StatementLock& operator=(StatementLock&&) = default;
+
+    // Releases everything early
+    void unlock();
+
+    // SHARED mode only, called at most once. Unknown tables are skipped
+    // (the executor reports them); a table listed twice gets the stronger
+    // access.
+    void lockTables(std::vector<std::pair<std::string, Access>> tables);
+
+private:
+    Catalog* catalog_ = nullptr;
+    // Declared first so the catalog lock is released last
+    std::shared_lock<std::shared_mutex> shared_;
+    std::unique_lock<std::shared_mutex> schema_;
+    std::vector<std::shared_lock<std::shared_mutex>> tables_;
+    std::vector<std::unique_lock<std::shared_mutex>> exclusive_;
+    std::vector<std::unique_lock<std::mutex>> writers_;
 };
 
 } // namespace nanodb
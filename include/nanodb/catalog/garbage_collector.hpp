@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace nanodb {
+
+class Catalog;
+
+// Background thread that compacts away row versions no snapshot can see
+// any more (Catalog::collectGarbage). Rounds skip tables that are in use,
+// so a long scan merely postpones the table's compaction; every
+// kWaitEveryRounds-th round waits for them instead, so that a table never
+// free of statements is still compacted eventually.
+class GarbageCollector {
+public:
+    explicit GarbageCollector(Catalog& catalog) : catalog_(catalog) {}
+    ~GarbageCollector();
+
+    GarbageCollector(const GarbageCollector&) = delete;
+    GarbageCollector& operator=(const GarbageCollector&) = delete;
+
+    // Idempotent
+    void start();
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // Versions reclaimed so far
+    uint64_t reclaimed() const { return reclaimed_.load(std::memory_order_relaxed); }
+
+    static constexpr int kIntervalMs = 100;
+    static constexpr int kWaitEveryRounds = 10;
+
+private:
+    void run();
+
+    Catalog& catalog_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> reclaimed_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread worker_;
+};
+
+} // namespace nanodb
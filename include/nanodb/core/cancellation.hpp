@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace nanodb {
+
+// Cooperative cancellation of a running query. Whoever started the query
+// may cancel() its token from any thread, or give it a timeout. Operators
+// poll stopRequested() between batches of rows (every row group a scan
+// visits, every row group a join builds or probes) and wind down as if a
+// LIMIT had been reached; the query then fails with the token's error().
+// Executors reach the running query's token through a CancellationScope,
+// as they reach its transaction through Transaction::current().
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    // Safe from any thread
+    void cancel();
+    // Fires the token by itself timeoutMs from now
+    void setTimeout(double timeoutMs);
+    // cancel() was called or the timeout has passed
+    bool fired() const;
+    // Why the query stopped, once fired
+    std::string error() const;
+
+    // Whether the token of the query running on this thread has fired;
+    // false outside of a CancellationScope
+    static bool stopRequested();
+
+private:
+    enum State : int { ACTIVE, CANCELLED, TIMED_OUT };
+
+    mutable std::atomic<int> state_{ACTIVE};
+    std::atomic<int64_t> deadlineNs_{0};    // steady_clock; 0 for none
+    double timeoutMs_ = 0;
+};
+
+// Makes a token current on this thread for the scope's lifetime
+class CancellationScope {
+public:
+    explicit CancellationScope(const CancellationToken& token);
+    ~CancellationScope();
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+private:
+    const CancellationToken* previous_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// Process-wide budget for the intermediate state of running queries (sort
+// buffers, hash tables, group maps). Table data and indexes are not
+// charged against it. With a limit set, an operator that cannot reserve
+// what it needs fails its query instead of growing until the OOM killer
+// steps in.
+class MemoryTracker {
+public:
+    // 0 means unlimited (the default)
+    static void setLimit(size_t bytes);
+    static size_t limit();
+    // Bytes currently reserved by all queries, and the high-water mark
+    static size_t inUse();
+    static size_t peak();
+
+    // Reserves nothing and returns false if bytes would exceed the limit
+    static bool reserve(size_t bytes);
+    static void release(size_t bytes);
+};
+
+// One operator's share of the budget, released on destruction. The operator
+// reports its current footprint through fits(); the reservation grows in
+// kChunkBytes steps so the shared counter is only touched now and then.
+class MemoryReservation {
+public:
+    MemoryReservation() = default;
+    ~MemoryReservation() { MemoryTracker::release(reserved_); }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    // False once bytes no longer fit under the limit
+    bool fits(size_t bytes) { return bytes <= reserved_ || grow(bytes); }
+    size_t reserved() const { return reserved_; }
+    // Gives everything back, e.g. after freeing state to spill it
+    void reset() {
+        MemoryTracker::release(reserved_);
+        reserved_ = 0;
+    }
+
+    static constexpr size_t kChunkBytes = 1 << 20;
+
+private:
+    bool grow(size_t bytes);
+
+    size_t reserved_ = 0;
+};
+
+// Error text for a query stopped by the limit
+std::string memoryLimitError();
+
+// Approximate heap footprint of a row, counting out-of-line string storage
+size_t approxRowBytes(const Row& row);
+// Per-node overhead of a std::map/std::set (red-black tree links and
+// color) on top of the element itself
+constexpr size_t kTreeNodeBytes = 32;
+// Human-readable size, e.g. "1.5 MiB"
+std::string describeBytes(size_t bytes);
+
+} // namespace nanodb
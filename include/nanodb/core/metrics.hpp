@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// Log-linear latency histogram in the style of HdrHistogram: each power of
+// two is split into kSubBuckets linear buckets, so any recorded value is
+// reported within 1/kSubBuckets (~6%) of its true value.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    // Values up to 2^kMaxMagnitude ns (about 78 hours); larger ones are clamped
+    static constexpr size_t kMaxMagnitude = 48;
+    static constexpr size_t kBuckets = (kMaxMagnitude - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t bucketFor(uint64_t value);
+    // Midpoint of a bucket's value range
+    static uint64_t bucketValue(size_t bucket);
+
+    void add(size_t bucket, uint64_t count) { counts_[bucket] += count; total_ += count; }
+    uint64_t count() const { return total_; }
+    // Value at or below which p percent of the recorded values lie
+    uint64_t percentile(double p) const;
+
+private:
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t total_ = 0;
+};
+
+// Counters merged across all threads at the time of the snapshot
+struct MetricsSnapshot {
+    struct Statement {
+        uint64_t count = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+        LatencyHistogram latency;
+    };
+
+    std::vector<std::pair<QueryType, Statement>> statements;  // Types seen at least once
+    uint64_t rowsScanned = 0;
+    uint64_t rowsReturned = 0;
+    uint64_t bytesAllocated = 0;
+
+    // (metric, value) pairs, the rows of SHOW STATS
+    std::vector<std::pair<std::string, std::string>> rows() const;
+    std::string toJson() const;
+};
+
+// Running totals of one thread's executor work; the difference of two
+// readings is what the statements in between consumed
+struct ResourceUsage {
+    uint64_t rowsScanned = 0;
+    uint64_t rowsReturned = 0;
+    uint64_t bytesAllocated = 0;
+
+    ResourceUsage operator-(const ResourceUsage& other) const {
+        return {rowsScanned - other.rowsScanned, rowsReturned - other.rowsReturned,
+                bytesAllocated - other.bytesAllocated};
+    }
+};
+
+// Process-wide, always-on engine instrumentation. Each thread records into
+// its own shard of relaxed atomics, so recording never contends; readers
+// merge the shards. A thread's shard is folded into a shared one for
+// retired threads when it exits, so no counts are lost and memory does not
+// grow with the number of threads ever started.
+class Metrics {
+public:
+    // Wall time of one statement, by type
+    static void recordStatement(QueryType type, uint64_t nanos);
+    // Rows read by a scan versus rows handed to the result
+    static void addRows(uint64_t scanned, uint64_t returned);
+    // Bytes executors allocated for intermediate state (sort buffers, hash
+    // tables, group maps)
+    static void addBytes(uint64_t bytes);
+
+    // The calling thread's totals since it started (not cleared by reset)
+    static ResourceUsage threadUsage();
+
+    static MetricsSnapshot snapshot();
+    static void reset();
+    // Writes snapshot().toJson() to path
+    static bool dump(const std::string& path, std::string& error);
+
+    // Statement types are indexed by their QueryType value; ROLLBACK is last
+    static constexpr size_t kStatementTypes = static_cast<size_t>(QueryType::ROLLBACK) + 1;
+};
+
+// Records the lifetime of a scope as one statement of the given type
+class StatementTimer {
+public:
+    explicit StatementTimer(QueryType type) : type_(type), start_(std::chrono::steady_clock::now()) {}
+    ~StatementTimer() {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        Metrics::recordStatement(type_, static_cast<uint64_t>(nanos));
+    }
+
+    StatementTimer(const StatementTimer&) = delete;
+    StatementTimer& operator=(const StatementTimer&) = delete;
+
+private:
+    QueryType type_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Name of a statement type as shown by SHOW STATS, e.g. "select"
+const char* statementName(QueryType type);
+
+} // namespace nanodb
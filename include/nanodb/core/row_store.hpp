@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nanodb/core/value.hpp"
+
+namespace nanodb {
+
+// Lifetime of one row version: it is visible to snapshots taken at or after
+// the commit that wrote begin and before the one that wrote end. Until its
+// writer commits, a field holds the writer's transaction id instead (see
+// Transaction), which is larger than every commit timestamp.
+struct RowVersion {
+    // end of a version nobody has deleted or replaced
+    static constexpr uint64_t kLive = UINT64_MAX;
+
+    std::atomic<uint64_t> begin{0};
+    std::atomic<uint64_t> end{kLive};
+};
+
+// Append-only row storage in fixed-size chunks, with the version of each
+// row alongside it. Rows never move once appended, so readers may use rows
+// below size() while a writer appends more. Anything that moves or drops
+// rows (move(), truncate()) needs the table to itself.
+class RowStore {
+public:
+    static constexpr size_t kChunkRows = 1024;
+
+    RowStore() = default;
+    RowStore(const RowStore&) = delete;
+    RowStore& operator=(const RowStore&) = delete;
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    // Allocated slots, used or not
+    size_t capacity() const { return chunkCount_.load(std::memory_order_acquire) * kChunkRows; }
+
+    Row& operator[](size_t i) { return slot(i).row; }
+    const Row& operator[](size_t i) const { return slot(i).row; }
+    RowVersion& version(size_t i) { return slot(i).version; }
+    const RowVersion& version(size_t i) const { return slot(i).version; }
+
+    // Appends a version that begins at begin and returns its row id. One
+    // writer at a time; readers see the row once this returns.
+    size_t push_back(Row row, uint64_t begin);
+    void reserve(size_t rows);
+    // Moves row from (with its version) into slot to, for compaction
+    void move(size_t from, size_t to);
+    // Drops every row from n on
+    void truncate(size_t n);
+
+    // Slot overhead: version stamps and unused capacity, not row contents
+    size_t overheadBytes() const;
+
+private:
+    struct Slot {
+        Row row;
+        RowVersion version;
+    };
+    struct Chunk {
+        Slot slots[kChunkRows];
+    };
+    // Chunk pointers for readers. Growing replaces it with a larger copy;
+    // old copies are kept, since a reader may still be indexing into one.
+    struct Directory {
+        explicit Directory(size_t n) : capacity(n), chunks(new Chunk*[n]()) {}
+        size_t capacity;
+        std::unique_ptr<Chunk*[]> chunks;
+    };
+
+    Slot& slot(size_t i) const {
+        return directory_.load(std::memory_order_acquire)->chunks[i / kChunkRows]->slots[i % kChunkRows];
+    }
+    void addChunk();
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::vector<std::unique_ptr<Directory>> directories_;   // Current one last
+    std::atomic<Directory*> directory_{nullptr};
+    std::atomic<size_t> size_{0};
+    // Mirrors of chunks_.size() and the directories' footprint for readers
+    std::atomic<size_t> chunkCount_{0};
+    std::atomic<size_t> directoryBytes_{0};
+};
+
+} // namespace nanodb
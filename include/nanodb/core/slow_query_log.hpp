@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nanodb/core/metrics.hpp"
+
+namespace nanodb {
+
+// One statement that ran longer than the log's threshold
+struct SlowQueryEntry {
+    std::string sql;
+    std::chrono::system_clock::time_point startedAt;
+    uint64_t nanos = 0;
+    ResourceUsage usage;              // Executor work of this statement alone
+    std::vector<std::string> plan;    // EXPLAIN ANALYZE lines; empty unless a SELECT
+};
+
+// Appends slow statements to a file. The query thread only queues the
+// entry; a background thread formats and writes it, so a slow disk never
+// adds to statement latency. When the writer falls kMaxPending entries
+// behind, new entries are dropped and counted instead of blocking.
+class SlowQueryLog {
+public:
+    SlowQueryLog() = default;
+    ~SlowQueryLog();
+
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    // Appends to path; statements taking at least thresholdMs are logged
+    bool open(const std::string& path, double thresholdMs, std::string& error);
+    // Writes out queued entries and stops the writer
+    void close();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    bool isSlow(uint64_t nanos) const { return nanos >= thresholdNanos_.load(std::memory_order_relaxed); }
+
+    void record(SlowQueryEntry entry);
+    // Entries lost because the queue was full
+    uint64_t dropped() const;
+
+    static constexpr size_t kMaxPending = 1024;
+
+private:
+    void run();
+    // close() without taking controlMutex_
+    void stop();
+
+    std::ofstream out_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> thresholdNanos_{0};
+    // Serializes open() and close(), which sessions may call concurrently
+    std::mutex controlMutex_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<SlowQueryEntry> pending_;
+    uint64_t dropped_ = 0;
+    bool stopping_ = false;
+    std::thread writer_;
+};
+
+} // namespace nanodb
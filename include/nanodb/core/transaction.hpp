@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "nanodb/core/row_store.hpp"
+
+namespace nanodb {
+
+struct Table;
+class TransactionManager;
+
+// A snapshot of the database plus the row versions written under it. The
+// transaction sees versions committed at or before its snapshot, and its
+// own writes; it stamps what it writes with its id, so nobody else sees
+// those versions until commit replaces the id with the commit timestamp.
+// The versions it created and ended form its undo log. Executors reach the
+// running statement's transaction through current().
+//
+// Two transactions ending the same version conflict: the first one wins
+// and the second's expire() fails (snapshot isolation's first-updater
+// rule), after which the loser can only roll back.
+class Transaction {
+public:
+    // Transaction ids start here, above every commit timestamp
+    static constexpr uint64_t kFirstId = uint64_t{1} << 63;
+
+    // Unstarted; reads the latest committed state. See TransactionManager::begin.
+    Transaction() = default;
+    // Starts right away
+    explicit Transaction(TransactionManager& manager);
+    // Rolls back unless committed
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    uint64_t snapshot() const { return snapshot_; }
+    uint64_t id() const { return id_; }
+    bool active() const { return manager_ != nullptr; }
+    bool hasWrites() const { return !created_.empty() || !expired_.empty(); }
+    // An expire() failed; commit() would lose the other writer's update
+    bool conflicted() const { return conflicted_; }
+
+    bool sees(const RowVersion& version) const {
+        uint64_t begin = version.begin.load(std::memory_order_acquire);
+        if (begin > snapshot_ && begin != id_) return false;
+        uint64_t end = version.end.load(std::memory_order_acquire);
+        return end > snapshot_ && end != id_;
+    }
+
+    // Writes, for the one writer of the table: append a new version, end a
+    // visible one. Both take effect for others at commit. expire() returns
+    // false, and marks the transaction conflicted, if another transaction
+    // has ended the version since this one's snapshot or is about to.
+    size_t append(Table& table, Row row);
+    bool expire(Table& table, size_t rowId);
+
+    // The transaction of the statement running on this thread; outside of
+    // statements, a view of the latest committed state
+    static const Transaction& current();
+    // The running statement's transaction, or nullptr outside of statements
+    static Transaction* running();
+
+private:
+    friend class TransactionManager;
+
+    // Registers the transaction in table.pendingWriters on its first write there
+    void track(Table& table);
+
+    TransactionManager* manager_ = nullptr;
+    uint64_t snapshot_ = kFirstId - 1;
+    uint64_t id_ = 0;
+    bool conflicted_ = false;
+    std::vector<std::pair<Table*, size_t>> created_;
+    std::vector<std::pair<Table*, size_t>> expired_;
+    std::vector<Table*> tables_;    // Tables written, in first-write order
+    Table* lastTable_ = nullptr;    // Most recent track() hit
+};
+
+// Makes txn the current() transaction of this thread for its lifetime
+class TransactionScope {
+public:
+    explicit TransactionScope(Transaction& txn);
+    ~TransactionScope();
+
+    TransactionScope(const TransactionScope&) = delete;
+    TransactionScope& operator=(const TransactionScope&) = delete;
+
+private:
+    Transaction* previous_;
+};
+
+// Hands out snapshots and commit timestamps, and tracks the snapshots in
+// use so that garbage collection knows which ended versions nobody can
+// see any more. Commits are serialized; snapshots are never blocked.
+class TransactionManager {
+public:
+    // Snapshot of the latest committed state
+    void begin(Transaction& txn);
+    // Publishes txn's writes at once under a new commit timestamp. Costs one
+    // serialized step per transaction, however many statements wrote.
+    void commit(Transaction& txn);
+    // Undoes txn's writes from its undo log
+    void rollback(Transaction& txn);
+
+    uint64_t lastCommitted() const { return lastCommitted_.load(std::memory_order_acquire); }
+    // Versions that ended at or before this are invisible to every running
+    // and future transaction
+    uint64_t oldestSnapshot() const;
+    size_t activeCount() const;
+
+private:
+    // Forgets txn's snapshot and write set
+    void finish(Transaction& txn);
+
+    std::atomic<uint64_t> lastCommitted_{0};
+    uint64_t nextId_ = Transaction::kFirstId;
+    mutable std::mutex mutex_;
+    std::map<uint64_t, size_t> snapshots_;   // Snapshot -> transactions holding it
+    std::mutex commitMutex_;
+};
+
+} // namespace nanodb
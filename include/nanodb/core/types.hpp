@@ -4,17 +4,13 @@
 #include <vector>
 #include <variant>
 #include <memory>
+#include <atomic>
 
-namespace nanodb {
-
-    // Null type for NULL values
-    struct NullValue {
-        bool operator==(const NullValue&) const { return true; }
-        bool operator<(const NullValue&) const { return false; }
-    };
+#include "nanodb/core/value.hpp"
+#include "nanodb/core/row_store.hpp"
+#include "nanodb/core/transaction.hpp"
 
-    using Value = std::variant<NullValue, int, std::string>;
-    using Row = std::vector<Value>;
+namespace nanodb {
 
     enum class ColumnType {
         INT,
@@ -27,7 +23,8 @@ namespace nanodb {
         LT,   // <
         LE,   // <=
         GT,   // >
-        GE    // >=
+        GE,   // >=
+        IN    // IN (v1, v2, ...)
     };
 
     enum class LogicalOp {
@@ -51,6 +48,18 @@ namespace nanodb {
         COUNT_STAR  // COUNT(*)
     };
 
+    enum class IndexType {
+        ORDERED,
+        HASH,
+        BITMAP,
+        BLOOM
+    };
+
+    enum class CopyFormat {
+        CSV,
+        BINARY
+    };
+
     enum class JoinType {
         INNER,
         LEFT,
@@ -61,6 +70,7 @@ namespace nanodb {
         std::string column;
         CompareOp op = CompareOp::EQ;
         Value value;
+        std::vector<Value> inValues;  // Only for CompareOp::IN
         bool hasCondition = false;
     };
 
@@ -118,7 +128,35 @@ namespace nanodb {
     struct Table {
         std::string name;
         std::vector<Column> columns;
-        std::vector<Row> rows;
+        // Every row version: an UPDATE appends the new version and ends the
+        // old one, a DELETE only ends it. Ended versions stay in place until
+        // the table is compacted (see Catalog::collectGarbage).
+        RowStore rows;
+        std::atomic<size_t> liveRows{0};      // Rows in the latest committed state
+        std::atomic<size_t> deadVersions{0};  // Ended versions not yet compacted away
+        // Transactions holding uncommitted versions of this table; their
+        // undo logs refer to row ids, so the rows must not move meanwhile
+        std::atomic<size_t> pendingWriters{0};
+
+        // Rows are grouped by position for per-group pruning structures
+        static constexpr size_t kRowGroupSize = 4096;
+
+        // True if the version is not visible to txn (by default the running
+        // statement's, see Transaction::current): ended before its snapshot,
+        // or written after it by another transaction
+        bool isDeleted(size_t rowId) const { return isDeleted(rowId, Transaction::current()); }
+        bool isDeleted(size_t rowId, const Transaction& txn) const { return !txn.sees(rows.version(rowId)); }
+        // Latest committed state, not necessarily the running snapshot's
+        size_t liveRowCount() const { return liveRows.load(std::memory_order_relaxed); }
+        // Exact count for the running transaction; reads only version stamps
+        size_t visibleRowCount() const {
+            const Transaction& txn = Transaction::current();
+            size_t count = 0;
+            for (size_t i = 0; i < rows.size(); ++i) {
+                if (txn.sees(rows.version(i))) ++count;
+            }
+            return count;
+        }
     };
 
     enum class QueryType {
@@ -127,7 +165,19 @@ namespace nanodb {
         INSERT,
         UPDATE,
         DELETE_Q,
-        SELECT
+        SELECT,
+        VACUUM,
+        CREATE_INDEX,
+        DROP_INDEX,
+        PREPARE,
+        EXECUTE,
+        DEALLOCATE,
+        COPY,
+        EXPLAIN,
+        SHOW,
+        BEGIN,
+        COMMIT,
+        ROLLBACK
     };
 
     // Abstract base query — all query types inherit from this
@@ -136,6 +186,9 @@ namespace nanodb {
         std::string tableName;
         std::shared_ptr<Query> left;    // Left child for tree structure (subqueries, composites)
         std::shared_ptr<Query> right;   // Right child for tree structure
+        // Ordinals of the '?' placeholders among the statement's literal
+        // values, counted in textual order; bound by SQLParser::bind
+        std::vector<size_t> paramSlots;
 
         explicit Query(QueryType t) : type(t) {}
         virtual ~Query() = default;
@@ -152,7 +205,7 @@ namespace nanodb {
 
     struct InsertQuery : public Query {
         std::vector<std::string> insertColumns;
-        std::vector<Value> values;
+        std::vector<Row> rows;          // One entry per VALUES tuple
         InsertQuery() : Query(QueryType::INSERT) {}
     };
 
@@ -180,6 +233,71 @@ namespace nanodb {
         SelectQuery() : Query(QueryType::SELECT) {}
     };
 
+    struct VacuumQuery : public Query {
+        // Empty tableName vacuums every table
+        VacuumQuery() : Query(QueryType::VACUUM) {}
+    };
+
+    struct CreateIndexQuery : public Query {
+        std::string indexName;
+        std::string column;
+        std::vector<std::string> includeColumns;  // Covered columns (ORDERED only)
+        IndexType indexType = IndexType::ORDERED;
+        CreateIndexQuery() : Query(QueryType::CREATE_INDEX) {}
+    };
+
+    struct DropIndexQuery : public Query {
+        std::string indexName;
+        DropIndexQuery() : Query(QueryType::DROP_INDEX) {}
+    };
+
+    struct PrepareQuery : public Query {
+        std::string name;
+        std::string sql;    // Statement text with '?' placeholders
+        PrepareQuery() : Query(QueryType::PREPARE) {}
+    };
+
+    struct ExecuteQuery : public Query {
+        std::string name;
+        std::vector<Value> params;
+        ExecuteQuery() : Query(QueryType::EXECUTE) {}
+    };
+
+    struct DeallocateQuery : public Query {
+        std::string name;
+        DeallocateQuery() : Query(QueryType::DEALLOCATE) {}
+    };
+
+    struct CopyQuery : public Query {
+        std::vector<std::string> columns;   // Empty means every column, in table order
+        std::string path;
+        bool toFile = false;                // COPY ... TO rather than COPY ... FROM
+        CopyFormat format = CopyFormat::CSV;
+        bool header = false;                // CSV: first line holds column names
+        char delimiter = ',';
+        CopyQuery() : Query(QueryType::COPY) {}
+    };
+
+    struct ExplainQuery : public Query {
+        bool analyze = false;               // Run the query and report actual counts
+        ExplainQuery() : Query(QueryType::EXPLAIN) {}   // The SELECT is the left child
+    };
+
+    enum class ShowTarget {
+        STATS,          // Engine metrics, see Metrics
+        TABLE_SIZES     // Memory held by each table and its indexes
+    };
+
+    struct ShowQuery : public Query {
+        ShowTarget target = ShowTarget::STATS;
+        ShowQuery() : Query(QueryType::SHOW) {}
+    };
+
+    // BEGIN, COMMIT or ROLLBACK
+    struct TransactionQuery : public Query {
+        explicit TransactionQuery(QueryType t) : Query(t) {}
+    };
+
     // Helper to check if value is NULL
     inline bool isNull(const Value& v) {
         return std::holds_alternative<NullValue>(v);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace nanodb {
+
+// Null type for NULL values
+struct NullValue {
+    bool operator==(const NullValue&) const { return true; }
+    bool operator<(const NullValue&) const { return false; }
+};
+
+using Value = std::variant<NullValue, int, std::string>;
+using Row = std::vector<Value>;
+
+} // namespace nanodb
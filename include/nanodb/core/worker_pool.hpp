@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nanodb {
+
+// Fixed set of threads running posted tasks in FIFO order. The threads
+// start with the first post(), so a pool that is never used costs nothing.
+class WorkerPool {
+public:
+    // threads = 0 starts one per hardware thread
+    explicit WorkerPool(size_t threads = 0);
+    // Tasks still queued are dropped; running ones finish first
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void post(std::function<void()> task);
+    size_t size() const { return size_; }
+
+private:
+    void run();
+
+    size_t size_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "nanodb/core/types.hpp"
+#include "nanodb/core/cancellation.hpp"
+#include "nanodb/catalog/catalog.hpp"
+#include "nanodb/index/roaring_bitmap.hpp"
+#include "nanodb/index/ordered_index.hpp"
+#include "nanodb/executor/query_plan.hpp"
+
+namespace nanodb {
+
+// Which rows of a table a scan has to visit. Candidates are a superset of
+// the matching rows unless exact is set; executors still evaluate the full
+// WHERE on each candidate either way.
+struct ScanPlan {
+    bool fullScan = true;
+    bool exact = false;                 // rows holds exactly the WHERE matches
+    RoaringBitmap rows;                 // Candidate row ids; only used when !fullScan
+    std::vector<const Index*> indexes;  // Indexes that produced rows
+
+    std::vector<bool> skippedGroups;    // Row groups a full scan may skip
+
+    // Calls fn(rowId) for every candidate row visible to the running
+    // transaction, in table order. fn may return bool, in which case false
+    // stops the scan early. A cancelled query (see CancellationToken) stops
+    // at the next row group.
+    template <typename Fn>
+    void forEachRow(const Table& table, Fn&& fn) const {
+        const Transaction& txn = Transaction::current();
+        auto visit = [&fn](size_t rowId) -> bool {
+            if constexpr (std::is_same_v<decltype(fn(rowId)), bool>) {
+                return fn(rowId);
+            } else {
+                fn(rowId);
+                return true;
+            }
+        };
+
+        if (fullScan) {
+            size_t rowCount = table.rows.size();
+            for (size_t start = 0; start < rowCount; start += Table::kRowGroupSize) {
+                size_t group = start / Table::kRowGroupSize;
+                if (group < skippedGroups.size() && skippedGroups[group]) continue;
+                if (CancellationToken::stopRequested()) return;
+                size_t end = std::min(start + Table::kRowGroupSize, rowCount);
+                for (size_t i = start; i < end; ++i) {
+                    if (table.isDeleted(i, txn)) continue;
+                    if (!visit(i)) return;
+                }
+            }
+        } else {
+            bool stopped = false;
+            size_t visited = 0;
+            rows.forEach([&](uint32_t rowId) {
+                if (stopped || table.isDeleted(rowId, txn)) return;
+                if (++visited % Table::kRowGroupSize == 0 && CancellationToken::stopRequested()) {
+                    stopped = true;
+                    return;
+                }
+                stopped = !visit(static_cast<size_t>(rowId));
+            });
+        }
+    }
+};
+
+// Access through a covering ordered index alone: every column the query
+// references is stored in the index, so the base table is never read
+struct IndexOnlyPlan {
+    const OrderedIndex* index = nullptr;
+    KeyRange range;            // Bounds derived from conditions on the key
+    bool ordered = false;      // Index order satisfies the ORDER BY
+};
+
+class AccessPath {
+public:
+    // Evaluates as much of the WHERE clause as the table's indexes allow as
+    // bitmap intersections/unions; falls back to a full scan otherwise.
+    // Indexes hold every row version, so candidates include versions the
+    // scan's snapshot cannot see; forEachRow skips those. Takes the table's
+    // index latch itself, so the caller must not hold it.
+    static ScanPlan choose(const Catalog& catalog, const Table& table, const WhereClause& where);
+
+    // Picks a covering ordered index when it narrows the scan to a key range
+    // or provides the ORDER BY order; orderBy may be null
+    static bool chooseIndexOnly(const Catalog& catalog, const Table& table,
+                                const std::vector<std::string>& columns, const WhereClause& where,
+                                const OrderByClause* orderBy, IndexOnlyPlan& out);
+
+    // Scan nodes for EXPLAIN; counters are left for the executor to fill
+    static PlanNode describe(const Table& table, const ScanPlan& plan);
+    static PlanNode describe(const Table& table, const IndexOnlyPlan& plan);
+
+private:
+    static bool isConjunction(const WhereClause& where);
+    // Fills out with the rows matching cond if a single index can answer it
+    static const Index* indexedMatch(const Catalog& catalog, const Table& table,
+                                     const Condition& cond, RoaringBitmap& out);
+    // Marks row groups whose Bloom filters rule out an AND-ed equality
+    static void pruneRowGroups(const Catalog& catalog, const Table& table,
+                               const WhereClause& where, ScanPlan& plan);
+};
+
+} // namespace nanodb
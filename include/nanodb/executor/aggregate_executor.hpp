@@ -2,6 +2,10 @@
 
 #include "nanodb/core/types.hpp"
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/access_path.hpp"
+#include "nanodb/executor/row_sink.hpp"
+#include "nanodb/executor/query_plan.hpp"
+#include "nanodb/executor/spill_file.hpp"
 #include <vector>
 
 namespace nanodb {
@@ -10,10 +14,31 @@ class AggregateExecutor {
 public:
     explicit AggregateExecutor(Catalog& catalog);
 
-    void execute(const SelectQuery& query);
-    void executeWithGroupBy(const SelectQuery& query);
+    // Both produce their result into sink; false on error (reported
+    // through sink.error). Without GROUP BY the result is a single row.
+    // With a plan, they record the operators used (see QueryPlan).
+    bool execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan = nullptr);
+    bool executeWithGroupBy(const SelectQuery& query, RowSink& sink, QueryPlan* plan = nullptr);
 
 private:
+    // Counters of a GROUP BY that spilled, for EXPLAIN ANALYZE
+    struct SpilledGroupStats {
+        size_t scanned = 0;
+        size_t matched = 0;
+        size_t groups = 0;
+        size_t emitted = 0;
+        double scanMs = 0;
+        size_t peakBytes = 0;   // Largest partition's group map
+        SpillStats spill;
+    };
+
+    // GROUP BY for inputs whose groups do not fit under the memory limit:
+    // rows are hash-partitioned by group key into spill files and each
+    // partition is aggregated on its own. Output order is unchanged.
+    bool executeGroupBySpilled(const SelectQuery& query, const Table& table, const ScanPlan& scanPlan,
+                               const std::vector<int>& groupColIndices, const std::vector<Column>& columns,
+                               RowSink& sink, SpilledGroupStats& stats, std::string& error);
+
     int findColumnIndex(const Table& table, const std::string& colName) const;
     bool evaluateSingleCondition(const Row& row, const Table& table, const Condition& cond) const;
     bool evaluateWhereClause(const Row& row, const Table& table, const WhereClause& where) const;
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nanodb {
+
+// Large user-space buffer in front of a file descriptor. Output goes out in
+// capacity-sized write(2) calls instead of one stream operation per value.
+class BufferedWriter {
+public:
+    explicit BufferedWriter(size_t capacity = kDefaultCapacity);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // Creates or truncates path
+    bool open(const std::string& path);
+    // Writes to an already open descriptor (e.g. stdout) without owning it
+    void attach(int fd);
+    // Flushes and closes; false if any write failed
+    bool close();
+    bool ok() const { return ok_; }
+
+    void write(std::string_view s) {
+        if (s.size() > buffer_.size() - length_) {
+            writeSlow(s);
+            return;
+        }
+        s.copy(buffer_.data() + length_, s.size());
+        length_ += s.size();
+    }
+
+    void put(char c) {
+        if (length_ == buffer_.size()) flush();
+        buffer_[length_++] = c;
+    }
+
+    // Decimal text via std::to_chars
+    void writeInt(int64_t value);
+    // Fixed-width little-endian encodings for binary formats
+    void writeU8(uint8_t value) { put(static_cast<char>(value)); }
+    void writeU32(uint32_t value);
+
+    bool flush();
+
+    static constexpr size_t kDefaultCapacity = 1 << 20;
+
+private:
+    void writeSlow(std::string_view s);
+    bool writeAll(const char* data, size_t size);
+
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    std::vector<char> buffer_;
+    size_t length_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace nanodb
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+#include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/buffered_writer.hpp"
+#include "nanodb/executor/dml_executor.hpp"
+#include "nanodb/executor/row_sink.hpp"
+
+namespace nanodb {
+
+class CopyExecutor {
+public:
+    // Runs any SELECT (plain, join or aggregate) into a sink
+    using SelectRunner = std::function<bool(const SelectQuery&, RowSink&)>;
+
+    // Outcome messages go to out
+    CopyExecutor(Catalog& catalog, SelectRunner runSelect, std::ostream& out = std::cout);
+
+    void execute(const CopyQuery& query);
+
+    // Files smaller than this per thread are not worth splitting further
+    static constexpr size_t kMinChunkBytes = 1 << 20;
+
+    // Binary format: kBinaryMagic, u32 column count, then per column a u8
+    // type (0 INT, 1 STRING) and a u32-length name. Each row follows as one
+    // u8 tag per value (0 NULL, 1 INT + i32, 2 STRING + u32 length + bytes).
+    // Integers are little-endian.
+    static constexpr char kBinaryMagic[8] = {'N', 'A', 'N', 'O', 'D', 'B', 'C', '1'};
+
+private:
+    void executeCopyFrom(const CopyQuery& query);
+    void executeCopyTo(const CopyQuery& query);
+    // Parses the whole file into rows; false (with error) on malformed input
+    bool readBinary(std::string_view data, const std::vector<ColumnType>& types,
+                    std::vector<Row>& rows, std::string& error) const;
+
+    Catalog& catalog_;
+    DMLExecutor dml_;
+    SelectRunner runSelect_;
+    std::ostream& out_;
+};
+
+// Writes rows in the binary format described at CopyExecutor::kBinaryMagic
+class BinaryWriteSink : public RowSink {
+public:
+    explicit BinaryWriteSink(BufferedWriter& out) : out_(out) {}
+
+    void begin(const std::vector<Column>& columns, bool stableRows) override;
+    bool row(const Row& row, const std::vector<size_t>& projection) override;
+    void end() override {}
+    // Wrapped by CopyExecutor, which reports failures itself
+    void error(const std::string&) override {}
+
+    size_t rows() const { return rows_; }
+
+private:
+    BufferedWriter& out_;
+    size_t rows_ = 0;
+};
+
+} // namespace nanodb
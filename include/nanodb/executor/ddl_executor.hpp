@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iostream>
+
 #include "nanodb/core/types.hpp"
 #include "nanodb/catalog/catalog.hpp"
 
@@ -7,13 +9,18 @@ namespace nanodb {
 
 class DDLExecutor {
 public:
-    explicit DDLExecutor(Catalog& catalog);
+    // Outcome messages go to out
+    explicit DDLExecutor(Catalog& catalog, std::ostream& out = std::cout);
 
     void executeCreateTable(const CreateQuery& query);
     void executeDropTable(const DropQuery& query);
+    void executeVacuum(const VacuumQuery& query);
+    void executeCreateIndex(const CreateIndexQuery& query);
+    void executeDropIndex(const DropIndexQuery& query);
 
 private:
     Catalog& catalog_;
+    std::ostream& out_;
 };
 
 } // namespace nanodb
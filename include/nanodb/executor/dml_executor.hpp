@@ -1,24 +1,42 @@
 #pragma once
 
+#include <iostream>
+
 #include "nanodb/core/types.hpp"
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/access_path.hpp"
 
 namespace nanodb {
 
 class DMLExecutor {
 public:
-    explicit DMLExecutor(Catalog& catalog);
+    // Outcome messages go to out
+    explicit DMLExecutor(Catalog& catalog, std::ostream& out = std::cout);
 
     void executeInsert(const InsertQuery& query);
+    // SET values are checked against their columns' types (NULL fits any
+    // column) before any row is touched
     void executeUpdate(const UpdateQuery& query);
     void executeDelete(const DeleteQuery& query);
 
+    // Bulk append. The column list (empty = all columns, in table order) is
+    // resolved once and every row's arity and value types (NULL fits any
+    // column) are checked before the table is touched, so on failure
+    // nothing is appended and error says why.
+    // Capacity is reserved up front and indexes are maintained per batch.
+    // Rows are written as versions of the running transaction.
+    bool appendRows(const std::string& tableName, const std::vector<std::string>& columns,
+                    std::vector<Row> rows, std::string& error);
+
 private:
+    // Adds rows [firstRowId, size) to every index of the table
+    void indexRows(const Table& table, size_t firstRowId);
     int findColumnIndex(const Table& table, const std::string& colName) const;
     bool evaluateSingleCondition(const Row& row, const Table& table, const Condition& cond) const;
     bool evaluateWhereClause(const Row& row, const Table& table, const WhereClause& where) const;
 
     Catalog& catalog_;
+    std::ostream& out_;
 };
 
 } // namespace nanodb
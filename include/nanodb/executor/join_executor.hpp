@@ -2,6 +2,8 @@
 
 #include "nanodb/core/types.hpp"
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/row_sink.hpp"
+#include "nanodb/executor/query_plan.hpp"
 
 namespace nanodb {
 
@@ -9,11 +11,16 @@ class JoinExecutor {
 public:
     explicit JoinExecutor(Catalog& catalog);
 
-    void execute(const SelectQuery& query);
+    // Joined rows are built one at a time and handed to sink as they are
+    // produced; false on error (reported through sink.error)
+    bool execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan = nullptr);
 
 private:
     int findColumnIndex(const Table& table, const std::string& colName) const;
 
+    // Bloom pruning of probe row groups pays off only for small build sides
+    static constexpr size_t kMaxBloomProbeKeys = 64;
+
     Catalog& catalog_;
 };
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "nanodb/core/memory.hpp"
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// One operator of a query plan. The executors fuse scan, filter, sort and
+// limit into a single pass, so times are inclusive: a node's time runs from
+// the start of the query until the operator produced its last row.
+struct PlanNode {
+    std::string name;                   // e.g. "Seq Scan on orders"
+    std::vector<std::string> details;   // e.g. "Filter: total > 100"
+    std::vector<PlanNode> children;
+
+    // Filled by EXPLAIN ANALYZE only
+    size_t rowsIn = 0;
+    size_t rowsOut = 0;
+    double millis = 0;
+    size_t memoryBytes = 0;             // Intermediate state the operator held
+};
+
+// Filled by an executor when passed to execute(). Without analyze the
+// executor stops once it has chosen its plan and produces no rows.
+struct QueryPlan {
+    bool analyze = false;
+    PlanNode root;
+
+    // The EXPLAIN output, one line per row
+    std::vector<std::string> render() const;
+};
+
+// Wall-clock milliseconds since construction
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// WHERE clause as SQL text, e.g. "a = 1 AND b IN ('x', 'y')"
+std::string describeWhere(const WhereClause& where);
+
+} // namespace nanodb
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "nanodb/executor/row_sink.hpp"
+#include "nanodb/executor/buffered_writer.hpp"
+
+namespace nanodb {
+
+enum class OutputMode {
+    TABLE,      // Aligned columns sized from the data, then a row count
+    CSV,        // RFC 4180; NULL is an empty field, "" the empty string
+    TSV,        // Tab separated; \t \n \r \\ escaped, NULL as \N
+    JSON,       // One object per line, keyed by column name
+    NONE        // Rows are produced and discarded, e.g. for load scripts
+};
+
+// Formats query results into a BufferedWriter: the console, or a file for
+// COPY TO. Integers go through std::to_chars and every cell is appended to
+// the writer's buffer, which goes out in large writes. Errors go to a
+// separate messages stream, as "Error: ..." lines.
+class ResultPrinter : public RowSink {
+public:
+    // header applies to CSV and TSV; delimiter to CSV only
+    ResultPrinter(BufferedWriter& out, OutputMode mode, std::ostream& messages, bool header = true,
+                  char delimiter = ',');
+
+    void begin(const std::vector<Column>& columns, bool stableRows) override;
+    bool row(const Row& row, const std::vector<size_t>& projection) override;
+    void end() override;
+    void error(const std::string& message) override;
+
+    size_t rowCount() const { return rowCount_; }
+
+    // TABLE mode sizes columns from this many leading rows; later rows
+    // that are wider than their column overflow it rather than being cut
+    static constexpr size_t kWidthSampleRows = 1000;
+
+private:
+    void writeCsvField(const std::string& s);
+    void writeTsvField(const std::string& s);
+    void writeJsonString(const std::string& s);
+    // TABLE mode: formats a row into cells_ for the width pass
+    void bufferRow(const Row& row, const std::vector<size_t>& projection);
+    void flushTable();
+    void writeTableRow(size_t firstCell);
+    // INT columns align right, everything else left
+    void writeAligned(size_t column, std::string_view text);
+
+    BufferedWriter& out_;
+    std::ostream& messages_;
+    OutputMode mode_;
+    bool header_;
+    char delimiter_;
+    std::vector<Column> columns_;
+    size_t rowCount_ = 0;
+
+    // TABLE mode state
+    std::vector<size_t> widths_;
+    std::string cells_;                 // Formatted cells, back to back
+    std::vector<uint32_t> cellEnds_;    // End offset of each cell in cells_
+    bool widthsFixed_ = false;
+};
+
+} // namespace nanodb
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "nanodb/executor/row_sink.hpp"
+
+namespace nanodb {
+
+class ResultSet;
+
+// A window of consecutive result rows, addressed from 0
+class RowBatch {
+public:
+    RowBatch(const ResultSet* result, size_t first, size_t size)
+        : result_(result), first_(first), size_(size) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const Value& value(size_t row, size_t column) const;
+    bool isNull(size_t row, size_t column) const;
+    int getInt(size_t row, size_t column) const;
+    const std::string& getString(size_t row, size_t column) const;
+
+private:
+    const ResultSet* result_;
+    size_t first_;
+    size_t size_;
+};
+
+// Materialized query result with typed accessors, filled as a RowSink.
+//
+// Rows produced straight from storage (plain SELECTs) are borrowed, not
+// copied: the result keeps a pointer per row plus the column projection.
+// Borrowed rows stay valid until the table they came from is modified, so
+// read a result before running DML or DDL against its table. Rows built on
+// the fly (joins, aggregates) are copied into the result and owned by it.
+// A result constructed with borrowRows = false copies every row, which is
+// what sessions sharing a database get (see NanoDB::openSession).
+//
+// Typed accessors do not convert: getInt() of a non-INT value returns 0
+// and getString() of a non-STRING value returns an empty string.
+class ResultSet : public RowSink {
+public:
+    explicit ResultSet(bool borrowRows = true) : borrowRows_(borrowRows) {}
+    ResultSet(ResultSet&&) = default;
+    ResultSet& operator=(ResultSet&&) = default;
+
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    const std::vector<Column>& columns() const { return columns_; }
+    size_t columnCount() const { return columns_.size(); }
+    // Returns -1 if there is no such column
+    int columnIndex(const std::string& name) const;
+    size_t rowCount() const { return rows_.size(); }
+
+    // Random access
+    const Value& value(size_t row, size_t column) const {
+        return (*rows_[row])[projection_[column]];
+    }
+    bool isNull(size_t row, size_t column) const { return nanodb::isNull(value(row, column)); }
+    int getInt(size_t row, size_t column) const;
+    const std::string& getString(size_t row, size_t column) const;
+
+    // Cursor: next() moves to the first row on its first call
+    bool next();
+    void rewind() { cursor_ = 0; started_ = false; }
+    const Value& value(size_t column) const { return value(cursor_, column); }
+    bool isNull(size_t column) const { return isNull(cursor_, column); }
+    int getInt(size_t column) const { return getInt(cursor_, column); }
+    const std::string& getString(size_t column) const { return getString(cursor_, column); }
+
+    // Batches: successive calls walk the result in windows of maxRows,
+    // independently of the row cursor. An empty batch marks the end.
+    RowBatch nextBatch(size_t maxRows = kBatchSize);
+
+    static constexpr size_t kBatchSize = 1024;
+
+    // RowSink
+    void begin(const std::vector<Column>& columns, bool stableRows) override;
+    bool row(const Row& row, const std::vector<size_t>& projection) override;
+    void end() override {}
+    void error(const std::string& message) override { error_ = message; }
+
+private:
+    std::vector<Column> columns_;
+    std::vector<size_t> projection_;    // Maps result columns to row slots
+    std::vector<const Row*> rows_;      // Into storage, or into owned_
+    std::deque<Row> owned_;             // Copies of rows that were not stable
+    bool borrowRows_ = true;
+    bool stableRows_ = false;
+    std::string error_;
+
+    size_t cursor_ = 0;
+    bool started_ = false;
+    size_t batchStart_ = 0;
+};
+
+} // namespace nanodb
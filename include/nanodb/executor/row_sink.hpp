@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// Receives a query result one row at a time, as the executor produces it,
+// so consumers such as file export never hold the whole result in memory.
+class RowSink {
+public:
+    virtual ~RowSink() = default;
+
+    // Called once, before any row, with the result's columns. stableRows
+    // means the rows handed to row() live in table or index storage and stay
+    // valid until that table is next modified, so a sink may keep pointers
+    // to them instead of copying.
+    virtual void begin(const std::vector<Column>& columns, bool stableRows) = 0;
+    // The result row is row[projection[0]], row[projection[1]], ...; the
+    // projection is the same for every row of a result. Returning false
+    // asks the producer to stop early.
+    virtual bool row(const Row& row, const std::vector<size_t>& projection) = 0;
+    // Called once after the last row, unless the query failed
+    virtual void end() = 0;
+    // The query failed; no further calls follow. Console sinks print it
+    // to the session's messages, others keep it for their caller.
+    virtual void error(const std::string& message) = 0;
+};
+
+} // namespace nanodb
@@ -2,6 +2,8 @@
 
 #include "nanodb/core/types.hpp"
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/access_path.hpp"
+#include "nanodb/executor/row_sink.hpp"
 
 namespace nanodb {
 
@@ -9,7 +11,11 @@ class SelectExecutor {
 public:
     explicit SelectExecutor(Catalog& catalog);
 
-    void execute(const SelectQuery& query);
+    // Streams the result into sink. Rows flow straight from the scan unless
+    // an ORDER BY has to sort them first. Returns false on error (reported
+    // through sink.error). With a plan, records the operators it used; see
+    // QueryPlan for EXPLAIN without ANALYZE.
+    bool execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan = nullptr);
 
 private:
     int findColumnIndex(const Table& table, const std::string& colName) const;
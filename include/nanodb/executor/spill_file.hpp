@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+#include "nanodb/executor/buffered_writer.hpp"
+
+namespace nanodb {
+
+// Temporary file of rows for operators that outgrow the memory limit. The
+// file is unlinked as soon as it is created, so it disappears with the
+// object (or the process) without cleanup. Rows are written, then read
+// back once in the same order. Each row is a u32 value count followed by
+// values in the binary COPY encoding (see CopyExecutor::kBinaryMagic).
+class SpillFile {
+public:
+    SpillFile();
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // Creates the file under $TMPDIR (default /tmp)
+    bool open(std::string& error);
+
+    void write(const Row& row);
+    void write(const Row& row, const std::vector<size_t>& projection);
+    // Flushes pending writes and rewinds for reading
+    bool finish(std::string& error);
+    // Next row; false at the end or on a read error (see ok())
+    bool read(Row& row);
+
+    bool ok() const { return ok_; }
+    size_t rows() const { return rows_; }
+    uint64_t bytes() const { return bytes_; }
+
+    // Write and read buffer size, small since many partitions are open at once
+    static constexpr size_t kBufferBytes = 32 << 10;
+
+private:
+    void writeValue(const Value& v);
+    // Makes at least n unread bytes available; false at end of file
+    bool fill(size_t n);
+
+    int fd_ = -1;
+    BufferedWriter out_;
+    std::vector<char> in_;
+    size_t inPos_ = 0;
+    size_t inEnd_ = 0;
+    size_t rows_ = 0;
+    uint64_t bytes_ = 0;
+    bool ok_ = true;
+};
+
+// Spill files that rows are routed to by the hash of key columns. The
+// level salts the hash, so the rows of one partition can be split again
+// when it is still too large.
+class SpillPartitions {
+public:
+    static constexpr size_t kFanout = 16;
+    // Beyond this many levels (16^3 partitions), splitting again would not help
+    static constexpr size_t kMaxLevel = 3;
+
+    bool open(size_t level, std::string& error);
+    // Stores row[projection...] (all of row without one) in the partition of
+    // the key row[keyColumns...]
+    void add(const Row& row, const std::vector<size_t>& keyColumns);
+    void add(const Row& row, const std::vector<size_t>& keyColumns, const std::vector<size_t>& projection);
+    bool finish(std::string& error);
+
+    size_t level() const { return level_; }
+    SpillFile& operator[](size_t i) { return *files_[i]; }
+    size_t rows() const;
+    uint64_t bytes() const;
+
+private:
+    size_t partitionOf(const Row& row, const std::vector<size_t>& keyColumns) const;
+
+    size_t level_ = 0;
+    std::vector<std::unique_ptr<SpillFile>> files_;
+};
+
+// Running totals of one operator's spilling, for EXPLAIN ANALYZE
+struct SpillStats {
+    size_t partitions = 0;      // Partition files written, across all levels
+    size_t maxLevel = 0;        // Deepest split level reached (0 = one split)
+    size_t rows = 0;
+    uint64_t bytes = 0;
+
+    void add(const SpillPartitions& p);
+    // e.g. "Spilled: 16 partitions, 1000 rows, 1.2 MiB"
+    std::string describe() const;
+};
+
+} // namespace nanodb
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+
+#include "nanodb/index/index.hpp"
+#include "nanodb/index/roaring_bitmap.hpp"
+
+namespace nanodb {
+
+// One compressed bitmap of row ids per distinct value. Meant for
+// low-cardinality columns (flags, enums, status strings): any comparison
+// or IN list is answered by combining the bitmaps of the qualifying values.
+class BitmapIndex : public Index {
+public:
+    BitmapIndex(const std::string& name, const std::string& tableName,
+                const std::string& column, size_t columnIndex);
+
+    void insert(const Row& row, size_t rowId) override;
+    void remove(const Row& row, size_t rowId) override;
+    void clear() override;
+
+    // Returns nullptr if no live row has this key
+    const RoaringBitmap* lookup(const Value& key) const;
+    // Rows whose value satisfies cond, with WHERE comparison semantics
+    RoaringBitmap match(const Condition& cond) const;
+    size_t distinctKeys() const { return bitmaps_.size(); }
+    size_t memoryBytes() const override;
+
+private:
+    static bool keyMatches(const Value& key, const Condition& cond);
+
+    std::map<Value, RoaringBitmap> bitmaps_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "nanodb/index/index.hpp"
+
+namespace nanodb {
+
+// One Bloom filter per row group (Table::kRowGroupSize consecutive rows).
+// It cannot locate rows, but lets equality scans skip every row group whose
+// filter rules the key out. Filters are cache-line blocked: all probe bits
+// of a key fall into one 512-bit block.
+class BloomIndex : public Index {
+public:
+    BloomIndex(const std::string& name, const std::string& tableName,
+               const std::string& column, size_t columnIndex);
+
+    void insert(const Row& row, size_t rowId) override;
+    void remove(const Row& row, size_t rowId) override;
+    void clear() override;
+    size_t memoryBytes() const override;
+
+    // False only if no row of the group can hold this key
+    bool mayContain(size_t group, const Value& key) const;
+
+private:
+    static constexpr size_t kBitsPerKey = 10;
+    static constexpr size_t kBlockWords = 8;  // 512 bits, one cache line
+    static constexpr size_t kBlocks = Table::kRowGroupSize * kBitsPerKey / 512;
+    static constexpr int kProbes = 6;
+
+    static size_t blockOf(uint64_t hash);
+
+    // filters_[g] holds kBlocks * kBlockWords words; empty until a row lands in g
+    std::vector<std::vector<uint64_t>> filters_;
+};
+
+} // namespace nanodb
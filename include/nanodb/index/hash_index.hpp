@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "nanodb/index/index.hpp"
+
+namespace nanodb {
+
+// Open-addressing (linear probing) hash index: column value -> ascending row ids.
+// Slots are 8 bytes so a probe sequence usually stays within one cache line;
+// keys and posting lists live in a separate dense entry array.
+class HashIndex : public Index {
+public:
+    HashIndex(const std::string& name, const std::string& tableName,
+              const std::string& column, size_t columnIndex);
+
+    void insert(const Row& row, size_t rowId) override;
+    void remove(const Row& row, size_t rowId) override;
+    void clear() override;
+
+    // Returns nullptr if no live row has this key
+    const std::vector<size_t>* lookup(const Value& key) const;
+    size_t distinctKeys() const { return entries_.size(); }
+    // Bytes held by slots, entries and posting lists
+    size_t memoryBytes() const override;
+    // Bytes one more distinct key adds before its posting list: a dense
+    // entry plus the two slots a table kept at most half full needs
+    static size_t keyOverheadBytes();
+
+    // Calls fn(key) once per distinct key, in no particular order
+    template <typename Fn>
+    void forEachKey(Fn&& fn) const {
+        for (const auto& entry : entries_) {
+            fn(entry.key);
+        }
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    struct Slot {
+        uint32_t entry = kEmpty;  // Index into entries_
+        uint32_t tag = 0;         // High hash bits, checked before comparing keys
+    };
+
+    struct Entry {
+        Value key;
+        uint64_t hash;
+        std::vector<size_t> rowIds;
+    };
+
+    size_t findSlot(const Value& key, uint64_t hash) const;
+    void grow();
+    void eraseEntry(size_t slot);
+
+    std::vector<Slot> slots_;     // Size is zero or a power of two
+    std::vector<Entry> entries_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// Hash of a column value; values of different types never collide on purpose
+uint64_t hashValue(const Value& v);
+
+// Abstract base index over a single column — concrete index types inherit from this
+class Index {
+public:
+    Index(IndexType type, const std::string& name, const std::string& tableName,
+          const std::string& column, size_t columnIndex);
+    virtual ~Index() = default;
+
+    IndexType type() const { return type_; }
+    const std::string& name() const { return name_; }
+    const std::string& tableName() const { return tableName_; }
+    const std::string& column() const { return column_; }
+    size_t columnIndex() const { return columnIndex_; }
+
+    // Maintenance hooks called by the DML path; rowId is the position in Table::rows
+    virtual void insert(const Row& row, size_t rowId) = 0;
+    virtual void remove(const Row& row, size_t rowId) = 0;
+    virtual void clear() = 0;
+    // Whether updating this table column requires maintaining the index
+    virtual bool dependsOn(size_t columnIndex) const { return columnIndex == columnIndex_; }
+    // Approximate heap bytes held by the index, for SHOW TABLE SIZES
+    virtual size_t memoryBytes() const = 0;
+
+    // Drops all entries and re-indexes every live row of the table
+    void rebuild(const Table& table);
+
+private:
+    IndexType type_;
+    std::string name_;
+    std::string tableName_;
+    std::string column_;
+    size_t columnIndex_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "nanodb/index/index.hpp"
+#include "nanodb/index/roaring_bitmap.hpp"
+
+namespace nanodb {
+
+// Bounds of a key range scan; a null bound is open
+struct KeyRange {
+    const Value* lower = nullptr;
+    bool lowerInclusive = true;
+    const Value* upper = nullptr;
+    bool upperInclusive = true;
+};
+
+// Sorted index on one key column, optionally covering extra INCLUDE columns.
+// Every entry carries a copy of the covered values laid out as schema()
+// (key first, then the included columns), so a query that references only
+// covered columns never has to read the base table.
+class OrderedIndex : public Index {
+public:
+    OrderedIndex(const std::string& name, const Table& table, size_t columnIndex,
+                 const std::vector<size_t>& includeColumns);
+
+    void insert(const Row& row, size_t rowId) override;
+    void remove(const Row& row, size_t rowId) override;
+    void clear() override;
+    bool dependsOn(size_t columnIndex) const override;
+    size_t memoryBytes() const override;
+
+    // Column layout of covered rows handed out by scan()
+    const Table& schema() const { return schema_; }
+    bool covers(const std::string& column) const;
+    size_t size() const { return entries_.size(); }
+
+    // Rows whose key satisfies cond, with WHERE comparison semantics
+    RoaringBitmap match(const Condition& cond) const;
+    // Smallest / largest INT key among the rows of table visible to the
+    // running transaction; false if there is none
+    bool minInt(const Table& table, int& out) const;
+    bool maxInt(const Table& table, int& out) const;
+
+    // Calls fn(coveredRow, rowId) in key order until it returns false
+    template <typename Fn>
+    void scan(const KeyRange& range, bool descending, Fn&& fn) const {
+        if (range.lower && range.upper) {
+            if (*range.upper < *range.lower) return;
+            if (!(*range.lower < *range.upper) && !(range.lowerInclusive && range.upperInclusive)) return;
+        }
+        auto first = entries_.begin();
+        auto last = entries_.end();
+        if (range.lower) {
+            first = range.lowerInclusive ? entries_.lower_bound(*range.lower)
+                                         : entries_.upper_bound(*range.lower);
+        }
+        if (range.upper) {
+            last = range.upperInclusive ? entries_.upper_bound(*range.upper)
+                                        : entries_.lower_bound(*range.upper);
+        }
+        if (descending) {
+            for (auto it = last; it != first;) {
+                --it;
+                if (!fn(it->covered, it->rowId)) return;
+            }
+        } else {
+            for (auto it = first; it != last; ++it) {
+                if (!fn(it->covered, it->rowId)) return;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        Row covered;
+        size_t rowId;
+    };
+
+    // Orders by key, then row id; also compares entries against bare keys
+    struct EntryLess {
+        using is_transparent = void;
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.covered[0] < b.covered[0]) return true;
+            if (b.covered[0] < a.covered[0]) return false;
+            return a.rowId < b.rowId;
+        }
+        bool operator()(const Entry& a, const Value& key) const { return a.covered[0] < key; }
+        bool operator()(const Value& key, const Entry& b) const { return key < b.covered[0]; }
+    };
+
+    Row project(const Row& row) const;
+    void addRange(const KeyRange& range, RoaringBitmap& out, size_t typeIndex) const;
+
+    std::vector<size_t> sourceColumns_;  // Table column behind each schema column
+    Table schema_;
+    std::set<Entry, EntryLess> entries_;
+};
+
+} // namespace nanodb
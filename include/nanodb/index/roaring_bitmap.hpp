@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace nanodb {
+
+// Compressed bitmap of 32-bit row ids in the style of Roaring: ids are split
+// into 2^16-wide chunks, each stored as a sorted array of low halves while
+// sparse and as a fixed 8 KiB bitset once it holds more than 4096 ids.
+class RoaringBitmap {
+public:
+    RoaringBitmap() = default;
+
+    void add(uint32_t id);
+    void remove(uint32_t id);
+    bool contains(uint32_t id) const;
+    size_t cardinality() const;
+    // Heap bytes held by the containers
+    size_t memoryBytes() const;
+    bool empty() const { return containers_.empty(); }
+    void clear() { containers_.clear(); }
+
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b);
+
+    // Calls fn(id) for every id in ascending order
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& c : containers_) {
+            uint32_t high = static_cast<uint32_t>(c.key) << 16;
+            if (c.isBitmap) {
+                for (size_t w = 0; w < c.bits.size(); ++w) {
+                    uint64_t word = c.bits[w];
+                    while (word) {
+                        uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+                        fn(high | static_cast<uint32_t>(w * 64 + bit));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (uint16_t low : c.array) {
+                    fn(high | low);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kArrayMax = 4096;
+    static constexpr size_t kBitmapWords = 1024;
+
+    struct Container {
+        uint16_t key = 0;
+        bool isBitmap = false;
+        uint32_t card = 0;
+        std::vector<uint16_t> array;   // Sorted low halves (array form)
+        std::vector<uint64_t> bits;    // 65536 bits (bitmap form)
+
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        void remove(uint16_t low);
+        void toBitmap();
+        void toArray();
+    };
+
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+
+    Container* find(uint16_t key);
+    const Container* find(uint16_t key) const;
+
+    std::vector<Container> containers_;  // Sorted by key
+};
+
+} // namespace nanodb
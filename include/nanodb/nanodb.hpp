@@ -1,28 +1,211 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "nanodb/core/types.hpp"
+#include "nanodb/core/memory.hpp"
+#include "nanodb/core/metrics.hpp"
+#include "nanodb/core/slow_query_log.hpp"
+#include "nanodb/core/cancellation.hpp"
+#include "nanodb/core/worker_pool.hpp"
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/catalog/garbage_collector.hpp"
 #include "nanodb/parser/sql_parser.hpp"
+#include "nanodb/parser/plan_cache.hpp"
 #include "nanodb/executor/ddl_executor.hpp"
 #include "nanodb/executor/dml_executor.hpp"
 #include "nanodb/executor/select_executor.hpp"
 #include "nanodb/executor/aggregate_executor.hpp"
 #include "nanodb/executor/join_executor.hpp"
+#include "nanodb/executor/copy_executor.hpp"
+#include "nanodb/executor/result_set.hpp"
+#include "nanodb/executor/result_printer.hpp"
 
 namespace nanodb {
 
+// The eventual result of a statement run through NanoDB::submit()
+class QueryFuture {
+public:
+    QueryFuture() = default;
+
+    bool valid() const { return result_.valid(); }
+    // Blocks until the statement has finished; may be called once
+    ResultSet get() { return result_.get(); }
+    void wait() const { result_.wait(); }
+    // False if the statement is still queued or running after timeoutMs
+    bool waitFor(double timeoutMs) const {
+        return result_.wait_for(std::chrono::duration<double, std::milli>(timeoutMs)) ==
+               std::future_status::ready;
+    }
+    // Asks the statement to stop; safe from any thread. It fails with
+    // "Query cancelled." unless it had already finished.
+    void cancel() { if (token_) token_->cancel(); }
+
+private:
+    friend class NanoDB;
+    QueryFuture(std::future<ResultSet> result, std::shared_ptr<CancellationToken> token)
+        : result_(std::move(result)), token_(std::move(token)) {}
+
+    std::future<ResultSet> result_;
+    std::shared_ptr<CancellationToken> token_;
+};
+
+// A session on a database. Each NanoDB() is a new, empty database with one
+// session; openSession() adds sessions to the same database.
 class NanoDB {
 public:
     NanoDB();
-    ~NanoDB() = default;
+    // Cancels statements still pending from submit() and waits for them
+    ~NanoDB();
+
+    // Sessions share tables, cached plans and the slow query log, and may
+    // run statements on different threads at once. Each statement reads a
+    // snapshot of the rows committed when it started (see Transaction), so
+    // readers and the writer of a table run concurrently; writers of one
+    // table take turns, and DDL waits for everything else (see
+    // StatementLock). Opening a session also starts the background garbage
+    // collector. Prepared statements, the open transaction and the output
+    // mode belong to the session, which one thread uses at a time.
+    //
+    // BEGIN starts a transaction spanning statements: they all read the
+    // snapshot taken at BEGIN, and their writes become visible to other
+    // sessions together at COMMIT, or are undone by ROLLBACK. Updating a
+    // row another transaction changed since the snapshot fails the
+    // statement and rolls the transaction back; the session then ignores
+    // statements until COMMIT or ROLLBACK. Closing a session rolls back its
+    // open transaction. The session prints statement outcomes (row counts,
+    // errors) to messages, which must outlive it.
+    std::unique_ptr<NanoDB> openSession(std::ostream& messages = std::cout);
 
+    // Runs any statement and prints its outcome to the console
     void executeSQL(const std::string& sql);
+    // As above, but the rows of a SELECT, EXPLAIN or SHOW (run directly or
+    // via EXECUTE) go to results instead; other outcomes are still printed
+    // to the session's messages
+    void executeSQL(const std::string& sql, RowSink& results);
+
+    // Statements run through executeSQL that take at least thresholdMs are
+    // appended to path with their timing, executor work and, for SELECTs,
+    // the executed plan (see SlowQueryLog)
+    bool enableSlowQueryLog(const std::string& path, double thresholdMs, std::string& error);
+    void disableSlowQueryLog() { slowLog_.close(); }
+    const SlowQueryLog& slowQueryLog() const { return slowLog_; }
+
+    // Runs a SELECT, EXPLAIN, SHOW or EXECUTE of a prepared SELECT and
+    // returns its rows instead of printing them. Failures are reported through
+    // ResultSet::ok()/error(). See ResultSet for how long rows stay valid;
+    // once the database has several sessions, results always own their rows.
+    ResultSet query(const std::string& sql);
+    ResultSet query(PreparedStatement& stmt, const std::vector<Value>& params = {});
+    // query(sql) on the database's worker pool. The session's submitted
+    // statements run one at a time in submission order, those of different
+    // sessions in parallel; results own their rows. Scans, joins and
+    // aggregates check for cancellation between row groups and stop there.
+    // A timeoutMs > 0 cancels the statement that long after it starts
+    // running, failing it with "Query timed out after ... ms." The session
+    // must not run statements directly while submitted ones are pending.
+    QueryFuture submit(const std::string& sql, double timeoutMs = 0);
+    // Streams a SELECT's rows into any sink; with a plan, also records the
+    // operators used (see QueryPlan)
+    bool query(const SelectQuery& query, RowSink& sink, QueryPlan* plan = nullptr);
+    // EXPLAIN [ANALYZE] output: one STRING column, one plan line per row
+    bool explain(const ExplainQuery& query, RowSink& sink);
+    // SHOW STATS: (metric, value) rows from Metrics::snapshot() and the
+    // MemoryTracker. SHOW TABLE SIZES: one row per table, largest first.
+    bool show(const ShowQuery& query, RowSink& sink);
+
+    // C++ counterpart of PREPARE. Returns nullptr, after reporting the
+    // error, if sql does not parse or is not a SELECT/INSERT/UPDATE/DELETE.
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql);
+    // Binds params to the statement's '?' placeholders and runs it
+    void execute(PreparedStatement& stmt, const std::vector<Value>& params = {});
+
+    const PlanCache& planCache() const { return planCache_; }
+
+    // How executeSQL prints SELECT results (default TABLE)
+    void setOutputMode(OutputMode mode) { outputMode_ = mode; }
+    OutputMode outputMode() const { return outputMode_; }
 
 private:
-    Catalog catalog_;
+    // State common to all sessions of one database
+    struct Shared {
+        Catalog catalog;
+        GarbageCollector gc{catalog};  // Stopped before the catalog goes away
+        PlanCache planCache;
+        SlowQueryLog slowLog;
+        // Set once a second session opens
+        std::atomic<bool> multiSession{false};
+        // Runs submitted statements; declared last so its threads stop
+        // before anything they could touch goes away
+        WorkerPool workers;
+    };
+
+    // A statement waiting in the session's submit() queue
+    struct Submitted {
+        std::string sql;
+        std::shared_ptr<CancellationToken> token;
+        double timeoutMs = 0;
+        std::promise<ResultSet> result;
+    };
+
+    NanoDB(std::shared_ptr<Shared> shared, std::ostream& out);
+
+    // Parses through the plan cache; only parameterizable statements are cached
+    std::shared_ptr<Query> parseCached(const std::string& sql, std::string& error);
+    // As parseCached, but a statement with '?' parameters is parsed afresh:
+    // binding writes into the query, which must not be shared across sessions
+    std::shared_ptr<Query> parseForBinding(const std::string& sql, std::string& error);
+    // Takes the locks the statement needs (see StatementLock)
+    StatementLock lockFor(const Query& query);
+    // Runs one statement in the open transaction or one of its own; holds
+    // its locks throughout
+    void dispatch(const Query& query);
+    void executeBegin();
+    // COMMIT or ROLLBACK
+    void endTransaction(bool commit);
+    // Rolled back after a conflict but not yet ended by the client
+    bool transactionAborted() const { return txn_ && !txn_->active(); }
+    // Resolves a prepared statement for execution: re-parses after DDL, binds
+    bool bindPrepared(PreparedStatement& stmt, const std::vector<Value>& params, std::string& error);
+    // The two query() overloads, filling a given result
+    void queryText(const std::string& sql, ResultSet& result);
+    void queryPrepared(PreparedStatement& stmt, const std::vector<Value>& params, ResultSet& result);
+    // Runs the oldest submitted statement on a pool thread, then hands the
+    // queue on to another task if more are waiting
+    void runSubmitted();
+
+    // query(), explain() and show() without taking locks, for callers
+    // that already hold them
+    bool runQuery(const SelectQuery& query, RowSink& sink, QueryPlan* plan);
+    bool runExplain(const ExplainQuery& query, RowSink& sink);
+    bool runShow(const ShowQuery& query, RowSink& sink);
+    bool showTableSizes(RowSink& sink);
+    // Calls fn with the sink for a statement's result rows: results_, or
+    // else a printer to the console in the session's output mode
+    template <typename Fn>
+    void withResultSink(Fn&& fn);
+
+    void executePrepare(const PrepareQuery& query);
+    void executeExecute(const ExecuteQuery& query);
+    void executeDeallocate(const DeallocateQuery& query);
+
+    std::shared_ptr<Shared> shared_;
+    Catalog& catalog_;
+    PlanCache& planCache_;
+    // Named statements created by PREPARE
+    std::unordered_map<std::string, std::shared_ptr<PreparedStatement>> prepared_;
+    // Opened by BEGIN, null in autocommit mode. Destroyed before shared_,
+    // so an open transaction is rolled back while the catalog still exists.
+    std::unique_ptr<Transaction> txn_;
 
     // Executors
     std::unique_ptr<DDLExecutor> ddlExecutor_;
@@ -30,6 +213,26 @@ private:
     std::unique_ptr<SelectExecutor> selectExecutor_;
     std::unique_ptr<AggregateExecutor> aggregateExecutor_;
     std::unique_ptr<JoinExecutor> joinExecutor_;
+    std::unique_ptr<CopyExecutor> copyExecutor_;
+
+    SlowQueryLog& slowLog_;
+    // Set while a statement runs under the slow query log, so that the
+    // SELECT it executes (directly or via EXECUTE) records its plan
+    QueryPlan* capturePlan_ = nullptr;
+
+    // Statement outcomes; SELECT results on the console bypass it through
+    // console_, unless executeSQL was given a sink for them
+    std::ostream& out_;
+    RowSink* results_ = nullptr;
+    BufferedWriter console_;
+    OutputMode outputMode_ = OutputMode::TABLE;
+
+    // submit() queue; asyncRunning_ is set while a pool task owns it
+    std::mutex asyncMutex_;
+    std::condition_variable asyncIdle_;
+    std::deque<Submitted> submitted_;
+    std::shared_ptr<CancellationToken> runningToken_;
+    bool asyncRunning_ = false;
 };
 
 } // namespace nanodb
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// A parsed statement ready to be bound and executed. The query is shared
+// with the plan cache; binding rewrites its parameter values in place.
+struct PreparedStatement {
+    std::string sql;
+    std::shared_ptr<Query> query;
+    uint64_t schemaVersion = 0;     // Catalog::schemaVersion() when parsed
+
+    size_t paramCount() const { return query->paramSlots.size(); }
+};
+
+// LRU cache of parsed statements keyed by SQLParser::normalize(sql).
+// Entries remember the catalog schema version they were parsed under and
+// are dropped on lookup once DDL has moved the version on. Safe to share
+// between sessions; cached queries are never modified once inserted.
+class PlanCache {
+public:
+    explicit PlanCache(size_t capacity = kDefaultCapacity) : capacity_(capacity) {}
+
+    // Returns nullptr on a miss or a stale entry
+    std::shared_ptr<Query> lookup(const std::string& key, uint64_t schemaVersion);
+    void insert(const std::string& key, std::shared_ptr<Query> query, uint64_t schemaVersion);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+    static constexpr size_t kDefaultCapacity = 256;
+    // Longer statements (bulk INSERTs) are parsed but never cached
+    static constexpr size_t kMaxStatementLength = 4096;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<Query> query;
+        uint64_t schemaVersion;
+    };
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;      // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> map_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+} // namespace nanodb
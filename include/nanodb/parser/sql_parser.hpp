@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <memory>
 #include "nanodb/core/types.hpp"
 
@@ -7,25 +8,19 @@ namespace nanodb {
 
 class SQLParser {
 public:
-    static std::unique_ptr<Query> parse(const std::string& sql);
+    // Returns nullptr on failure
+    static std::unique_ptr<Query> parse(std::string_view sql);
+    // Same, but describes the failure in error
+    static std::unique_ptr<Query> parse(std::string_view sql, std::string& error);
 
-private:
-    static std::string trim(const std::string& str);
-    static std::string toUpper(const std::string& str);
-    static Value parseValue(const std::string& val);
-    static Condition parseSingleCondition(const std::string& condStr);
-    static void parseWhereClause(const std::string& sql, const std::string& upper, WhereClause& where);
-    static void parseOrderBy(const std::string& sql, const std::string& upper, SelectQuery& query);
-    static void parseAggregates(const std::string& columnsPart, SelectQuery& query);
-    static void parseGroupBy(const std::string& sql, const std::string& upper, SelectQuery& query);
-    static void parseHaving(const std::string& sql, const std::string& upper, SelectQuery& query);
-    static void parseJoin(const std::string& sql, const std::string& upper, SelectQuery& query);
-    static std::unique_ptr<CreateQuery> parseCreateTable(const std::string& sql);
-    static std::unique_ptr<InsertQuery> parseInsert(const std::string& sql);
-    static std::unique_ptr<SelectQuery> parseSelect(const std::string& sql);
-    static std::unique_ptr<DeleteQuery> parseDelete(const std::string& sql);
-    static std::unique_ptr<DropQuery> parseDropTable(const std::string& sql);
-    static std::unique_ptr<UpdateQuery> parseUpdate(const std::string& sql);
+    // Substitutes params, in order, for the query's '?' placeholders.
+    // Binding overwrites the previous values, so a parsed query can be
+    // re-bound and re-executed any number of times.
+    static bool bind(Query& query, const std::vector<Value>& params, std::string& error);
+
+    // Collapses whitespace between tokens and drops a trailing ';', so
+    // statements differing only in layout share a plan cache entry
+    static std::string normalize(std::string_view sql);
 };
 
 } // namespace nanodb
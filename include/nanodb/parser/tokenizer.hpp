@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string_view>
+
+namespace nanodb {
+
+enum class TokenType {
+    IDENTIFIER,   // Keywords are identifiers too; the parser matches them case-insensitively
+    NUMBER,
+    STRING,       // text excludes the quotes
+    SYMBOL,       // ( ) , ; . * - = != <> < <= > >= ?
+    END,
+    INVALID       // Unterminated string or stray character
+};
+
+struct Token {
+    TokenType type = TokenType::END;
+    std::string_view text;      // Points into the statement; never copied
+    size_t offset = 0;          // Byte offset of the token in the statement
+    bool escaped = false;       // STRING contains doubled quotes to unescape
+};
+
+// Single-pass lexer over a statement. Tokens are views into the input, so
+// the statement must outlive every token handed out.
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view sql) : sql_(sql) {}
+
+    Token next();
+    std::string_view source() const { return sql_; }
+
+private:
+    std::string_view sql_;
+    size_t pos_ = 0;
+};
+
+// ASCII case-insensitive comparison, for keyword matching without toupper copies
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+} // namespace nanodb
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "nanodb/executor/result_set.hpp"
+#include "nanodb/server/protocol.hpp"
+
+namespace nanodb {
+
+// Blocking client for Server. Results come back as ResultSets that own
+// their rows; statements without rows give an empty result, with the
+// server's outcome message in message().
+//
+// Statements may be pipelined: send() only buffers, and receive() returns
+// the results in the order the statements were sent, flushing first.
+//
+//   client.send("INSERT INTO t VALUES (1)");
+//   client.send("SELECT * FROM t");
+//   ResultSet inserted = client.receive();
+//   ResultSet rows = client.receive();
+class Client {
+public:
+    Client() = default;
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    bool connectTcp(const std::string& host, uint16_t port, std::string& error);
+    bool connectUnix(const std::string& path, std::string& error);
+    bool connected() const { return fd_ >= 0; }
+    void close();
+
+    void send(const std::string& sql);
+    // Writes every buffered statement; false if the connection failed
+    bool flush();
+    // Result of the oldest statement not yet received. If the connection
+    // fails, the result carries the error and the client is closed.
+    ResultSet receive();
+    // Statements sent whose results have not been received
+    size_t pending() const { return pending_; }
+
+    // send() and receive() one statement
+    ResultSet query(const std::string& sql);
+
+    // Outcome message of the last statement received, e.g. "1 row inserted."
+    const std::string& message() const { return message_; }
+
+private:
+    // Blocks until a whole frame is buffered at input_[inputPos_]. The
+    // frame points into input_ and stays valid until the next call.
+    bool readFrame(Frame& frame, size_t& frameBytes, std::string& error);
+    // Closes the connection, reporting error through result
+    ResultSet fail(ResultSet result, const std::string& error);
+
+    int fd_ = -1;
+    std::string output_;    // Statements not yet written
+    std::string input_;     // Received bytes, consumed from inputPos_
+    size_t inputPos_ = 0;
+    size_t pending_ = 0;
+    std::string message_;
+};
+
+} // namespace nanodb
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+
+namespace nanodb {
+
+// Wire protocol between Server and Client. Every message is a frame: a u32
+// length of the rest of the frame, a u8 MessageType, then the payload.
+// Integers are little-endian and values are encoded as in the binary COPY
+// format: a u8 tag (0 NULL, 1 INT + i32, 2 STRING + u32 length + bytes).
+//
+// A client sends QUERY frames and may send more before the results of
+// earlier ones arrive. The server answers every QUERY, in the order
+// received: a statement that returns rows gets a COLUMNS frame and ROWS
+// frames, and each statement ends with exactly one DONE or ERROR frame.
+enum class MessageType : uint8_t {
+    QUERY = 'Q',    // SQL text of one statement
+    COLUMNS = 'C',  // u32 count, per column a u8 type (0 INT, 1 STRING) and a u32-length name
+    ROWS = 'R',     // u32 row count, then every value of every row in column order
+    DONE = 'D',     // The statement's outcome message, e.g. "1 row inserted."
+    ERROR = 'E'     // Why the statement failed; rows sent before it are void
+};
+
+constexpr size_t kFrameHeaderBytes = 5;
+// Longer frames are rejected as malformed
+constexpr uint32_t kMaxFrameBytes = 64 << 20;
+
+// Appends frames to a byte buffer
+class FrameWriter {
+public:
+    explicit FrameWriter(std::string& out) : out_(out) {}
+
+    // Starts a frame; end() fills in its length
+    void begin(MessageType type);
+    void end();
+
+    void putU8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+    void putU32(uint32_t value);
+    void putString(std::string_view s);
+    void putValue(const Value& value);
+    // Overwrites a u32 put earlier at offset, e.g. a count known only later
+    void setU32(size_t offset, uint32_t value);
+    size_t size() const { return out_.size(); }
+
+    // Whole frames
+    void text(MessageType type, std::string_view text);
+    void columns(const std::vector<Column>& columns);
+
+private:
+    std::string& out_;
+    size_t start_ = 0;
+};
+
+struct Frame {
+    MessageType type = MessageType::QUERY;
+    std::string_view payload;
+};
+
+enum class FrameStatus { COMPLETE, INCOMPLETE, MALFORMED };
+
+// Looks for a whole frame at the start of data; on COMPLETE, frame points
+// into data and frameBytes is how much of data it took
+FrameStatus nextFrame(std::string_view data, Frame& frame, size_t& frameBytes);
+
+// Sequential reader over a frame's payload; every read fails, rather than
+// overrunning, on truncated input
+class FrameReader {
+public:
+    explicit FrameReader(std::string_view payload) : data_(payload) {}
+
+    bool atEnd() const { return pos_ >= data_.size(); }
+
+    bool readU8(uint8_t& out);
+    bool readU32(uint32_t& out);
+    bool readString(std::string& out);
+    bool readValue(Value& out);
+    bool readColumns(std::vector<Column>& out);
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+} // namespace nanodb
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nanodb/nanodb.hpp"
+
+namespace nanodb {
+
+// Serves a database over TCP and/or a Unix domain socket, speaking the
+// protocol in protocol.hpp. One thread runs an epoll loop that accepts
+// connections and does all socket reads and writes; statements run on a
+// pool of worker threads. Every connection gets a session of its own (see
+// NanoDB::openSession), so transactions and prepared statements are per
+// connection. A connection may pipeline statements: they run one at a
+// time in arrival order, on whichever worker is free, and their results
+// go out in that order. Workers take turns between connections after
+// every statement.
+class Server {
+public:
+    // workers = 0 starts one per hardware thread
+    explicit Server(NanoDB& db, size_t workers = 0);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // Call before run(), either or both. Port 0 binds a free port, which
+    // port() then returns. An existing socket file at path is replaced.
+    bool listenTcp(const std::string& host, uint16_t port, std::string& error);
+    bool listenUnix(const std::string& path, std::string& error);
+    uint16_t port() const { return port_; }
+
+    // Serves on the calling thread until stop(), then closes every
+    // connection, rolling back their open transactions
+    bool run(std::string& error);
+    // Safe to call from any thread, and from a signal handler
+    void stop();
+
+    static constexpr uint16_t kDefaultPort = 5480;
+    // A worker producing a result waits while this much of the
+    // connection's output is unsent, so that a client reading slowly does
+    // not make the server buffer whole results
+    static constexpr size_t kMaxPendingOutput = 4 << 20;
+    // Result rows go out in ROWS frames of at most this many rows
+    static constexpr size_t kRowsPerFrame = 1024;
+
+private:
+    struct Connection;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    bool addListener(int fd, std::string& error);
+    void accept(int listenFd);
+    void read(const ConnectionPtr& conn);
+    // Sends queued output until done or the socket is full
+    void write(const ConnectionPtr& conn);
+    // Closes once a connection the client has finished with is idle
+    void closeIfDone(const ConnectionPtr& conn);
+    void close(const ConnectionPtr& conn);
+    void updateEvents(const ConnectionPtr& conn);
+    // Writes out connections that workers produced output for
+    void flushReady();
+
+    // Worker side
+    void workerLoop();
+    void schedule(const ConnectionPtr& conn);
+    // Runs a connection's next statement
+    void serve(const ConnectionPtr& conn);
+    // Moves encoded frames to the connection's output for the event loop,
+    // first waiting while too much is unsent. lock holds conn's mutex.
+    // Returns false, dropping the frames, once the connection is closed.
+    bool deliver(const ConnectionPtr& conn, std::unique_lock<std::mutex>& lock, std::string& frames);
+
+    NanoDB& db_;
+    size_t workerCount_;
+    uint16_t port_ = 0;
+    std::string unixPath_;
+    std::vector<int> listenFds_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;   // eventfd: output ready, or stop()
+    std::atomic<bool> stopping_{false};
+
+    // Event loop thread only
+    std::unordered_map<int, ConnectionPtr> connections_;
+
+    // Connections with statements to run, in turn
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::deque<ConnectionPtr> queue_;
+    bool workersStopping_ = false;
+    std::vector<std::thread> workers_;
+
+    // Connections with output for the event loop to send
+    std::mutex outputMutex_;
+    std::vector<ConnectionPtr> outputReady_;
+};
+
+} // namespace nanodb
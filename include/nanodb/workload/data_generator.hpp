@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nanodb/core/types.hpp"
+#include "nanodb/catalog/catalog.hpp"
+#include "nanodb/executor/row_sink.hpp"
+
+namespace nanodb {
+
+enum class Distribution {
+    SEQUENTIAL,     // Row number: 0, 1, 2, ...
+    UNIFORM,        // Uniform over 0..cardinality-1
+    ZIPF,           // Key k (0-based) with probability proportional to 1/(k+1)^skew
+    CORRELATED      // Source column's key plus uniform noise in 0..spread
+};
+
+// How one generated column draws its values. Every value comes from an
+// integer key; INT columns store the key, STRING columns store "<name>_<key>",
+// so cardinality controls the number of distinct strings as well.
+struct GeneratedColumn {
+    std::string name;
+    ColumnType type = ColumnType::INT;
+    Distribution distribution = Distribution::UNIFORM;
+    size_t cardinality = 1000;      // UNIFORM, ZIPF
+    double skew = 1.0;              // ZIPF
+    std::string source;             // CORRELATED: an earlier column of the table
+    size_t spread = 0;              // CORRELATED
+};
+
+struct TableSpec {
+    std::string name;
+    size_t rows = 0;
+    std::vector<GeneratedColumn> columns;
+
+    // Parses the compact form used on the command line:
+    //   table:rows col:type:dist ...
+    // with type int|string and dist one of seq, uniform(N), zipf(N[,skew])
+    // or corr(source[,spread]), e.g.
+    //   orders:100000 id:int:seq cust:int:zipf(5000,1.1) region:string:uniform(8)
+    static bool parse(std::string_view text, TableSpec& spec, std::string& error);
+
+    // Checks names, cardinalities and that CORRELATED sources come earlier
+    bool validate(std::string& error) const;
+    std::vector<Column> schema() const;
+    std::string createSQL() const;
+};
+
+// Produces a table's rows deterministically from a seed. The spec must be
+// valid (TableSpec::validate); load() and writeSnapshot() check it first.
+class DataGenerator {
+public:
+    explicit DataGenerator(TableSpec spec, uint64_t seed = 42);
+
+    const TableSpec& spec() const { return spec_; }
+
+    // Streams spec().rows rows, in table column order, through sink
+    void generate(RowSink& sink);
+    // Creates the table in the catalog and appends the rows in batches
+    bool load(Catalog& catalog, std::string& error);
+    // Writes the rows in the binary COPY format, loadable with
+    // COPY table FROM 'path' (FORMAT BINARY)
+    bool writeSnapshot(const std::string& path, std::string& error);
+
+    // Rows buffered per appendRows call by load()
+    static constexpr size_t kLoadBatchRows = 64 * 1024;
+
+private:
+    TableSpec spec_;
+    uint64_t seed_;
+};
+
+} // namespace nanodb
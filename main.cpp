@@ -1,17 +1,258 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
 
 #include "nanodb/nanodb.hpp"
 
-int main() {
-    nanodb::NanoDB db;
-    while (true) {
-        std::cout << "nanodb> ";
-        std::string sql;
-        std::getline(std::cin, sql);
-        if (sql == "exit" || sql == "quit") {
-            break;
+namespace {
+
+struct Options {
+    std::string scriptPath;     // -f: run this file
+    bool interactive = false;   // -i: prompt even when stdin is not a terminal
+    bool quiet = false;         // -q: do not print SELECT results
+    bool timer = false;         // -t: same as .timer on
+    std::string slowLogPath;    // -l: same as .slowlog FILE
+    double slowLogMs = 100;     // -L: slow query threshold
+    double memoryLimitMb = 0;   // -M: same as .memlimit MB
+};
+
+void printUsage() {
+    std::cout << "Usage: nanodb [-f script.sql] [-i] [-q] [-t] [-l slow.log [-L MS]] [-M MB]\n"
+              << "  -f FILE  run the statements in FILE, then exit\n"
+              << "  -i       interactive prompt even if stdin is not a terminal\n"
+              << "  -q       run SELECTs without printing their results\n"
+              << "  -t       print the run time of every statement\n"
+              << "  -l FILE  append statements slower than the threshold to FILE\n"
+              << "  -L MS    slow query threshold in milliseconds (default 100)\n"
+              << "  -M MB    memory limit for query intermediate state (default none)\n";
+}
+
+// .mode table|csv|tsv|json|none selects how SELECT results are printed
+bool setMode(nanodb::NanoDB& db, const std::string& name) {
+    if (name == "table") {
+        db.setOutputMode(nanodb::OutputMode::TABLE);
+    } else if (name == "csv") {
+        db.setOutputMode(nanodb::OutputMode::CSV);
+    } else if (name == "tsv") {
+        db.setOutputMode(nanodb::OutputMode::TSV);
+    } else if (name == "json") {
+        db.setOutputMode(nanodb::OutputMode::JSON);
+    } else if (name == "none") {
+        db.setOutputMode(nanodb::OutputMode::NONE);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void setMemoryLimit(double megabytes) {
+    nanodb::MemoryTracker::setLimit(static_cast<size_t>(megabytes * (1 << 20)));
+}
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+class Shell {
+public:
+    explicit Shell(const Options& options) : timer_(options.timer) {
+        if (options.quiet) {
+            db_.setOutputMode(nanodb::OutputMode::NONE);
+        }
+    }
+
+    bool enableSlowLog(const std::string& path, double thresholdMs) {
+        std::string error;
+        if (!db_.enableSlowQueryLog(path, thresholdMs, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // One statement per line, as typed
+    void runInteractive() {
+        std::string line;
+        while (true) {
+            std::cout << "nanodb> " << std::flush;
+            if (!std::getline(std::cin, line)) {
+                std::cout << "\n";
+                break;
+            }
+            std::string text = trim(line);
+            if (text == "exit" || text == "quit") {
+                break;
+            }
+            if (!text.empty() && text[0] == '.') {
+                if (!runCommand(text)) break;
+                continue;
+            }
+            execute(line);
+        }
+    }
+
+    // Splits the script on ';' (outside quotes and -- comments) and runs the
+    // statements back to back. Dot commands and exit/quit are recognized
+    // on a line of their own between statements.
+    void runScript(std::istream& in) {
+        std::string statement;
+        std::string line;
+        char quote = 0;
+        while (std::getline(in, line)) {
+            if (quote == 0 && trim(statement).empty()) {
+                std::string text = trim(line);
+                if (text == "exit" || text == "quit") {
+                    return;
+                }
+                if (!text.empty() && text[0] == '.') {
+                    if (!runCommand(text)) return;
+                    continue;
+                }
+            }
+
+            for (size_t i = 0; i < line.size(); ++i) {
+                char c = line[i];
+                if (quote != 0) {
+                    if (c == quote) quote = 0;  // A doubled quote re-enters the literal
+                    statement += c;
+                } else if (c == '\'' || c == '"') {
+                    quote = c;
+                    statement += c;
+                } else if (c == '-' && i + 1 < line.size() && line[i + 1] == '-') {
+                    break;  // Comment to end of line
+                } else if (c == ';') {
+                    execute(statement);
+                    statement.clear();
+                } else {
+                    statement += c;
+                }
+            }
+            statement += '\n';
+        }
+        // A final statement may omit its semicolon
+        execute(statement);
+        std::cout.flush();
+    }
+
+private:
+    // Returns false to stop the shell
+    bool runCommand(const std::string& text) {
+        std::istringstream words(text);
+        std::string command, arg, extra;
+        words >> command >> arg >> extra;
+        if (command == ".exit" || command == ".quit") {
+            return false;
+        }
+        if (command == ".timer" && (arg == "on" || arg == "off")) {
+            timer_ = arg == "on";
+        } else if (command == ".mode" && setMode(db_, arg)) {
+            // Mode set
+        } else if (command == ".memlimit" && arg == "off") {
+            nanodb::MemoryTracker::setLimit(0);
+        } else if (command == ".memlimit" && std::strtod(arg.c_str(), nullptr) > 0) {
+            setMemoryLimit(std::strtod(arg.c_str(), nullptr));
+        } else if (command == ".slowlog" && arg == "off") {
+            db_.disableSlowQueryLog();
+        } else if (command == ".slowlog" && !arg.empty()) {
+            enableSlowLog(arg, extra.empty() ? 100 : std::strtod(extra.c_str(), nullptr));
+        } else if (command == ".help") {
+            std::cout << ".mode table|csv|tsv|json|none  output format for SELECT results\n"
+                      << ".timer on|off                   print run time after each statement\n"
+                      << ".slowlog FILE [MS]|off          log statements slower than MS (default 100)\n"
+                      << ".memlimit MB|off                cap memory used by running queries\n"
+                      << ".exit                           leave the shell\n";
+        } else {
+            std::cout << "Error: Unknown command or bad argument: " << text << " (see .help)\n";
+        }
+        return true;
+    }
+
+    void execute(const std::string& sql) {
+        if (trim(sql).empty()) return;
+        if (!timer_) {
+            db_.executeSQL(sql);
+            return;
+        }
+
+        auto wallStart = std::chrono::steady_clock::now();
+        rusage usageStart;
+        getrusage(RUSAGE_SELF, &usageStart);
+
+        db_.executeSQL(sql);
+
+        rusage usageEnd;
+        getrusage(RUSAGE_SELF, &usageEnd);
+        std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+        char line[128];
+        std::snprintf(line, sizeof(line), "Run Time: real %.6f user %.6f sys %.6f\n", wall.count(),
+                      seconds(usageEnd.ru_utime) - seconds(usageStart.ru_utime),
+                      seconds(usageEnd.ru_stime) - seconds(usageStart.ru_stime));
+        std::cout << line;
+    }
+
+    static double seconds(const timeval& tv) {
+        return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+    }
+
+    nanodb::NanoDB db_;
+    bool timer_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) {
+            options.scriptPath = argv[++i];
+        } else if (arg == "-i") {
+            options.interactive = true;
+        } else if (arg == "-q") {
+            options.quiet = true;
+        } else if (arg == "-t") {
+            options.timer = true;
+        } else if (arg == "-l" && i + 1 < argc) {
+            options.slowLogPath = argv[++i];
+        } else if (arg == "-L" && i + 1 < argc) {
+            options.slowLogMs = std::strtod(argv[++i], nullptr);
+        } else if (arg == "-M" && i + 1 < argc) {
+            options.memoryLimitMb = std::strtod(argv[++i], nullptr);
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    setMemoryLimit(options.memoryLimitMb);
+    Shell shell(options);
+    if (!options.slowLogPath.empty() && !shell.enableSlowLog(options.slowLogPath, options.slowLogMs)) {
+        return 1;
+    }
+    if (!options.scriptPath.empty()) {
+        std::ifstream script(options.scriptPath);
+        if (!script) {
+            std::cerr << "Error: Cannot open file '" << options.scriptPath << "'.\n";
+            return 1;
         }
-        db.executeSQL(sql);
+        shell.runScript(script);
+    } else if (options.interactive || isatty(STDIN_FILENO)) {
+        shell.runInteractive();
+    } else {
+        // Piped input runs as a script with stdout fully buffered
+        std::ios::sync_with_stdio(false);
+        shell.runScript(std::cin);
     }
 
     return 0;
@@ -0,0 +1,104 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "nanodb/nanodb.hpp"
+#include "nanodb/server/server.hpp"
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";     // -H: TCP address to listen on
+    int port = -1;                      // -p: TCP port
+    std::string socketPath;             // -u: Unix domain socket
+    size_t workers = 0;                 // -w: worker threads
+    std::string slowLogPath;            // -l: slow query log
+    double slowLogMs = 100;             // -L: slow query threshold
+    double memoryLimitMb = 0;           // -M: query memory limit
+};
+
+void printUsage() {
+    std::cout << "Usage: nanodb_server [-H host] [-p port] [-u socket] [-w N] [-l slow.log [-L MS]] [-M MB]\n"
+              << "  -H HOST  TCP address to listen on (default 127.0.0.1)\n"
+              << "  -p PORT  TCP port (default " << nanodb::Server::kDefaultPort << "; 0 picks a free one)\n"
+              << "  -u PATH  listen on a Unix domain socket, and on TCP only if -p is given\n"
+              << "  -w N     worker threads running statements (default one per CPU)\n"
+              << "  -l FILE  append statements slower than the threshold to FILE\n"
+              << "  -L MS    slow query threshold in milliseconds (default 100)\n"
+              << "  -M MB    memory limit for query intermediate state (default none)\n";
+}
+
+nanodb::Server* gServer = nullptr;
+
+void handleSignal(int) {
+    if (gServer) gServer->stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-H" && i + 1 < argc) {
+            options.host = argv[++i];
+        } else if (arg == "-p" && i + 1 < argc) {
+            options.port = std::atoi(argv[++i]);
+        } else if (arg == "-u" && i + 1 < argc) {
+            options.socketPath = argv[++i];
+        } else if (arg == "-w" && i + 1 < argc) {
+            options.workers = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-l" && i + 1 < argc) {
+            options.slowLogPath = argv[++i];
+        } else if (arg == "-L" && i + 1 < argc) {
+            options.slowLogMs = std::strtod(argv[++i], nullptr);
+        } else if (arg == "-M" && i + 1 < argc) {
+            options.memoryLimitMb = std::strtod(argv[++i], nullptr);
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.port > 65535) {
+        std::cerr << "Error: Invalid port " << options.port << ".\n";
+        return 1;
+    }
+
+    nanodb::MemoryTracker::setLimit(static_cast<size_t>(options.memoryLimitMb * (1 << 20)));
+    nanodb::NanoDB db;
+    std::string error;
+    if (!options.slowLogPath.empty() && !db.enableSlowQueryLog(options.slowLogPath, options.slowLogMs, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    nanodb::Server server(db, options.workers);
+    if (!options.socketPath.empty()) {
+        if (!server.listenUnix(options.socketPath, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        std::cerr << "Listening on " << options.socketPath << "\n";
+    }
+    if (options.socketPath.empty() || options.port >= 0) {
+        uint16_t port = options.port >= 0 ? static_cast<uint16_t>(options.port) : nanodb::Server::kDefaultPort;
+        if (!server.listenTcp(options.host, port, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        std::cerr << "Listening on " << options.host << ":" << server.port() << "\n";
+    }
+
+    gServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    bool ok = server.run(error);
+    gServer = nullptr;
+    if (!ok) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include "nanodb/catalog/catalog.hpp"
+#include "nanodb/core/memory.hpp"
+
+#include <algorithm>
 
 namespace nanodb {
 
@@ -6,10 +9,11 @@ bool Catalog::createTable(const std::string& name, const std::vector<Column>& co
     if (tableExists(name)) {
         return false;
     }
-    Table table;
+    Table& table = tables_[name];
     table.name = name;
     table.columns = columns;
-    tables_[name] = table;
+    tableLocks_[name] = std::make_unique<TableLocks>();
+    ++schemaVersion_;
     return true;
 }
 
@@ -19,6 +23,9 @@ bool Catalog::dropTable(const std::string& name) {
         return false;
     }
     tables_.erase(it);
+    indexes_.erase(name);
+    tableLocks_.erase(name);
+    ++schemaVersion_;
     return true;
 }
 
@@ -42,4 +49,199 @@ const Table* Catalog::getTable(const std::string& name) const {
     return nullptr;
 }
 
+std::vector<std::string> Catalog::tableNames() const {
+    std::vector<std::string> names;
+    names.reserve(tables_.size());
+    for (const auto& [name, table] : tables_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+bool Catalog::createIndex(std::unique_ptr<Index> index) {
+    if (indexExists(index->name())) {
+        return false;
+    }
+    const Table* table = getTable(index->tableName());
+    if (!table) {
+        return false;
+    }
+    index->rebuild(*table);
+    indexes_[index->tableName()].push_back(std::move(index));
+    ++schemaVersion_;
+    return true;
+}
+
+bool Catalog::dropIndex(const std::string& indexName) {
+    for (auto& [tableName, list] : indexes_) {
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if ((*it)->name() == indexName) {
+                list.erase(it);
+                ++schemaVersion_;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Catalog::indexExists(const std::string& indexName) const {
+    for (const auto& [tableName, list] : indexes_) {
+        for (const auto& index : list) {
+            if (index->name() == indexName) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const std::vector<std::unique_ptr<Index>>& Catalog::getIndexes(const std::string& tableName) const {
+    static const std::vector<std::unique_ptr<Index>> empty;
+    auto it = indexes_.find(tableName);
+    if (it != indexes_.end()) {
+        return it->second;
+    }
+    return empty;
+}
+
+const Index* Catalog::findIndex(const std::string& tableName, const std::string& column, IndexType type) const {
+    for (const auto& index : getIndexes(tableName)) {
+        if (index->type() == type && index->column() == column) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+TableMemory Catalog::memoryUsage(const Table& table) const {
+    TableMemory usage;
+    usage.rows = table.liveRowCount();
+    // approxRowBytes counts each row's own vector header; add the version
+    // stamps and unused capacity of the row store
+    usage.dataBytes = table.rows.overheadBytes();
+    for (size_t i = 0; i < table.rows.size(); ++i) {
+        usage.dataBytes += approxRowBytes(table.rows[i]);
+    }
+    std::shared_lock<std::shared_mutex> latch(indexLatch(table.name));
+    for (const auto& index : getIndexes(table.name)) {
+        usage.indexBytes += index->memoryBytes();
+    }
+    return usage;
+}
+
+size_t Catalog::compactTable(Table& table) {
+    if (table.deadVersions.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+    // Undo logs of open transactions hold row ids into the table. Only
+    // statements add writers, and they are locked out, so the count holds.
+    if (table.pendingWriters.load(std::memory_order_acquire) > 0) {
+        return 0;
+    }
+
+    // A version that ended at or before every snapshot in use is gone for
+    // good; one ended by a transaction still running is not (its end is
+    // the transaction id, larger than any snapshot)
+    uint64_t horizon = transactions_.oldestSnapshot();
+    auto reclaimable = [&](size_t rowId) {
+        return table.rows.version(rowId).end.load(std::memory_order_acquire) <= horizon;
+    };
+
+    // Single forward pass: slide surviving versions down over the reclaimed ones
+    size_t count = table.rows.size();
+    size_t write = 0;
+    for (size_t read = 0; read < count; ++read) {
+        if (reclaimable(read)) continue;
+        if (write != read) {
+            table.rows.move(read, write);
+        }
+        ++write;
+    }
+
+    size_t reclaimed = count - write;
+    table.rows.truncate(write);
+    table.deadVersions.fetch_sub(reclaimed, std::memory_order_relaxed);
+
+    // Row ids shifted, so every index on the table is rebuilt
+    if (reclaimed > 0) {
+        for (const auto& index : getIndexes(table.name)) {
+            index->rebuild(table);
+        }
+    }
+    return reclaimed;
+}
+
+bool Catalog::compactionDue(const Table& table) const {
+    if (table.pendingWriters.load(std::memory_order_acquire) > 0) return false;
+    size_t dead = table.deadVersions.load(std::memory_order_relaxed);
+    if (dead < kCompactionMinDeleted) return false;
+    return dead * 100 >= table.rows.size() * kCompactionDeletedPercent;
+}
+
+size_t Catalog::collectGarbage(bool wait) {
+    std::shared_lock<std::shared_mutex> schema(schemaMutex_, std::defer_lock);
+    if (wait) {
+        schema.lock();
+    } else if (!schema.try_lock()) {
+        return 0;
+    }
+
+    size_t reclaimed = 0;
+    for (auto& [name, table] : tables_) {
+        if (!compactionDue(table)) continue;
+        std::unique_lock<std::shared_mutex> lock(tableLocks_.at(name)->table, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        } else {
+            lock.try_lock();
+        }
+        if (lock.owns_lock()) {
+            reclaimed += compactTable(table);
+        }
+    }
+    return reclaimed;
+}
+
+std::shared_mutex& Catalog::indexLatch(const std::string& tableName) const {
+    return tableLocks_.at(tableName)->indexes;
+}
+
+StatementLock::StatementLock(Catalog& catalog, Mode mode) : catalog_(&catalog) {
+    if (mode == Mode::SHARED) {
+        shared_ = std::shared_lock<std::shared_mutex>(catalog.schemaMutex_);
+    } else if (mode == Mode::SCHEMA) {
+        schema_ = std::unique_lock<std::shared_mutex>(catalog.schemaMutex_);
+    }
+}
+
+void StatementLock::unlock() {
+    writers_.clear();
+    exclusive_.clear();
+    tables_.clear();
+    if (schema_.owns_lock()) schema_.unlock();
+    if (shared_.owns_lock()) shared_.unlock();
+}
+
+void StatementLock::lockTables(std::vector<std::pair<std::string, Access>> tables) {
+    // By name, strongest access first, so each table is locked once and in order
+    std::sort(tables.begin(), tables.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first || (a.first == b.first && a.second > b.second);
+    });
+    for (size_t i = 0; i < tables.size(); ++i) {
+        if (i > 0 && tables[i].first == tables[i - 1].first) continue;
+        auto it = catalog_->tableLocks_.find(tables[i].first);
+        if (it == catalog_->tableLocks_.end()) continue;
+        Catalog::TableLocks& locks = *it->second;
+        if (tables[i].second == Access::EXCLUSIVE) {
+            exclusive_.emplace_back(locks.table);
+            continue;
+        }
+        tables_.emplace_back(locks.table);
+        if (tables[i].second == Access::WRITE) {
+            writers_.emplace_back(locks.writer);
+        }
+    }
+}
+
 } // namespace nanodb
@@ -0,0 +1,43 @@
+#include "nanodb/catalog/garbage_collector.hpp"
+#include "nanodb/catalog/catalog.hpp"
+
+#include <chrono>
+
+namespace nanodb {
+
+GarbageCollector::~GarbageCollector() {
+    stop();
+}
+
+void GarbageCollector::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (worker_.joinable()) return;
+    stopping_ = false;
+    worker_ = std::thread([this] { run(); });
+    running_ = true;
+}
+
+void GarbageCollector::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!worker_.joinable()) return;
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+    running_ = false;
+}
+
+void GarbageCollector::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (int round = 1; !wake_.wait_for(lock, std::chrono::milliseconds(kIntervalMs), [this] { return stopping_; });
+         ++round) {
+        // Compaction happens outside the lock so stop() never waits on it for long
+        lock.unlock();
+        bool wait = round % kWaitEveryRounds == 0;
+        reclaimed_.fetch_add(catalog_.collectGarbage(wait), std::memory_order_relaxed);
+        lock.lock();
+    }
+}
+
+} // namespace nanodb
@@ -0,0 +1,57 @@
+#include "nanodb/core/cancellation.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace nanodb {
+
+namespace {
+
+thread_local const CancellationToken* gCurrent = nullptr;
+
+int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void CancellationToken::cancel() {
+    int active = ACTIVE;
+    state_.compare_exchange_strong(active, CANCELLED, std::memory_order_relaxed);
+}
+
+void CancellationToken::setTimeout(double timeoutMs) {
+    timeoutMs_ = timeoutMs;
+    deadlineNs_.store(steadyNanos() + static_cast<int64_t>(timeoutMs * 1e6), std::memory_order_relaxed);
+}
+
+bool CancellationToken::fired() const {
+    if (state_.load(std::memory_order_relaxed) != ACTIVE) return true;
+    int64_t deadline = deadlineNs_.load(std::memory_order_relaxed);
+    if (deadline == 0 || steadyNanos() < deadline) return false;
+    int active = ACTIVE;
+    state_.compare_exchange_strong(active, TIMED_OUT, std::memory_order_relaxed);
+    return true;
+}
+
+std::string CancellationToken::error() const {
+    if (state_.load(std::memory_order_relaxed) != TIMED_OUT) return "Query cancelled.";
+    char text[64];
+    std::snprintf(text, sizeof(text), "Query timed out after %g ms.", timeoutMs_);
+    return text;
+}
+
+bool CancellationToken::stopRequested() {
+    return gCurrent && gCurrent->fired();
+}
+
+CancellationScope::CancellationScope(const CancellationToken& token) : previous_(gCurrent) {
+    gCurrent = &token;
+}
+
+CancellationScope::~CancellationScope() {
+    gCurrent = previous_;
+}
+
+} // namespace nanodb
@@ -0,0 +1,90 @@
+#include "nanodb/core/memory.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+namespace nanodb {
+
+namespace {
+
+std::atomic<size_t> gLimit{0};
+std::atomic<size_t> gInUse{0};
+std::atomic<size_t> gPeak{0};
+
+} // namespace
+
+void MemoryTracker::setLimit(size_t bytes) {
+    gLimit.store(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::limit() {
+    return gLimit.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::inUse() {
+    return gInUse.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::peak() {
+    return gPeak.load(std::memory_order_relaxed);
+}
+
+bool MemoryTracker::reserve(size_t bytes) {
+    size_t limit = gLimit.load(std::memory_order_relaxed);
+    size_t used = gInUse.load(std::memory_order_relaxed);
+    size_t next;
+    do {
+        next = used + bytes;
+        if (limit != 0 && next > limit) return false;
+    } while (!gInUse.compare_exchange_weak(used, next, std::memory_order_relaxed));
+
+    size_t peak = gPeak.load(std::memory_order_relaxed);
+    while (next > peak && !gPeak.compare_exchange_weak(peak, next, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void MemoryTracker::release(size_t bytes) {
+    if (bytes > 0) gInUse.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool MemoryReservation::grow(size_t bytes) {
+    // Round up to whole chunks; close to the limit, take just what is needed
+    size_t target = (bytes + kChunkBytes - 1) / kChunkBytes * kChunkBytes;
+    if (!MemoryTracker::reserve(target - reserved_)) {
+        target = bytes;
+        if (!MemoryTracker::reserve(target - reserved_)) return false;
+    }
+    reserved_ = target;
+    return true;
+}
+
+std::string memoryLimitError() {
+    return "Query exceeded the memory limit of " + describeBytes(MemoryTracker::limit()) + ".";
+}
+
+size_t approxRowBytes(const Row& row) {
+    size_t bytes = sizeof(Row) + row.capacity() * sizeof(Value);
+    for (const auto& v : row) {
+        if (std::holds_alternative<std::string>(v)) {
+            const std::string& s = std::get<std::string>(v);
+            // Short strings live inside the Value itself
+            if (s.capacity() > 15) bytes += s.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+std::string describeBytes(size_t bytes) {
+    char text[32];
+    if (bytes >= (1 << 20)) {
+        std::snprintf(text, sizeof(text), "%.1f MiB", bytes / double(1 << 20));
+    } else if (bytes >= (1 << 10)) {
+        std::snprintf(text, sizeof(text), "%.1f KiB", bytes / double(1 << 10));
+    } else {
+        std::snprintf(text, sizeof(text), "%zu B", bytes);
+    }
+    return text;
+}
+
+} // namespace nanodb
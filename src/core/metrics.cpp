@@ -0,0 +1,298 @@
+#include "nanodb/core/metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace nanodb {
+
+namespace {
+
+// One thread's counters. Only the owning thread records into them, while
+// reset() and thread exit write from outside, so updates are atomic
+// read-modify-writes; readers see relaxed values, which is enough for
+// monitoring.
+struct MetricsShard {
+    struct Statement {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNanos{0};
+        std::atomic<uint64_t> maxNanos{0};
+        std::array<std::atomic<uint64_t>, LatencyHistogram::kBuckets> buckets{};
+    };
+
+    std::array<Statement, Metrics::kStatementTypes> statements;
+    std::atomic<uint64_t> rowsScanned{0};
+    std::atomic<uint64_t> rowsReturned{0};
+    std::atomic<uint64_t> bytesAllocated{0};
+    // Lifetime totals for threadUsage(); only the owning thread touches them
+    ResourceUsage usage;
+};
+
+void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void raise(std::atomic<uint64_t>& counter, uint64_t value) {
+    uint64_t current = counter.load(std::memory_order_relaxed);
+    while (value > current && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+// Adds the counts of one shard into another
+void mergeInto(MetricsShard& target, const MetricsShard& source) {
+    for (size_t t = 0; t < Metrics::kStatementTypes; ++t) {
+        const MetricsShard::Statement& from = source.statements[t];
+        MetricsShard::Statement& to = target.statements[t];
+        bump(to.count, from.count.load(std::memory_order_relaxed));
+        bump(to.totalNanos, from.totalNanos.load(std::memory_order_relaxed));
+        raise(to.maxNanos, from.maxNanos.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            uint64_t count = from.buckets[b].load(std::memory_order_relaxed);
+            if (count > 0) bump(to.buckets[b], count);
+        }
+    }
+    bump(target.rowsScanned, source.rowsScanned.load(std::memory_order_relaxed));
+    bump(target.rowsReturned, source.rowsReturned.load(std::memory_order_relaxed));
+    bump(target.bytesAllocated, source.bytesAllocated.load(std::memory_order_relaxed));
+}
+
+class Registry;
+Registry& registry();
+
+class Registry {
+public:
+    MetricsShard& local() {
+        // Registered on first use; the destructor runs at thread exit
+        struct Owner {
+            MetricsShard* shard = nullptr;
+            ~Owner() { if (shard) registry().retire(shard); }
+        };
+        thread_local Owner owner;
+        if (!owner.shard) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shards_.push_back(std::make_unique<MetricsShard>());
+            owner.shard = shards_.back().get();
+        }
+        return *owner.shard;
+    }
+
+    // Live shards plus the one holding the counts of exited threads
+    template <typename Fn>
+    void forEachShard(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn(retired_);
+        for (auto& shard : shards_) fn(*shard);
+    }
+
+    // Folds an exiting thread's shard into retired_ and frees it
+    void retire(MetricsShard* shard) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        mergeInto(retired_, *shard);
+        auto it = std::find_if(shards_.begin(), shards_.end(),
+                               [shard](const auto& owned) { return owned.get() == shard; });
+        std::swap(*it, shards_.back());
+        shards_.pop_back();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<MetricsShard>> shards_;
+    MetricsShard retired_;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+std::string formatMicros(uint64_t nanos) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f", nanos / 1000.0);
+    return text;
+}
+
+} // namespace
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    size_t magnitude = 63 - static_cast<size_t>(__builtin_clzll(value));
+    if (magnitude >= kMaxMagnitude) return kBuckets - 1;
+    // The kSubBucketBits bits below the leading one pick the linear bucket
+    size_t sub = static_cast<size_t>(value >> (magnitude - kSubBucketBits)) - kSubBuckets;
+    return (magnitude - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketValue(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    size_t magnitude = bucket / kSubBuckets + kSubBucketBits - 1;
+    size_t shift = magnitude - kSubBucketBits;
+    uint64_t low = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return low + (uint64_t(1) << shift) / 2;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total_ == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total_) + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total_));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        seen += counts_[b];
+        if (seen >= rank) return bucketValue(b);
+    }
+    return bucketValue(kBuckets - 1);
+}
+
+void Metrics::recordStatement(QueryType type, uint64_t nanos) {
+    MetricsShard::Statement& s = registry().local().statements[static_cast<size_t>(type)];
+    bump(s.count, 1);
+    bump(s.totalNanos, nanos);
+    raise(s.maxNanos, nanos);
+    bump(s.buckets[LatencyHistogram::bucketFor(nanos)], 1);
+}
+
+void Metrics::addRows(uint64_t scanned, uint64_t returned) {
+    MetricsShard& shard = registry().local();
+    bump(shard.rowsScanned, scanned);
+    bump(shard.rowsReturned, returned);
+    shard.usage.rowsScanned += scanned;
+    shard.usage.rowsReturned += returned;
+}
+
+void Metrics::addBytes(uint64_t bytes) {
+    MetricsShard& shard = registry().local();
+    bump(shard.bytesAllocated, bytes);
+    shard.usage.bytesAllocated += bytes;
+}
+
+ResourceUsage Metrics::threadUsage() {
+    return registry().local().usage;
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot snap;
+    std::vector<MetricsSnapshot::Statement> merged(kStatementTypes);
+    registry().forEachShard([&](const MetricsShard& shard) {
+        for (size_t t = 0; t < kStatementTypes; ++t) {
+            const MetricsShard::Statement& s = shard.statements[t];
+            MetricsSnapshot::Statement& m = merged[t];
+            m.count += s.count.load(std::memory_order_relaxed);
+            m.totalNanos += s.totalNanos.load(std::memory_order_relaxed);
+            m.maxNanos = std::max(m.maxNanos, s.maxNanos.load(std::memory_order_relaxed));
+            for (size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+                uint64_t count = s.buckets[b].load(std::memory_order_relaxed);
+                if (count > 0) m.latency.add(b, count);
+            }
+        }
+        snap.rowsScanned += shard.rowsScanned.load(std::memory_order_relaxed);
+        snap.rowsReturned += shard.rowsReturned.load(std::memory_order_relaxed);
+        snap.bytesAllocated += shard.bytesAllocated.load(std::memory_order_relaxed);
+    });
+    for (size_t t = 0; t < kStatementTypes; ++t) {
+        if (merged[t].count > 0) {
+            snap.statements.emplace_back(static_cast<QueryType>(t), merged[t]);
+        }
+    }
+    return snap;
+}
+
+void Metrics::reset() {
+    registry().forEachShard([](MetricsShard& shard) {
+        for (auto& s : shard.statements) {
+            s.count.store(0, std::memory_order_relaxed);
+            s.totalNanos.store(0, std::memory_order_relaxed);
+            s.maxNanos.store(0, std::memory_order_relaxed);
+            for (auto& bucket : s.buckets) bucket.store(0, std::memory_order_relaxed);
+        }
+        shard.rowsScanned.store(0, std::memory_order_relaxed);
+        shard.rowsReturned.store(0, std::memory_order_relaxed);
+        shard.bytesAllocated.store(0, std::memory_order_relaxed);
+    });
+}
+
+bool Metrics::dump(const std::string& path, std::string& error) {
+    std::ofstream out(path);
+    if (!out) {
+        error = "Cannot open file '" + path + "' for writing.";
+        return false;
+    }
+    out << snapshot().toJson();
+    if (!out.flush()) {
+        error = "Failed writing to '" + path + "'.";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Bucket midpoints can overshoot the largest recorded value
+std::string percentileMicros(const MetricsSnapshot::Statement& s, double p) {
+    return formatMicros(std::min(s.latency.percentile(p), s.maxNanos));
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, std::string>> MetricsSnapshot::rows() const {
+    std::vector<std::pair<std::string, std::string>> rows;
+    for (const auto& [type, s] : statements) {
+        std::string prefix = std::string(statementName(type)) + ".";
+        rows.emplace_back(prefix + "count", std::to_string(s.count));
+        rows.emplace_back(prefix + "mean_us", formatMicros(s.totalNanos / s.count));
+        rows.emplace_back(prefix + "p50_us", percentileMicros(s, 50));
+        rows.emplace_back(prefix + "p99_us", percentileMicros(s, 99));
+        rows.emplace_back(prefix + "p999_us", percentileMicros(s, 99.9));
+        rows.emplace_back(prefix + "max_us", formatMicros(s.maxNanos));
+    }
+    rows.emplace_back("rows.scanned", std::to_string(rowsScanned));
+    rows.emplace_back("rows.returned", std::to_string(rowsReturned));
+    rows.emplace_back("bytes.allocated", std::to_string(bytesAllocated));
+    return rows;
+}
+
+std::string MetricsSnapshot::toJson() const {
+    std::string json = "{\n  \"statements\": {";
+    for (size_t i = 0; i < statements.size(); ++i) {
+        const auto& [type, s] = statements[i];
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    \"%s\": {\"count\": %llu, \"total_us\": %s, \"mean_us\": %s, \"p50_us\": %s, "
+                      "\"p99_us\": %s, \"p999_us\": %s, \"max_us\": %s}",
+                      i > 0 ? "," : "", statementName(type), static_cast<unsigned long long>(s.count),
+                      formatMicros(s.totalNanos).c_str(), formatMicros(s.totalNanos / s.count).c_str(),
+                      percentileMicros(s, 50).c_str(), percentileMicros(s, 99).c_str(),
+                      percentileMicros(s, 99.9).c_str(), formatMicros(s.maxNanos).c_str());
+        json += line;
+    }
+    json += statements.empty() ? "},\n" : "\n  },\n";
+    json += "  \"rows_scanned\": " + std::to_string(rowsScanned) + ",\n";
+    json += "  \"rows_returned\": " + std::to_string(rowsReturned) + ",\n";
+    json += "  \"bytes_allocated\": " + std::to_string(bytesAllocated) + "\n}\n";
+    return json;
+}
+
+const char* statementName(QueryType type) {
+    switch (type) {
+        case QueryType::CREATE: return "create_table";
+        case QueryType::DROP: return "drop_table";
+        case QueryType::INSERT: return "insert";
+        case QueryType::UPDATE: return "update";
+        case QueryType::DELETE_Q: return "delete";
+        case QueryType::SELECT: return "select";
+        case QueryType::VACUUM: return "vacuum";
+        case QueryType::CREATE_INDEX: return "create_index";
+        case QueryType::DROP_INDEX: return "drop_index";
+        case QueryType::PREPARE: return "prepare";
+        case QueryType::EXECUTE: return "execute";
+        case QueryType::DEALLOCATE: return "deallocate";
+        case QueryType::COPY: return "copy";
+        case QueryType::EXPLAIN: return "explain";
+        case QueryType::SHOW: return "show";
+        case QueryType::BEGIN: return "begin";
+        case QueryType::COMMIT: return "commit";
+        case QueryType::ROLLBACK: return "rollback";
+    }
+    return "other";
+}
+
+} // namespace nanodb
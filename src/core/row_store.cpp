@@ -0,0 +1,68 @@
+#include "nanodb/core/row_store.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+void RowStore::addChunk() {
+    Directory* current = directory_.load(std::memory_order_relaxed);
+    if (!current || chunks_.size() == current->capacity) {
+        auto grown = std::make_unique<Directory>(current ? current->capacity * 2 : 4);
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            grown->chunks[i] = chunks_[i].get();
+        }
+        current = grown.get();
+        directoryBytes_.fetch_add(current->capacity * sizeof(Chunk*), std::memory_order_relaxed);
+        directories_.push_back(std::move(grown));
+    }
+    chunks_.push_back(std::make_unique<Chunk>());
+    current->chunks[chunks_.size() - 1] = chunks_.back().get();
+    directory_.store(current, std::memory_order_release);
+    chunkCount_.store(chunks_.size(), std::memory_order_release);
+}
+
+size_t RowStore::push_back(Row row, uint64_t begin) {
+    size_t rowId = size_.load(std::memory_order_relaxed);
+    if (rowId == capacity()) addChunk();
+    Slot& s = slot(rowId);
+    s.row = std::move(row);
+    s.version.begin.store(begin, std::memory_order_relaxed);
+    s.version.end.store(RowVersion::kLive, std::memory_order_relaxed);
+    size_.store(rowId + 1, std::memory_order_release);
+    return rowId;
+}
+
+void RowStore::reserve(size_t rows) {
+    while (capacity() < rows) addChunk();
+}
+
+void RowStore::move(size_t from, size_t to) {
+    Slot& src = slot(from);
+    Slot& dst = slot(to);
+    dst.row = std::move(src.row);
+    dst.version.begin.store(src.version.begin.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dst.version.end.store(src.version.end.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void RowStore::truncate(size_t n) {
+    size_t count = size();
+    for (size_t i = n; i < count; ++i) {
+        Row().swap(slot(i).row);
+    }
+    size_.store(std::min(n, count), std::memory_order_release);
+    // Keep the chunk being filled, free the ones past it
+    size_t keep = (n + kChunkRows - 1) / kChunkRows;
+    if (keep < chunks_.size()) {
+        chunks_.resize(keep);
+        chunkCount_.store(keep, std::memory_order_release);
+    }
+}
+
+size_t RowStore::overheadBytes() const {
+    size_t rows = size();
+    size_t slots = capacity();
+    return (slots > rows ? slots - rows : 0) * sizeof(Slot) + rows * sizeof(RowVersion) +
+           directoryBytes_.load(std::memory_order_relaxed);
+}
+
+} // namespace nanodb
@@ -0,0 +1,117 @@
+#include "nanodb/core/slow_query_log.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace nanodb {
+
+namespace {
+
+// e.g. "2026-01-31T12:00:00.123Z"
+std::string formatTimestamp(std::chrono::system_clock::time_point at) {
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(at.time_since_epoch()).count();
+    std::time_t seconds = static_cast<std::time_t>(millis / 1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char text[40];
+    size_t length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(text + length, sizeof(text) - length, ".%03dZ", static_cast<int>(millis % 1000));
+    return text;
+}
+
+// Header line, statement text, then the plan indented under it
+std::string formatEntry(const SlowQueryEntry& entry) {
+    char header[256];
+    std::snprintf(header, sizeof(header),
+                  "# %s  time=%.3f ms  rows_scanned=%llu  rows_returned=%llu  memory_bytes=%llu\n",
+                  formatTimestamp(entry.startedAt).c_str(), entry.nanos / 1e6,
+                  static_cast<unsigned long long>(entry.usage.rowsScanned),
+                  static_cast<unsigned long long>(entry.usage.rowsReturned),
+                  static_cast<unsigned long long>(entry.usage.bytesAllocated));
+    std::string text = header;
+    size_t end = entry.sql.find_last_not_of(" \t\r\n;");
+    size_t start = entry.sql.find_first_not_of(" \t\r\n");
+    if (end != std::string::npos) text += entry.sql.substr(start, end - start + 1);
+    text += ";\n";
+    for (const auto& line : entry.plan) {
+        text += "  " + line + "\n";
+    }
+    return text;
+}
+
+} // namespace
+
+SlowQueryLog::~SlowQueryLog() {
+    close();
+}
+
+bool SlowQueryLog::open(const std::string& path, double thresholdMs, std::string& error) {
+    std::lock_guard<std::mutex> control(controlMutex_);
+    stop();
+    out_.open(path, std::ios::app);
+    if (!out_) {
+        error = "Cannot open file '" + path + "' for writing.";
+        return false;
+    }
+    thresholdNanos_ = static_cast<uint64_t>(std::max(0.0, thresholdMs) * 1e6);
+    stopping_ = false;
+    dropped_ = 0;
+    writer_ = std::thread([this] { run(); });
+    enabled_ = true;
+    return true;
+}
+
+void SlowQueryLog::close() {
+    std::lock_guard<std::mutex> control(controlMutex_);
+    stop();
+}
+
+void SlowQueryLog::stop() {
+    if (!writer_.joinable()) return;
+    enabled_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+    out_.close();
+}
+
+void SlowQueryLog::record(SlowQueryEntry entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= kMaxPending) {
+            ++dropped_;
+            return;
+        }
+        pending_.push_back(std::move(entry));
+    }
+    wake_.notify_one();
+}
+
+uint64_t SlowQueryLog::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void SlowQueryLog::run() {
+    std::deque<SlowQueryEntry> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) return;  // Stopping with nothing left to write
+            batch.swap(pending_);
+        }
+        // Formatting and I/O happen outside the lock
+        for (const auto& entry : batch) {
+            out_ << formatEntry(entry);
+        }
+        out_.flush();
+        batch.clear();
+    }
+}
+
+} // namespace nanodb
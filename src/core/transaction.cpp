@@ -0,0 +1,141 @@
+#include "nanodb/core/transaction.hpp"
+#include "nanodb/core/types.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+namespace {
+
+thread_local Transaction* gRunning = nullptr;
+
+} // namespace
+
+Transaction::Transaction(TransactionManager& manager) {
+    manager.begin(*this);
+}
+
+Transaction::~Transaction() {
+    if (manager_) manager_->rollback(*this);
+}
+
+size_t Transaction::append(Table& table, Row row) {
+    track(table);
+    size_t rowId = table.rows.push_back(std::move(row), id_);
+    created_.emplace_back(&table, rowId);
+    return rowId;
+}
+
+bool Transaction::expire(Table& table, size_t rowId) {
+    // Only a live end may be claimed: any other value is a commit after our
+    // snapshot, or another transaction's id
+    uint64_t live = RowVersion::kLive;
+    if (!table.rows.version(rowId).end.compare_exchange_strong(live, id_, std::memory_order_acq_rel)) {
+        conflicted_ = true;
+        return false;
+    }
+    track(table);
+    expired_.emplace_back(&table, rowId);
+    return true;
+}
+
+void Transaction::track(Table& table) {
+    if (&table == lastTable_) return;
+    lastTable_ = &table;
+    if (std::find(tables_.begin(), tables_.end(), &table) != tables_.end()) return;
+    tables_.push_back(&table);
+    table.pendingWriters.fetch_add(1, std::memory_order_acq_rel);
+}
+
+const Transaction& Transaction::current() {
+    static const Transaction latest;
+    return gRunning ? *gRunning : latest;
+}
+
+Transaction* Transaction::running() {
+    return gRunning;
+}
+
+TransactionScope::TransactionScope(Transaction& txn) : previous_(gRunning) {
+    gRunning = &txn;
+}
+
+TransactionScope::~TransactionScope() {
+    gRunning = previous_;
+}
+
+void TransactionManager::begin(Transaction& txn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    txn.manager_ = this;
+    txn.conflicted_ = false;
+    txn.snapshot_ = lastCommitted_.load(std::memory_order_acquire);
+    txn.id_ = nextId_++;
+    ++snapshots_[txn.snapshot_];
+}
+
+void TransactionManager::commit(Transaction& txn) {
+    if (txn.hasWrites()) {
+        std::lock_guard<std::mutex> lock(commitMutex_);
+        uint64_t ts = lastCommitted_.load(std::memory_order_relaxed) + 1;
+        for (auto& [table, rowId] : txn.created_) {
+            table->rows.version(rowId).begin.store(ts, std::memory_order_release);
+            table->liveRows.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (auto& [table, rowId] : txn.expired_) {
+            table->rows.version(rowId).end.store(ts, std::memory_order_release);
+            table->liveRows.fetch_sub(1, std::memory_order_relaxed);
+            table->deadVersions.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Snapshots taken from here on see every version stamped above
+        lastCommitted_.store(ts, std::memory_order_release);
+    }
+    finish(txn);
+}
+
+void TransactionManager::rollback(Transaction& txn) {
+    // Restore ended versions first: one the transaction both created and
+    // ended must come out of this dead, not live
+    for (auto& [table, rowId] : txn.expired_) {
+        table->rows.version(rowId).end.store(RowVersion::kLive, std::memory_order_release);
+    }
+    for (auto& [table, rowId] : txn.created_) {
+        // end before begin, so no reader ever sees begin = 0 with a live end
+        RowVersion& version = table->rows.version(rowId);
+        version.end.store(0, std::memory_order_release);
+        version.begin.store(0, std::memory_order_release);
+        table->deadVersions.fetch_add(1, std::memory_order_relaxed);
+    }
+    finish(txn);
+}
+
+uint64_t TransactionManager::oldestSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (snapshots_.empty()) return lastCommitted_.load(std::memory_order_acquire);
+    return snapshots_.begin()->first;
+}
+
+size_t TransactionManager::activeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [snapshot, n] : snapshots_) count += n;
+    return count;
+}
+
+void TransactionManager::finish(Transaction& txn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = snapshots_.find(txn.snapshot_);
+        if (it != snapshots_.end() && --it->second == 0) snapshots_.erase(it);
+    }
+    // Last, since the tables may be compacted or dropped from here on
+    for (Table* table : txn.tables_) {
+        table->pendingWriters.fetch_sub(1, std::memory_order_release);
+    }
+    txn.manager_ = nullptr;
+    txn.created_.clear();
+    txn.expired_.clear();
+    txn.tables_.clear();
+    txn.lastTable_ = nullptr;
+}
+
+} // namespace nanodb
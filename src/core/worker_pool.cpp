@@ -0,0 +1,47 @@
+#include "nanodb/core/worker_pool.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+WorkerPool::WorkerPool(size_t threads)
+    : size_(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        tasks_.clear();
+    }
+    ready_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void WorkerPool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.empty()) {
+            for (size_t i = 0; i < size_; ++i) {
+                threads_.emplace_back([this] { run(); });
+            }
+        }
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void WorkerPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace nanodb
@@ -0,0 +1,264 @@
+#include "nanodb/executor/access_path.hpp"
+#include "nanodb/index/hash_index.hpp"
+#include "nanodb/index/bitmap_index.hpp"
+#include "nanodb/index/bloom_index.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+bool AccessPath::isConjunction(const WhereClause& where) {
+    for (LogicalOp op : where.logicalOps) {
+        if (op == LogicalOp::OR) return false;
+    }
+    return true;
+}
+
+const Index* AccessPath::indexedMatch(const Catalog& catalog, const Table& table,
+                                      const Condition& cond, RoaringBitmap& out) {
+    if (!cond.hasCondition) return nullptr;
+
+    // Bitmap indexes answer every comparison by testing their distinct keys
+    if (const Index* index = catalog.findIndex(table.name, cond.column, IndexType::BITMAP)) {
+        out = static_cast<const BitmapIndex*>(index)->match(cond);
+        return index;
+    }
+
+    const Index* index = catalog.findIndex(table.name, cond.column, IndexType::HASH);
+    std::vector<const Value*> keys;
+    if (cond.op == CompareOp::EQ) {
+        keys.push_back(&cond.value);
+    } else if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) keys.push_back(&v);
+    } else {
+        index = nullptr;  // Hash indexes only answer equality
+    }
+
+    // Ordered indexes answer ranges as well as equality
+    if (!index) {
+        index = catalog.findIndex(table.name, cond.column, IndexType::ORDERED);
+        if (!index) return nullptr;
+        out = static_cast<const OrderedIndex*>(index)->match(cond);
+        return index;
+    }
+    const auto* hashIndex = static_cast<const HashIndex*>(index);
+
+    out.clear();
+    for (const Value* key : keys) {
+        // col = NULL never matches, but the index would return NULL rows
+        if (isNull(*key)) continue;
+        if (const auto* rowIds = hashIndex->lookup(*key)) {
+            for (size_t rowId : *rowIds) {
+                out.add(static_cast<uint32_t>(rowId));
+            }
+        }
+    }
+    return index;
+}
+
+ScanPlan AccessPath::choose(const Catalog& catalog, const Table& table, const WhereClause& where) {
+    ScanPlan plan;
+    if (!where.hasWhere || where.conditions.empty()) return plan;
+    if (catalog.getIndexes(table.name).empty()) return plan;
+    std::shared_lock<std::shared_mutex> latch(catalog.indexLatch(table.name));
+
+    size_t count = std::min(where.conditions.size(), where.logicalOps.size() + 1);
+    std::vector<RoaringBitmap> matches(count);
+    std::vector<bool> answered(count, false);
+    bool allAnswered = true;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (const Index* index = indexedMatch(catalog, table, where.conditions[i], matches[i])) {
+            answered[i] = true;
+            plan.indexes.push_back(index);
+        } else {
+            allAnswered = false;
+        }
+    }
+
+    if (allAnswered) {
+        // Fold left to right exactly like evaluateWhereClause does
+        RoaringBitmap result = std::move(matches[0]);
+        for (size_t i = 0; i + 1 < count; ++i) {
+            if (where.logicalOps[i] == LogicalOp::AND) {
+                result = RoaringBitmap::intersect(result, matches[i + 1]);
+            } else if (where.logicalOps[i] == LogicalOp::OR) {
+                result = RoaringBitmap::unite(result, matches[i + 1]);
+            }
+        }
+        plan.fullScan = false;
+        plan.exact = true;
+        plan.rows = std::move(result);
+        return plan;
+    }
+
+    // With OR in the chain a partial answer does not bound the result
+    if (!isConjunction(where)) {
+        plan.indexes.clear();
+        return plan;
+    }
+    if (plan.indexes.empty()) {
+        pruneRowGroups(catalog, table, where, plan);
+        return plan;
+    }
+
+    bool first = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (!answered[i]) continue;
+        plan.rows = first ? std::move(matches[i]) : RoaringBitmap::intersect(plan.rows, matches[i]);
+        first = false;
+    }
+    plan.fullScan = false;
+    return plan;
+}
+
+void AccessPath::pruneRowGroups(const Catalog& catalog, const Table& table,
+                                const WhereClause& where, ScanPlan& plan) {
+    size_t groupCount = (table.rows.size() + Table::kRowGroupSize - 1) / Table::kRowGroupSize;
+
+    for (const auto& cond : where.conditions) {
+        if (!cond.hasCondition) continue;
+        if (cond.op != CompareOp::EQ && cond.op != CompareOp::IN) continue;
+        const Index* index = catalog.findIndex(table.name, cond.column, IndexType::BLOOM);
+        if (!index) continue;
+        const auto* bloom = static_cast<const BloomIndex*>(index);
+
+        std::vector<const Value*> keys;
+        if (cond.op == CompareOp::EQ) {
+            keys.push_back(&cond.value);
+        } else {
+            for (const auto& v : cond.inValues) keys.push_back(&v);
+        }
+
+        plan.skippedGroups.resize(groupCount, false);
+        for (size_t g = 0; g < groupCount; ++g) {
+            if (plan.skippedGroups[g]) continue;
+            bool possible = false;
+            for (const Value* key : keys) {
+                // NULL keys never satisfy a comparison, so they cannot keep a group alive
+                if (!isNull(*key) && bloom->mayContain(g, *key)) {
+                    possible = true;
+                    break;
+                }
+            }
+            plan.skippedGroups[g] = !possible;
+        }
+        plan.indexes.push_back(index);
+    }
+}
+
+bool AccessPath::chooseIndexOnly(const Catalog& catalog, const Table& table,
+                                 const std::vector<std::string>& columns, const WhereClause& where,
+                                 const OrderByClause* orderBy, IndexOnlyPlan& out) {
+    for (const auto& candidate : catalog.getIndexes(table.name)) {
+        if (candidate->type() != IndexType::ORDERED) continue;
+        const auto* index = static_cast<const OrderedIndex*>(candidate.get());
+
+        bool covering = true;
+        for (const auto& col : columns) {
+            if (!index->covers(col)) {
+                covering = false;
+                break;
+            }
+        }
+        if (!covering) continue;
+
+        IndexOnlyPlan plan;
+        plan.index = index;
+
+        // Tighten the key range with every comparison on the key in an AND chain
+        if (where.hasWhere && isConjunction(where)) {
+            for (const auto& cond : where.conditions) {
+                if (!cond.hasCondition || cond.column != index->column() || isNull(cond.value)) continue;
+                const Value* v = &cond.value;
+                bool lower = cond.op == CompareOp::EQ || cond.op == CompareOp::GT || cond.op == CompareOp::GE;
+                bool upper = cond.op == CompareOp::EQ || cond.op == CompareOp::LT || cond.op == CompareOp::LE;
+                bool inclusive = cond.op != CompareOp::GT && cond.op != CompareOp::LT;
+                if (lower && (!plan.range.lower || *plan.range.lower < *v ||
+                              (!(*v < *plan.range.lower) && !inclusive))) {
+                    plan.range.lower = v;
+                    plan.range.lowerInclusive = inclusive;
+                }
+                if (upper && (!plan.range.upper || *v < *plan.range.upper ||
+                              (!(*plan.range.upper < *v) && !inclusive))) {
+                    plan.range.upper = v;
+                    plan.range.upperInclusive = inclusive;
+                }
+            }
+        }
+
+        plan.ordered = orderBy && orderBy->hasOrderBy && orderBy->column == index->column();
+        if (plan.range.lower || plan.range.upper || plan.ordered) {
+            out = plan;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+const char* indexTypeName(IndexType type) {
+    switch (type) {
+        case IndexType::ORDERED: return "ORDERED";
+        case IndexType::HASH: return "HASH";
+        case IndexType::BITMAP: return "BITMAP";
+        case IndexType::BLOOM: return "BLOOM";
+    }
+    return "?";
+}
+
+std::string describeBound(const Value& v) {
+    return std::holds_alternative<int>(v) ? std::to_string(std::get<int>(v)) : "'" + std::get<std::string>(v) + "'";
+}
+
+} // namespace
+
+PlanNode AccessPath::describe(const Table& table, const ScanPlan& plan) {
+    PlanNode node;
+    if (plan.fullScan) {
+        node.name = "Seq Scan on " + table.name;
+        size_t skipped = std::count(plan.skippedGroups.begin(), plan.skippedGroups.end(), true);
+        if (skipped > 0) {
+            size_t groups = (table.rows.size() + Table::kRowGroupSize - 1) / Table::kRowGroupSize;
+            node.details.push_back("Row groups skipped by Bloom filter: " + std::to_string(skipped) +
+                                   " of " + std::to_string(groups));
+        }
+        return node;
+    }
+
+    node.name = "Bitmap Index Scan on " + table.name;
+    // An OR over one column lists its index once per predicate
+    std::string indexes;
+    for (size_t i = 0; i < plan.indexes.size(); ++i) {
+        const Index* index = plan.indexes[i];
+        if (std::find(plan.indexes.begin(), plan.indexes.begin() + i, index) != plan.indexes.begin() + i) {
+            continue;
+        }
+        if (!indexes.empty()) indexes += ", ";
+        indexes += index->name() + " (" + indexTypeName(index->type()) + ")";
+    }
+    node.details.push_back("Indexes: " + indexes);
+    node.details.push_back("Candidates: " + std::to_string(plan.rows.cardinality()) +
+                           (plan.exact ? " (exact)" : " (rechecked)"));
+    return node;
+}
+
+PlanNode AccessPath::describe(const Table& table, const IndexOnlyPlan& plan) {
+    PlanNode node;
+    node.name = "Index Only Scan on " + table.name + " using " + plan.index->name();
+    const std::string& key = plan.index->column();
+    std::string range;
+    if (plan.range.lower) {
+        range = key + (plan.range.lowerInclusive ? " >= " : " > ") + describeBound(*plan.range.lower);
+    }
+    if (plan.range.upper) {
+        if (!range.empty()) range += " AND ";
+        range += key + (plan.range.upperInclusive ? " <= " : " < ") + describeBound(*plan.range.upper);
+    }
+    if (!range.empty()) node.details.push_back("Range: " + range);
+    if (plan.ordered) node.details.push_back("Order: index order on " + key);
+    return node;
+}
+
+} // namespace nanodb
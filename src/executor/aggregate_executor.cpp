@@ -1,12 +1,221 @@
 #include "nanodb/executor/aggregate_executor.hpp"
+#include "nanodb/core/cancellation.hpp"
+#include "nanodb/core/memory.hpp"
+#include "nanodb/core/metrics.hpp"
+#include "nanodb/executor/spill_file.hpp"
 
-#include <iostream>
-#include <iomanip>
+#include <algorithm>
+#include <cstdio>
 #include <map>
-#include <type_traits>
+#include <memory>
 
 namespace nanodb {
 
+namespace {
+
+// Result column name: the alias if given, else e.g. "SUM(price)"
+std::string aggregateName(const AggregateExpr& agg) {
+    if (!agg.alias.empty()) return agg.alias;
+    switch (agg.func) {
+        case AggregateFunc::COUNT_STAR: return "COUNT(*)";
+        case AggregateFunc::COUNT: return "COUNT(" + agg.column + ")";
+        case AggregateFunc::SUM: return "SUM(" + agg.column + ")";
+        case AggregateFunc::AVG: return "AVG(" + agg.column + ")";
+        case AggregateFunc::MIN: return "MIN(" + agg.column + ")";
+        case AggregateFunc::MAX: return "MAX(" + agg.column + ")";
+        default: return "?(" + agg.column + ")";
+    }
+}
+
+bool havingHolds(const HavingClause& having, int aggValue) {
+    switch (having.op) {
+        case CompareOp::EQ: return aggValue == having.value;
+        case CompareOp::NE: return aggValue != having.value;
+        case CompareOp::LT: return aggValue < having.value;
+        case CompareOp::LE: return aggValue <= having.value;
+        case CompareOp::GT: return aggValue > having.value;
+        case CompareOp::GE: return aggValue >= having.value;
+        case CompareOp::IN: break;
+    }
+    return true;
+}
+
+// An aggregate's input within a spilled row: its function and the slot of
+// its column, or -1 if it reads no value (COUNT)
+struct SpilledInput {
+    AggregateFunc func;
+    int slot;
+};
+
+// Running state of one aggregate over a group. Gives the same result as
+// computeAggregate over all of the group's rows at once.
+struct Accumulator {
+    int result = 0;
+    int count = 0;      // INT values seen
+    int rows = 0;
+
+    void add(AggregateFunc func, const Value& v) {
+        ++rows;
+        if (!std::holds_alternative<int>(v)) return;
+        int val = std::get<int>(v);
+        switch (func) {
+            case AggregateFunc::SUM:
+            case AggregateFunc::AVG:
+                result += val;
+                ++count;
+                break;
+            case AggregateFunc::MIN:
+                if (count == 0 || val < result) result = val;
+                ++count;
+                break;
+            case AggregateFunc::MAX:
+                if (count == 0 || val > result) result = val;
+                ++count;
+                break;
+            default:
+                break;
+        }
+    }
+
+    int value(AggregateFunc func) const {
+        if (func == AggregateFunc::COUNT_STAR || func == AggregateFunc::COUNT) return rows;
+        if (func == AggregateFunc::AVG && count > 0) return result / count;
+        return result;
+    }
+};
+
+// Aggregates spilled partitions one at a time. A partition whose groups
+// still do not fit is split again at the next level. Each partition's
+// result rows are written out sorted by key as a run, and merge() combines
+// the runs so the output order matches the in-memory path.
+class PartitionedGroupBy {
+public:
+    PartitionedGroupBy(size_t keyCount, std::vector<SpilledInput> inputs, const HavingClause& having,
+                       SpillStats& spill)
+        : keyCount_(keyCount), inputs_(std::move(inputs)), having_(having), spill_(spill) {}
+
+    bool aggregate(SpillFile& file, size_t level, std::string& error) {
+        std::map<std::vector<Value>, std::vector<Accumulator>> groups;
+        MemoryReservation memory;
+        size_t bytes = 0;
+        bool fits = true;
+        const Value null = NullValue{};
+        Row row;
+        while (fits && file.read(row)) {
+            auto [it, inserted] = groups.try_emplace(std::vector<Value>(row.begin(), row.begin() + keyCount_));
+            if (inserted) {
+                it->second.resize(inputs_.size());
+                bytes += approxRowBytes(it->first) + kTreeNodeBytes + sizeof(it->second) +
+                         inputs_.size() * sizeof(Accumulator);
+                fits = memory.fits(bytes);
+                peakBytes_ = std::max(peakBytes_, bytes);
+            }
+            for (size_t i = 0; i < inputs_.size(); ++i) {
+                it->second[i].add(inputs_[i].func, inputs_[i].slot < 0 ? null : row[inputs_[i].slot]);
+            }
+        }
+        if (!file.ok()) {
+            error = "Cannot read spill file.";
+            return false;
+        }
+        if (!fits) {
+            groups.clear();
+            memory.reset();
+            return split(file, level, error);
+        }
+
+        auto run = std::make_unique<SpillFile>();
+        if (!run->open(error)) return false;
+        size_t aggregates = inputs_.size() - (having_.hasHaving ? 1 : 0);
+        Row result;
+        for (const auto& [key, accumulators] : groups) {
+            if (having_.hasHaving && !havingHolds(having_, accumulators.back().value(having_.func))) continue;
+            result.assign(key.begin(), key.end());
+            for (size_t i = 0; i < aggregates; ++i) {
+                result.push_back(accumulators[i].value(inputs_[i].func));
+            }
+            run->write(result);
+        }
+        groups_ += groups.size();
+        if (!run->finish(error)) return false;
+        runs_.push_back(std::move(run));
+        return true;
+    }
+
+    // k-way merge of the sorted runs into sink
+    bool merge(RowSink& sink, const std::vector<size_t>& projection, std::string& error) {
+        struct Head {
+            Row row;
+            size_t run;
+        };
+        const size_t keyCount = keyCount_;
+        auto later = [keyCount](const Head& a, const Head& b) {
+            return std::lexicographical_compare(b.row.begin(), b.row.begin() + keyCount,
+                                                a.row.begin(), a.row.begin() + keyCount);
+        };
+        std::vector<Head> heap;
+        for (size_t r = 0; r < runs_.size(); ++r) {
+            Head head{{}, r};
+            if (runs_[r]->read(head.row)) heap.push_back(std::move(head));
+        }
+        std::make_heap(heap.begin(), heap.end(), later);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            Head& head = heap.back();
+            ++emitted_;
+            if (!sink.row(head.row, projection)) return true;
+            if (runs_[head.run]->read(head.row)) {
+                std::push_heap(heap.begin(), heap.end(), later);
+            } else {
+                if (!runs_[head.run]->ok()) {
+                    error = "Cannot read spill file.";
+                    return false;
+                }
+                heap.pop_back();
+            }
+        }
+        return true;
+    }
+
+    size_t groups() const { return groups_; }
+    size_t emitted() const { return emitted_; }
+    // Largest group map held at once
+    size_t peakBytes() const { return peakBytes_; }
+
+private:
+    bool split(SpillFile& file, size_t level, std::string& error) {
+        if (level + 1 >= SpillPartitions::kMaxLevel) {
+            error = memoryLimitError();
+            return false;
+        }
+        std::vector<size_t> keyColumns(keyCount_);
+        for (size_t i = 0; i < keyCount_; ++i) keyColumns[i] = i;
+        SpillPartitions partitions;
+        if (!partitions.open(level + 1, error) || !file.finish(error)) return false;
+        Row row;
+        while (file.read(row)) {
+            partitions.add(row, keyColumns);
+        }
+        if (!partitions.finish(error)) return false;
+        spill_.add(partitions);
+        for (size_t i = 0; i < SpillPartitions::kFanout && !CancellationToken::stopRequested(); ++i) {
+            if (partitions[i].rows() > 0 && !aggregate(partitions[i], level + 1, error)) return false;
+        }
+        return true;
+    }
+
+    size_t keyCount_;
+    std::vector<SpilledInput> inputs_;
+    const HavingClause& having_;
+    SpillStats& spill_;
+    std::vector<std::unique_ptr<SpillFile>> runs_;
+    size_t groups_ = 0;
+    size_t emitted_ = 0;
+    size_t peakBytes_ = 0;
+};
+
+} // namespace
+
 AggregateExecutor::AggregateExecutor(Catalog& catalog) : catalog_(catalog) {}
 
 int AggregateExecutor::findColumnIndex(const Table& table, const std::string& colName) const {
@@ -27,6 +236,13 @@ bool AggregateExecutor::evaluateSingleCondition(const Row& row, const Table& tab
     const Value& rowVal = row[colIdx];
     const Value& condVal = cond.value;
 
+    if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) {
+            if (!isNull(v) && rowVal == v) return true;
+        }
+        return false;
+    }
+
     if (std::holds_alternative<int>(rowVal) && std::holds_alternative<int>(condVal)) {
         int rv = std::get<int>(rowVal);
         int cv = std::get<int>(condVal);
@@ -37,6 +253,7 @@ bool AggregateExecutor::evaluateSingleCondition(const Row& row, const Table& tab
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     } else if (std::holds_alternative<std::string>(rowVal) && std::holds_alternative<std::string>(condVal)) {
         const std::string& rv = std::get<std::string>(rowVal);
@@ -48,6 +265,7 @@ bool AggregateExecutor::evaluateSingleCondition(const Row& row, const Table& tab
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     }
 
@@ -119,70 +337,165 @@ bool AggregateExecutor::evaluateHaving(const HavingClause& having,
                                         const std::vector<const Row*>& groupRows, const Table& table) const {
     if (!having.hasHaving) return true;
 
-    int aggValue = computeAggregate(having.func, having.column, groupRows, table);
-
-    switch (having.op) {
-        case CompareOp::EQ: return aggValue == having.value;
-        case CompareOp::NE: return aggValue != having.value;
-        case CompareOp::LT: return aggValue < having.value;
-        case CompareOp::LE: return aggValue <= having.value;
-        case CompareOp::GT: return aggValue > having.value;
-        case CompareOp::GE: return aggValue >= having.value;
-    }
-    return true;
+    return havingHolds(having, computeAggregate(having.func, having.column, groupRows, table));
 }
 
-void AggregateExecutor::execute(const SelectQuery& query) {
+bool AggregateExecutor::execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan) {
+    Stopwatch clock;
     const Table* table = catalog_.getTable(query.tableName);
     if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
-        return;
+        sink.error("Table '" + query.tableName + "' does not exist.");
+        return false;
     }
 
-    // Collect matching rows
-    std::vector<const Row*> matchingRows;
-    for (const auto& row : table->rows) {
-        if (evaluateWhereClause(row, *table, query.where)) {
-            matchingRows.push_back(&row);
+    for (const auto& agg : query.aggregates) {
+        if (agg.func != AggregateFunc::COUNT_STAR && findColumnIndex(*table, agg.column) < 0) {
+            sink.error("Column '" + agg.column + "' not found.");
+            return false;
         }
     }
 
-    // Process each aggregate
+    // MIN/MAX of an ordered index key with no WHERE: read the ends of the index
+    auto keyIndex = [&](const AggregateExpr& agg) -> const OrderedIndex* {
+        if (query.where.hasWhere) return nullptr;
+        if (agg.func != AggregateFunc::MIN && agg.func != AggregateFunc::MAX) return nullptr;
+        return static_cast<const OrderedIndex*>(
+            catalog_.findIndex(table->name, agg.column, IndexType::ORDERED));
+    };
+
+    // COUNT needs no row data: answer it from the row count or the index bitmaps
+    bool needRows = false;
+    std::vector<std::string> referenced;
     for (const auto& agg : query.aggregates) {
-        if (agg.func == AggregateFunc::COUNT_STAR) {
-            std::cout << "COUNT(*)\n";
-            std::cout << "--------\n";
-            std::cout << matchingRows.size() << "\n";
-        } else if (agg.func == AggregateFunc::COUNT) {
-            int colIdx = findColumnIndex(*table, agg.column);
-            if (colIdx < 0) {
-                std::cout << "Error: Column '" << agg.column << "' not found.\n";
-                return;
+        if (agg.func != AggregateFunc::COUNT_STAR && agg.func != AggregateFunc::COUNT && !keyIndex(agg)) {
+            needRows = true;
+        }
+        if (!agg.column.empty()) referenced.push_back(agg.column);
+    }
+    for (const auto& cond : query.where.conditions) {
+        referenced.push_back(cond.column);
+    }
+
+    ScanPlan scanPlan = AccessPath::choose(catalog_, *table, query.where);
+
+    // How matching rows are found: counted without reading them, or
+    // collected from an index-only scan or a table scan
+    enum class Strategy { ROW_COUNT, BITMAP_COUNT, INDEX_ONLY, SCAN };
+    Strategy strategy = Strategy::SCAN;
+    IndexOnlyPlan indexOnly;
+    if (!needRows && !query.where.hasWhere) {
+        strategy = Strategy::ROW_COUNT;
+    } else if (!needRows && scanPlan.exact) {
+        strategy = Strategy::BITMAP_COUNT;
+    } else if (AccessPath::chooseIndexOnly(catalog_, *table, referenced, query.where, nullptr, indexOnly)) {
+        strategy = Strategy::INDEX_ONLY;
+    }
+
+    // Collect matching rows. schema describes their layout: the table itself,
+    // or the covered columns of an index for an index-only scan.
+    const Table* schema = table;
+    std::vector<const Row*> matchingRows;
+    size_t matchCount = 0;
+    size_t scanned = 0;
+    double scanMs = 0;
+
+    auto describe = [&]() {
+        PlanNode node;
+        node.name = "Aggregate";
+        std::string functions;
+        for (const auto& agg : query.aggregates) {
+            if (!functions.empty()) functions += ", ";
+            functions += aggregateName(agg);
+            if (keyIndex(agg)) functions += " via index endpoint";
+        }
+        node.details.push_back("Functions: " + functions);
+        node.rowsIn = matchCount;
+        node.rowsOut = 1;
+        node.millis = clock.elapsedMs();
+        node.memoryBytes = matchingRows.capacity() * sizeof(const Row*);
+        if (strategy == Strategy::ROW_COUNT) {
+            node.details.push_back("Input: table row count, no rows read");
+        } else {
+            PlanNode scan = strategy == Strategy::INDEX_ONLY ? AccessPath::describe(*table, indexOnly)
+                                                             : AccessPath::describe(*table, scanPlan);
+            if (strategy == Strategy::BITMAP_COUNT) {
+                node.details.push_back("Count: index bitmap cardinality");
+            } else if (query.where.hasWhere) {
+                scan.details.push_back("Filter: " + describeWhere(query.where));
             }
-            std::cout << "COUNT(" << agg.column << ")\n";
-            std::cout << std::string(15, '-') << "\n";
-            std::cout << matchingRows.size() << "\n";
-        } else if (agg.func == AggregateFunc::SUM) {
-            int colIdx = findColumnIndex(*table, agg.column);
-            if (colIdx < 0) {
-                std::cout << "Error: Column '" << agg.column << "' not found.\n";
-                return;
+            scan.rowsIn = scanned;
+            scan.rowsOut = matchCount;
+            scan.millis = scanMs;
+            node.children.push_back(std::move(scan));
+        }
+        plan->root = std::move(node);
+    };
+    if (plan && !plan->analyze) {
+        describe();
+        return true;
+    }
+
+    // The collected row pointers are charged against the memory limit
+    MemoryReservation memory;
+    auto collect = [&](const Row& row) {
+        matchingRows.push_back(&row);
+        return memory.fits(matchingRows.capacity() * sizeof(const Row*));
+    };
+    bool overLimit = false;
+    if (strategy == Strategy::ROW_COUNT) {
+        matchCount = table->visibleRowCount();
+    } else if (strategy == Strategy::BITMAP_COUNT) {
+        // The bitmap also holds versions this snapshot cannot see
+        scanPlan.forEachRow(*table, [&](size_t) { ++matchCount; });
+    } else if (strategy == Strategy::INDEX_ONLY) {
+        schema = &indexOnly.index->schema();
+        std::shared_lock<std::shared_mutex> latch(catalog_.indexLatch(table->name));
+        indexOnly.index->scan(indexOnly.range, false, [&](const Row& covered, size_t rowId) {
+            if (table->isDeleted(rowId)) return true;
+            ++scanned;
+            if (evaluateWhereClause(covered, *schema, query.where)) {
+                overLimit = !collect(covered);
             }
+            return !overLimit;
+        });
+        matchCount = matchingRows.size();
+    } else {
+        scanPlan.forEachRow(*table, [&](size_t rowId) {
+            ++scanned;
+            const Row& row = table->rows[rowId];
+            if (evaluateWhereClause(row, *table, query.where)) {
+                overLimit = !collect(row);
+            }
+            return !overLimit;
+        });
+        matchCount = matchingRows.size();
+    }
+    scanMs = clock.elapsedMs();
+    if (overLimit) {
+        sink.error(memoryLimitError());
+        return false;
+    }
+
+    // One result row, one column per aggregate. AVG is reported as text
+    // with two decimals since values are integers or strings.
+    std::vector<Column> columns;
+    Row result;
+    for (const auto& agg : query.aggregates) {
+        if (agg.func == AggregateFunc::COUNT_STAR || agg.func == AggregateFunc::COUNT) {
+            columns.push_back({aggregateName(agg), ColumnType::INT});
+            result.push_back(static_cast<int>(matchCount));
+        } else if (agg.func == AggregateFunc::SUM) {
+            int colIdx = findColumnIndex(*schema, agg.column);
             int sum = 0;
             for (const auto* row : matchingRows) {
                 if (std::holds_alternative<int>((*row)[colIdx])) {
                     sum += std::get<int>((*row)[colIdx]);
                 }
             }
-            std::cout << "SUM(" << agg.column << ")\n";
-            std::cout << std::string(15, '-') << "\n";
-            std::cout << sum << "\n";
+            columns.push_back({aggregateName(agg), ColumnType::INT});
+            result.push_back(sum);
         } else if (agg.func == AggregateFunc::AVG) {
-            int colIdx = findColumnIndex(*table, agg.column);
-            if (colIdx < 0) {
-                std::cout << "Error: Column '" << agg.column << "' not found.\n";
-                return;
-            }
+            int colIdx = findColumnIndex(*schema, agg.column);
             double sum = 0;
             size_t count = 0;
             for (const auto* row : matchingRows) {
@@ -192,19 +505,44 @@ void AggregateExecutor::execute(const SelectQuery& query) {
                 }
             }
             double avg = count > 0 ? sum / count : 0;
-            std::cout << "AVG(" << agg.column << ")\n";
-            std::cout << std::string(15, '-') << "\n";
-            std::cout << std::fixed << std::setprecision(2) << avg << "\n";
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.2f", avg);
+            columns.push_back({aggregateName(agg), ColumnType::STRING});
+            result.push_back(std::string(text));
+        } else if (agg.func == AggregateFunc::MIN || agg.func == AggregateFunc::MAX) {
+            int val = 0;
+            if (const OrderedIndex* index = keyIndex(agg)) {
+                std::shared_lock<std::shared_mutex> latch(catalog_.indexLatch(table->name));
+                if (agg.func == AggregateFunc::MIN) {
+                    index->minInt(*table, val);
+                } else {
+                    index->maxInt(*table, val);
+                }
+            } else {
+                val = computeAggregate(agg.func, agg.column, matchingRows, *schema);
+            }
+            columns.push_back({aggregateName(agg), ColumnType::INT});
+            result.push_back(val);
         }
     }
-    std::cout << "1 row(s) returned.\n";
+
+    std::vector<size_t> projection(result.size());
+    for (size_t i = 0; i < projection.size(); ++i) projection[i] = i;
+    sink.begin(columns, false);
+    sink.row(result, projection);
+    sink.end();
+    Metrics::addRows(scanned, 1);
+    Metrics::addBytes(matchingRows.capacity() * sizeof(const Row*));
+    if (plan) describe();
+    return true;
 }
 
-void AggregateExecutor::executeWithGroupBy(const SelectQuery& query) {
+bool AggregateExecutor::executeWithGroupBy(const SelectQuery& query, RowSink& sink, QueryPlan* plan) {
+    Stopwatch clock;
     const Table* table = catalog_.getTable(query.tableName);
     if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
-        return;
+        sink.error("Table '" + query.tableName + "' does not exist.");
+        return false;
     }
 
     // Get column indices for GROUP BY columns
@@ -212,100 +550,213 @@ void AggregateExecutor::executeWithGroupBy(const SelectQuery& query) {
     for (const auto& col : query.groupBy.columns) {
         int idx = findColumnIndex(*table, col);
         if (idx < 0) {
-            std::cout << "Error: Column '" << col << "' not found.\n";
-            return;
+            sink.error("Column '" + col + "' not found.");
+            return false;
         }
         groupColIndices.push_back(idx);
     }
 
-    // Collect matching rows (apply WHERE)
+    ScanPlan scanPlan = AccessPath::choose(catalog_, *table, query.where);
+
+    // Operator counters for EXPLAIN ANALYZE
+    size_t scanned = 0;
+    size_t groupCount = 0;
+    size_t emitted = 0;
+    size_t groupBytes = 0;
+    size_t matched = 0;
+    double scanMs = 0;
     std::vector<const Row*> matchingRows;
-    for (const auto& row : table->rows) {
+    SpilledGroupStats stats;
+
+    auto describe = [&]() {
+        PlanNode node;
+        node.name = "Group Aggregate";
+        std::string key;
+        for (const auto& col : query.groupBy.columns) {
+            if (!key.empty()) key += ", ";
+            key += col;
+        }
+        node.details.push_back("Group key: " + key + " (ordered map)");
+        std::string functions;
+        for (const auto& agg : query.aggregates) {
+            if (!functions.empty()) functions += ", ";
+            functions += aggregateName(agg);
+        }
+        if (!functions.empty()) node.details.push_back("Functions: " + functions);
+        if (query.having.hasHaving) {
+            AggregateExpr having{query.having.func, query.having.column, ""};
+            WhereClause condition;
+            condition.conditions.push_back({aggregateName(having), query.having.op, query.having.value, {}, true});
+            node.details.push_back("Having: " + describeWhere(condition));
+        }
+        node.rowsIn = matched;
+        node.rowsOut = emitted;
+        node.millis = clock.elapsedMs();
+        node.memoryBytes = matchingRows.capacity() * sizeof(const Row*) + groupBytes + stats.peakBytes;
+        if (plan->analyze) node.details.push_back("Groups: " + std::to_string(groupCount));
+        if (stats.spill.partitions > 0) node.details.push_back(stats.spill.describe());
+
+        PlanNode scan = AccessPath::describe(*table, scanPlan);
+        if (query.where.hasWhere) scan.details.push_back("Filter: " + describeWhere(query.where));
+        scan.rowsIn = scanned;
+        scan.rowsOut = matched;
+        scan.millis = scanMs;
+        node.children.push_back(std::move(scan));
+        plan->root = std::move(node);
+    };
+    if (plan && !plan->analyze) {
+        describe();
+        return true;
+    }
+
+    // Output columns: the group key, then one per aggregate
+    std::vector<Column> columns;
+    for (int idx : groupColIndices) {
+        columns.push_back({table->columns[idx].name, table->columns[idx].type});
+    }
+    for (const auto& agg : query.aggregates) {
+        columns.push_back({aggregateName(agg), ColumnType::INT});
+    }
+    std::vector<size_t> projection(columns.size());
+    for (size_t i = 0; i < projection.size(); ++i) projection[i] = i;
+
+    // Matching rows and the group map are charged against the memory limit
+    MemoryReservation memory;
+    bool overLimit = false;
+
+    // Collect matching rows (apply WHERE)
+    scanPlan.forEachRow(*table, [&](size_t rowId) {
+        ++scanned;
+        const Row& row = table->rows[rowId];
         if (evaluateWhereClause(row, *table, query.where)) {
             matchingRows.push_back(&row);
+            overLimit = !memory.fits(matchingRows.capacity() * sizeof(const Row*));
         }
-    }
+        return !overLimit;
+    });
+    scanMs = clock.elapsedMs();
 
-    // Group rows by key
+    // Group rows by key. Each group's pointer list is counted at one
+    // pointer per row as it grows; the exact capacities are summed after.
     std::map<std::vector<Value>, std::vector<const Row*>> groups;
+    const size_t rowBytes = matchingRows.capacity() * sizeof(const Row*);
+    size_t estimate = 0;
     for (const auto* row : matchingRows) {
+        if (overLimit) break;
         std::vector<Value> key;
         for (int idx : groupColIndices) {
             key.push_back((*row)[idx]);
         }
-        groups[key].push_back(row);
+        auto [it, inserted] = groups.try_emplace(std::move(key));
+        if (inserted) estimate += approxRowBytes(it->first) + kTreeNodeBytes + sizeof(it->second);
+        it->second.push_back(row);
+        estimate += sizeof(const Row*);
+        overLimit = !memory.fits(rowBytes + estimate);
     }
 
-    // Apply HAVING and collect results
-    std::vector<std::pair<std::vector<Value>, std::vector<const Row*>>> filteredGroups;
-    for (auto& [key, groupRows] : groups) {
-        if (evaluateHaving(query.having, groupRows, *table)) {
-            filteredGroups.push_back({key, std::move(groupRows)});
+    if (overLimit) {
+        // Too big to group in memory: start over, partitioning the input
+        // by group key on disk and aggregating one partition at a time
+        groups.clear();
+        std::vector<const Row*>().swap(matchingRows);
+        memory.reset();
+        scanned = 0;
+        std::string error;
+        if (!executeGroupBySpilled(query, *table, scanPlan, groupColIndices, columns, sink, stats, error)) {
+            sink.error(error);
+            return false;
+        }
+        scanned = stats.scanned;
+        matched = stats.matched;
+        groupCount = stats.groups;
+        emitted = stats.emitted;
+        scanMs = stats.scanMs;
+    } else {
+        matched = matchingRows.size();
+        groupCount = groups.size();
+        for (const auto& [key, groupRows] : groups) {
+            groupBytes += approxRowBytes(key) + kTreeNodeBytes + sizeof(groupRows) +
+                          groupRows.capacity() * sizeof(const Row*);
         }
-    }
 
-    // Determine output columns
-    std::vector<std::string> outputHeaders;
-    for (const auto& col : query.groupBy.columns) {
-        outputHeaders.push_back(col);
-    }
-    for (const auto& agg : query.aggregates) {
-        if (agg.func == AggregateFunc::COUNT_STAR) {
-            outputHeaders.push_back("COUNT(*)");
-        } else {
-            std::string funcName;
-            switch (agg.func) {
-                case AggregateFunc::COUNT: funcName = "COUNT"; break;
-                case AggregateFunc::SUM: funcName = "SUM"; break;
-                case AggregateFunc::AVG: funcName = "AVG"; break;
-                case AggregateFunc::MIN: funcName = "MIN"; break;
-                case AggregateFunc::MAX: funcName = "MAX"; break;
-                default: funcName = "?"; break;
+        // Apply HAVING and collect results
+        std::vector<std::pair<std::vector<Value>, std::vector<const Row*>>> filteredGroups;
+        for (auto& [key, groupRows] : groups) {
+            if (evaluateHaving(query.having, groupRows, *table)) {
+                filteredGroups.push_back({key, std::move(groupRows)});
             }
-            outputHeaders.push_back(funcName + "(" + agg.column + ")");
         }
-    }
 
-    // Print header
-    for (size_t i = 0; i < outputHeaders.size(); ++i) {
-        std::cout << std::setw(15) << outputHeaders[i];
-        if (i < outputHeaders.size() - 1) std::cout << " | ";
+        sink.begin(columns, false);
+        Row result;
+        for (const auto& [key, groupRows] : filteredGroups) {
+            result.assign(key.begin(), key.end());
+            for (const auto& agg : query.aggregates) {
+                result.push_back(computeAggregate(agg.func, agg.column, groupRows, *table));
+            }
+            ++emitted;
+            if (!sink.row(result, projection)) break;
+        }
     }
-    std::cout << "\n";
+    sink.end();
+    Metrics::addRows(scanned, emitted);
+    Metrics::addBytes(matchingRows.capacity() * sizeof(const Row*) + groupBytes + stats.peakBytes);
+    if (plan) describe();
+    return true;
+}
 
-    // Print separator
-    for (size_t i = 0; i < outputHeaders.size(); ++i) {
-        std::cout << std::string(15, '-');
-        if (i < outputHeaders.size() - 1) std::cout << "-+-";
-    }
-    std::cout << "\n";
-
-    // Print rows
-    size_t rowCount = 0;
-    for (const auto& [key, groupRows] : filteredGroups) {
-        for (size_t i = 0; i < key.size(); ++i) {
-            std::visit([](const auto& val) {
-                using T = std::decay_t<decltype(val)>;
-                if constexpr (std::is_same_v<T, NullValue>) {
-                    std::cout << std::setw(15) << "NULL";
-                } else {
-                    std::cout << std::setw(15) << val;
-                }
-            }, key[i]);
-            if (i < key.size() - 1 || !query.aggregates.empty()) std::cout << " | ";
+bool AggregateExecutor::executeGroupBySpilled(const SelectQuery& query, const Table& table,
+                                              const ScanPlan& scanPlan, const std::vector<int>& groupColIndices,
+                                              const std::vector<Column>& columns, RowSink& sink,
+                                              SpilledGroupStats& stats, std::string& error) {
+    Stopwatch clock;
+    // Spilled rows hold the group key, then the input column of each
+    // aggregate (and of HAVING) that reads one
+    std::vector<size_t> spillColumns(groupColIndices.begin(), groupColIndices.end());
+    std::vector<SpilledInput> inputs;
+    auto addInput = [&](AggregateFunc func, const std::string& column) {
+        int colIdx = -1;
+        if (func != AggregateFunc::COUNT_STAR && func != AggregateFunc::COUNT) {
+            colIdx = findColumnIndex(table, column);
         }
-
-        for (size_t i = 0; i < query.aggregates.size(); ++i) {
-            const auto& agg = query.aggregates[i];
-            int val = computeAggregate(agg.func, agg.column, groupRows, *table);
-            std::cout << std::setw(15) << val;
-            if (i < query.aggregates.size() - 1) std::cout << " | ";
+        if (colIdx < 0) {
+            inputs.push_back({func, -1});
+        } else {
+            inputs.push_back({func, static_cast<int>(spillColumns.size())});
+            spillColumns.push_back(static_cast<size_t>(colIdx));
+        }
+    };
+    for (const auto& agg : query.aggregates) addInput(agg.func, agg.column);
+    if (query.having.hasHaving) addInput(query.having.func, query.having.column);
+
+    std::vector<size_t> keyColumns(groupColIndices.begin(), groupColIndices.end());
+    SpillPartitions partitions;
+    if (!partitions.open(0, error)) return false;
+    scanPlan.forEachRow(table, [&](size_t rowId) {
+        ++stats.scanned;
+        const Row& row = table.rows[rowId];
+        if (evaluateWhereClause(row, table, query.where)) {
+            ++stats.matched;
+            partitions.add(row, keyColumns, spillColumns);
         }
-        std::cout << "\n";
-        ++rowCount;
+    });
+    if (!partitions.finish(error)) return false;
+    stats.spill.add(partitions);
+    stats.scanMs = clock.elapsedMs();
+
+    PartitionedGroupBy grouper(groupColIndices.size(), std::move(inputs), query.having, stats.spill);
+    // A cancelled query stops between partitions
+    for (size_t i = 0; i < SpillPartitions::kFanout && !CancellationToken::stopRequested(); ++i) {
+        if (partitions[i].rows() > 0 && !grouper.aggregate(partitions[i], 0, error)) return false;
     }
-
-    std::cout << rowCount << " row(s) returned.\n";
+    std::vector<size_t> projection(columns.size());
+    for (size_t i = 0; i < projection.size(); ++i) projection[i] = i;
+    sink.begin(columns, false);
+    bool ok = grouper.merge(sink, projection, error);
+    stats.groups = grouper.groups();
+    stats.emitted = grouper.emitted();
+    stats.peakBytes = grouper.peakBytes();
+    return ok;
 }
 
 } // namespace nanodb
@@ -0,0 +1,88 @@
+#include "nanodb/executor/buffered_writer.hpp"
+
+#include <cerrno>
+#include <charconv>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace nanodb {
+
+BufferedWriter::BufferedWriter(size_t capacity) : buffer_(capacity) {}
+
+BufferedWriter::~BufferedWriter() {
+    close();
+}
+
+bool BufferedWriter::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ownsFd_ = true;
+    ok_ = fd_ >= 0;
+    return ok_;
+}
+
+void BufferedWriter::attach(int fd) {
+    close();
+    fd_ = fd;
+    ownsFd_ = false;
+    ok_ = true;
+}
+
+bool BufferedWriter::close() {
+    if (fd_ < 0) return ok_;
+    flush();
+    if (ownsFd_ && ::close(fd_) != 0) ok_ = false;
+    fd_ = -1;
+    return ok_;
+}
+
+void BufferedWriter::writeInt(int64_t value) {
+    char digits[24];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    (void)ec;
+    write(std::string_view(digits, static_cast<size_t>(end - digits)));
+}
+
+void BufferedWriter::writeU32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    write(std::string_view(bytes, sizeof(bytes)));
+}
+
+bool BufferedWriter::flush() {
+    if (length_ > 0) {
+        if (!writeAll(buffer_.data(), length_)) ok_ = false;
+        length_ = 0;
+    }
+    return ok_;
+}
+
+void BufferedWriter::writeSlow(std::string_view s) {
+    flush();
+    if (s.size() >= buffer_.size()) {
+        // Larger than the buffer: skip the copy
+        if (!writeAll(s.data(), s.size())) ok_ = false;
+        return;
+    }
+    s.copy(buffer_.data(), s.size());
+    length_ = s.size();
+}
+
+bool BufferedWriter::writeAll(const char* data, size_t size) {
+    if (fd_ < 0) return false;
+    while (size > 0) {
+        ssize_t n = ::write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace nanodb
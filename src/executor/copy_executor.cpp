@@ -0,0 +1,493 @@
+#include "nanodb/executor/copy_executor.hpp"
+#include "nanodb/executor/result_printer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nanodb {
+
+namespace {
+
+// Read-only private mapping of a whole file; empty files map to nothing
+class MappedFile {
+public:
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool open(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) return false;
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) return true;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) return false;
+        madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(p);
+        return true;
+    }
+
+    std::string_view view() const { return std::string_view(data_ ? data_ : "", size_); }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// One slice of the input, parsed independently of the others
+struct Chunk {
+    std::string_view text;
+    std::vector<Row> rows;
+    size_t lines = 0;           // Lines consumed, for global line numbers
+    std::string error;          // Set on the first bad line
+    size_t errorLine = 0;       // 1-based, relative to the chunk
+};
+
+// Splits text into at most n pieces that start right after a newline
+std::vector<std::string_view> splitAtLines(std::string_view text, size_t n) {
+    std::vector<std::string_view> pieces;
+    size_t start = 0;
+    for (size_t i = 1; i <= n && start < text.size(); ++i) {
+        size_t end = text.size();
+        if (i < n) {
+            size_t target = text.size() / n * i;
+            if (target < start) target = start;
+            size_t nl = text.find('\n', target);
+            end = (nl == std::string_view::npos) ? text.size() : nl + 1;
+        }
+        pieces.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return pieces;
+}
+
+// RFC 4180 style CSV: fields may be quoted with '"', doubled to escape.
+// An empty unquoted field is NULL; "" is the empty string. Quoted fields
+// must not span lines, since chunks are cut at raw newlines.
+class CsvLineParser {
+public:
+    CsvLineParser(const std::vector<ColumnType>& types, char delimiter)
+        : types_(types), delimiter_(delimiter) {}
+
+    bool parse(std::string_view line, Row& row, std::string& error) const {
+        row.clear();
+        row.reserve(types_.size());
+        size_t pos = 0;
+        while (true) {
+            if (row.size() == types_.size()) {
+                error = "Too many fields, expected " + std::to_string(types_.size());
+                return false;
+            }
+            ColumnType type = types_[row.size()];
+
+            if (pos < line.size() && line[pos] == '"') {
+                std::string text;
+                ++pos;
+                while (true) {
+                    size_t q = line.find('"', pos);
+                    if (q == std::string_view::npos) {
+                        error = "Unterminated quoted field";
+                        return false;
+                    }
+                    text.append(line.substr(pos, q - pos));
+                    pos = q + 1;
+                    if (pos < line.size() && line[pos] == '"') {
+                        text += '"';
+                        ++pos;
+                        continue;
+                    }
+                    break;
+                }
+                if (pos < line.size() && line[pos] != delimiter_) {
+                    error = "Unexpected character after quoted field";
+                    return false;
+                }
+                if (!convert(text, type, false, row, error)) return false;
+            } else {
+                size_t end = line.find(delimiter_, pos);
+                if (end == std::string_view::npos) end = line.size();
+                if (!convert(line.substr(pos, end - pos), type, true, row, error)) return false;
+                pos = end;
+            }
+
+            if (pos >= line.size()) break;
+            ++pos;  // Delimiter
+        }
+
+        if (row.size() != types_.size()) {
+            error = "Expected " + std::to_string(types_.size()) + " fields, got " +
+                    std::to_string(row.size());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static bool convert(std::string_view field, ColumnType type, bool unquoted, Row& row, std::string& error) {
+        if (unquoted && field.empty()) {
+            row.emplace_back(NullValue{});
+            return true;
+        }
+        if (type == ColumnType::INT) {
+            int value = 0;
+            const char* begin = field.data();
+            const char* end = field.data() + field.size();
+            if (begin != end && *begin == '+') ++begin;
+            auto [ptr, ec] = std::from_chars(begin, end, value);
+            if (ec != std::errc() || ptr != end) {
+                error = "Invalid integer '" + std::string(field) + "'";
+                return false;
+            }
+            row.emplace_back(value);
+        } else {
+            row.emplace_back(std::string(field));
+        }
+        return true;
+    }
+
+    const std::vector<ColumnType>& types_;
+    char delimiter_;
+};
+
+void parseChunk(Chunk& chunk, const CsvLineParser& parser) {
+    std::string_view text = chunk.text;
+    // Roughly one row per 32 bytes keeps reallocation rare without overshooting much
+    chunk.rows.reserve(text.size() / 32 + 1);
+
+    Row row;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t nl = text.find('\n', pos);
+        size_t end = (nl == std::string_view::npos) ? text.size() : nl;
+        std::string_view line = text.substr(pos, end - pos);
+        pos = (nl == std::string_view::npos) ? text.size() : nl + 1;
+        ++chunk.lines;
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        if (!parser.parse(line, row, chunk.error)) {
+            chunk.errorLine = chunk.lines;
+            return;
+        }
+        chunk.rows.push_back(std::move(row));
+        row = Row();
+    }
+}
+
+// Sequential reader over a binary COPY file
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data) : data_(data) {}
+
+    bool atEnd() const { return pos_ >= data_.size(); }
+
+    bool readU8(uint8_t& out) {
+        if (pos_ + 1 > data_.size()) return false;
+        out = static_cast<uint8_t>(data_[pos_++]);
+        return true;
+    }
+
+    bool readU32(uint32_t& out) {
+        if (pos_ + 4 > data_.size()) return false;
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+            out |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_ + i])) << (8 * i);
+        }
+        pos_ += 4;
+        return true;
+    }
+
+    bool readBytes(size_t n, std::string_view& out) {
+        if (n > data_.size() - pos_) return false;
+        out = data_.substr(pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+// Forwards rows to the file writer but keeps a failure's message for the
+// executor to report, instead of the console
+class FileSink : public RowSink {
+public:
+    explicit FileSink(RowSink& target) : target_(target) {}
+
+    void begin(const std::vector<Column>& columns, bool stableRows) override {
+        target_.begin(columns, stableRows);
+    }
+    bool row(const Row& row, const std::vector<size_t>& projection) override {
+        return target_.row(row, projection);
+    }
+    void end() override { target_.end(); }
+    void error(const std::string& message) override { error_ = message; }
+
+    const std::string& errorMessage() const { return error_; }
+
+private:
+    RowSink& target_;
+    std::string error_;
+};
+
+} // namespace
+
+void BinaryWriteSink::begin(const std::vector<Column>& columns, bool) {
+    out_.write(std::string_view(CopyExecutor::kBinaryMagic, sizeof(CopyExecutor::kBinaryMagic)));
+    out_.writeU32(static_cast<uint32_t>(columns.size()));
+    for (const auto& col : columns) {
+        out_.writeU8(col.type == ColumnType::INT ? 0 : 1);
+        out_.writeU32(static_cast<uint32_t>(col.name.size()));
+        out_.write(col.name);
+    }
+}
+
+bool BinaryWriteSink::row(const Row& row, const std::vector<size_t>& projection) {
+    for (size_t idx : projection) {
+        const Value& v = row[idx];
+        if (std::holds_alternative<int>(v)) {
+            out_.writeU8(1);
+            out_.writeU32(static_cast<uint32_t>(std::get<int>(v)));
+        } else if (std::holds_alternative<std::string>(v)) {
+            const std::string& s = std::get<std::string>(v);
+            out_.writeU8(2);
+            out_.writeU32(static_cast<uint32_t>(s.size()));
+            out_.write(s);
+        } else {
+            out_.writeU8(0);
+        }
+    }
+    ++rows_;
+    return out_.ok();
+}
+
+CopyExecutor::CopyExecutor(Catalog& catalog, SelectRunner runSelect, std::ostream& out)
+    : catalog_(catalog), dml_(catalog, out), runSelect_(std::move(runSelect)), out_(out) {}
+
+void CopyExecutor::execute(const CopyQuery& query) {
+    if (query.toFile) {
+        executeCopyTo(query);
+    } else {
+        executeCopyFrom(query);
+    }
+}
+
+void CopyExecutor::executeCopyTo(const CopyQuery& query) {
+    const auto* select = static_cast<const SelectQuery*>(query.left.get());
+    if (!catalog_.tableExists(select->tableName)) {
+        out_ << "Error: Table '" << select->tableName << "' does not exist.\n";
+        return;
+    }
+
+    BufferedWriter out;
+    if (!out.open(query.path)) {
+        out_ << "Error: Cannot open file '" << query.path << "' for writing.\n";
+        return;
+    }
+
+    // Rows stream from the executor straight into the writer's buffer
+    size_t rows = 0;
+    bool ok = false;
+    std::string error;
+    if (query.format == CopyFormat::BINARY) {
+        BinaryWriteSink sink(out);
+        FileSink file(sink);
+        ok = runSelect_(*select, file);
+        rows = sink.rows();
+        error = file.errorMessage();
+    } else {
+        ResultPrinter printer(out, OutputMode::CSV, out_, query.header, query.delimiter);
+        FileSink file(printer);
+        ok = runSelect_(*select, file);
+        rows = printer.rowCount();
+        error = file.errorMessage();
+    }
+    if (!ok) {
+        if (!error.empty()) out_ << "Error: " << error << "\n";
+        return;
+    }
+
+    if (!out.close()) {
+        out_ << "Error: Failed writing to '" << query.path << "'.\n";
+        return;
+    }
+    out_ << rows << " row(s) copied.\n";
+}
+
+bool CopyExecutor::readBinary(std::string_view data, const std::vector<ColumnType>& types,
+                              std::vector<Row>& rows, std::string& error) const {
+    BinaryReader in(data);
+    std::string_view magic;
+    if (!in.readBytes(sizeof(kBinaryMagic), magic) ||
+        std::memcmp(magic.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        error = "Not a binary COPY file";
+        return false;
+    }
+
+    uint32_t columnCount = 0;
+    if (!in.readU32(columnCount) || columnCount != types.size()) {
+        error = "File has " + std::to_string(columnCount) + " columns, expected " +
+                std::to_string(types.size());
+        return false;
+    }
+    for (uint32_t i = 0; i < columnCount; ++i) {
+        uint8_t type = 0;
+        uint32_t nameLength = 0;
+        std::string_view name;
+        if (!in.readU8(type) || !in.readU32(nameLength) || !in.readBytes(nameLength, name)) {
+            error = "Truncated header";
+            return false;
+        }
+        if ((type == 0) != (types[i] == ColumnType::INT)) {
+            error = "Type mismatch for column '" + std::string(name) + "'";
+            return false;
+        }
+    }
+
+    while (!in.atEnd()) {
+        Row row;
+        row.reserve(types.size());
+        for (size_t i = 0; i < types.size(); ++i) {
+            uint8_t tag = 0;
+            uint32_t word = 0;
+            std::string_view bytes;
+            if (!in.readU8(tag)) {
+                error = "Truncated row " + std::to_string(rows.size() + 1);
+                return false;
+            }
+            if (tag == 0) {
+                row.emplace_back(NullValue{});
+            } else if (tag == 1 && in.readU32(word)) {
+                row.emplace_back(static_cast<int>(word));
+            } else if (tag == 2 && in.readU32(word) && in.readBytes(word, bytes)) {
+                row.emplace_back(std::string(bytes));
+            } else {
+                error = "Malformed value in row " + std::to_string(rows.size() + 1);
+                return false;
+            }
+        }
+        rows.push_back(std::move(row));
+    }
+    return true;
+}
+
+void CopyExecutor::executeCopyFrom(const CopyQuery& query) {
+    Table* table = catalog_.getTable(query.tableName);
+    if (!table) {
+        out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
+        return;
+    }
+
+    // Field types in file order
+    std::vector<ColumnType> types;
+    if (query.columns.empty()) {
+        for (const auto& col : table->columns) types.push_back(col.type);
+    } else {
+        for (const auto& name : query.columns) {
+            bool found = false;
+            for (const auto& col : table->columns) {
+                if (col.name == name) {
+                    types.push_back(col.type);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                out_ << "Error: Column '" << name << "' not found.\n";
+                return;
+            }
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(query.path)) {
+        out_ << "Error: Cannot open file '" << query.path << "'.\n";
+        return;
+    }
+
+    if (query.format == CopyFormat::BINARY) {
+        // Records are variable-length with no sync points, so binary input
+        // is read sequentially
+        std::vector<Row> rows;
+        std::string error;
+        if (!readBinary(file.view(), types, rows, error)) {
+            out_ << "Error: " << error << ".\n";
+            return;
+        }
+        size_t count = rows.size();
+        if (!dml_.appendRows(query.tableName, query.columns, std::move(rows), error)) {
+            out_ << "Error: " << error << "\n";
+            return;
+        }
+        out_ << count << " row(s) copied.\n";
+        return;
+    }
+
+    std::string_view text = file.view();
+    size_t skippedLines = 0;
+    if (query.header) {
+        size_t nl = text.find('\n');
+        text = (nl == std::string_view::npos) ? std::string_view() : text.substr(nl + 1);
+        skippedLines = 1;
+    }
+
+    size_t threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    threads = std::min(threads, text.size() / kMinChunkBytes + 1);
+
+    std::vector<Chunk> chunks;
+    for (std::string_view piece : splitAtLines(text, threads)) {
+        chunks.emplace_back();
+        chunks.back().text = piece;
+    }
+
+    CsvLineParser parser(types, query.delimiter);
+    if (chunks.size() <= 1) {
+        for (auto& chunk : chunks) parseChunk(chunk, parser);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size());
+        for (auto& chunk : chunks) {
+            workers.emplace_back([&chunk, &parser]() { parseChunk(chunk, parser); });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    // Nothing is appended unless every chunk parsed cleanly
+    size_t lineBase = skippedLines;
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            out_ << "Error: Line " << (lineBase + chunk.errorLine) << ": " << chunk.error << ".\n";
+            return;
+        }
+        lineBase += chunk.lines;
+        total += chunk.rows.size();
+    }
+
+    table->rows.reserve(table->rows.size() + total);
+    std::string error;
+    for (auto& chunk : chunks) {
+        if (!dml_.appendRows(query.tableName, query.columns, std::move(chunk.rows), error)) {
+            out_ << "Error: " << error << "\n";
+            return;
+        }
+    }
+    out_ << total << " row(s) copied.\n";
+}
+
+} // namespace nanodb
@@ -1,24 +1,129 @@
 #include "nanodb/executor/ddl_executor.hpp"
+#include "nanodb/index/hash_index.hpp"
+#include "nanodb/index/bitmap_index.hpp"
+#include "nanodb/index/ordered_index.hpp"
+#include "nanodb/index/bloom_index.hpp"
 
 #include <iostream>
+#include <memory>
 
 namespace nanodb {
 
-DDLExecutor::DDLExecutor(Catalog& catalog) : catalog_(catalog) {}
+DDLExecutor::DDLExecutor(Catalog& catalog, std::ostream& out) : catalog_(catalog), out_(out) {}
 
 void DDLExecutor::executeCreateTable(const CreateQuery& query) {
     if (catalog_.createTable(query.tableName, query.columns)) {
-        std::cout << "Table '" << query.tableName << "' created.\n";
+        out_ << "Table '" << query.tableName << "' created.\n";
     } else {
-        std::cout << "Error: Table '" << query.tableName << "' already exists.\n";
+        out_ << "Error: Table '" << query.tableName << "' already exists.\n";
     }
 }
 
 void DDLExecutor::executeDropTable(const DropQuery& query) {
+    // Open transactions refer to the rows they wrote
+    const Table* table = catalog_.getTable(query.tableName);
+    if (table && table->pendingWriters.load(std::memory_order_acquire) > 0) {
+        out_ << "Error: Table '" << query.tableName << "' has uncommitted changes.\n";
+        return;
+    }
     if (catalog_.dropTable(query.tableName)) {
-        std::cout << "Table '" << query.tableName << "' dropped.\n";
+        out_ << "Table '" << query.tableName << "' dropped.\n";
+    } else {
+        out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
+    }
+}
+
+void DDLExecutor::executeVacuum(const VacuumQuery& query) {
+    std::vector<std::string> names;
+    if (query.tableName.empty()) {
+        names = catalog_.tableNames();
+    } else {
+        if (!catalog_.tableExists(query.tableName)) {
+            out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
+            return;
+        }
+        names.push_back(query.tableName);
+    }
+
+    size_t reclaimed = 0;
+    for (const auto& name : names) {
+        reclaimed += catalog_.compactTable(*catalog_.getTable(name));
+    }
+    out_ << reclaimed << " row(s) reclaimed.\n";
+}
+
+void DDLExecutor::executeCreateIndex(const CreateIndexQuery& query) {
+    const Table* table = catalog_.getTable(query.tableName);
+    if (!table) {
+        out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
+        return;
+    }
+    if (catalog_.indexExists(query.indexName)) {
+        out_ << "Error: Index '" << query.indexName << "' already exists.\n";
+        return;
+    }
+
+    int colIdx = -1;
+    for (size_t i = 0; i < table->columns.size(); ++i) {
+        if (table->columns[i].name == query.column) {
+            colIdx = static_cast<int>(i);
+            break;
+        }
+    }
+    if (colIdx < 0) {
+        out_ << "Error: Column '" << query.column << "' not found.\n";
+        return;
+    }
+
+    std::vector<size_t> includeIndices;
+    for (const auto& col : query.includeColumns) {
+        int idx = -1;
+        for (size_t i = 0; i < table->columns.size(); ++i) {
+            if (table->columns[i].name == col) {
+                idx = static_cast<int>(i);
+                break;
+            }
+        }
+        if (idx < 0) {
+            out_ << "Error: Column '" << col << "' not found.\n";
+            return;
+        }
+        includeIndices.push_back(static_cast<size_t>(idx));
+    }
+    if (!includeIndices.empty() && query.indexType != IndexType::ORDERED) {
+        out_ << "Error: INCLUDE is only supported for ordered indexes.\n";
+        return;
+    }
+
+    std::unique_ptr<Index> index;
+    switch (query.indexType) {
+        case IndexType::ORDERED:
+            index = std::make_unique<OrderedIndex>(query.indexName, *table,
+                                                   static_cast<size_t>(colIdx), includeIndices);
+            break;
+        case IndexType::HASH:
+            index = std::make_unique<HashIndex>(query.indexName, query.tableName,
+                                                query.column, static_cast<size_t>(colIdx));
+            break;
+        case IndexType::BITMAP:
+            index = std::make_unique<BitmapIndex>(query.indexName, query.tableName,
+                                                  query.column, static_cast<size_t>(colIdx));
+            break;
+        case IndexType::BLOOM:
+            index = std::make_unique<BloomIndex>(query.indexName, query.tableName,
+                                                 query.column, static_cast<size_t>(colIdx));
+            break;
+    }
+
+    catalog_.createIndex(std::move(index));
+    out_ << "Index '" << query.indexName << "' created.\n";
+}
+
+void DDLExecutor::executeDropIndex(const DropIndexQuery& query) {
+    if (catalog_.dropIndex(query.indexName)) {
+        out_ << "Index '" << query.indexName << "' dropped.\n";
     } else {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
+        out_ << "Error: Index '" << query.indexName << "' does not exist.\n";
     }
 }
 
@@ -1,11 +1,33 @@
 #include "nanodb/executor/dml_executor.hpp"
 
 #include <iostream>
-#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
 
 namespace nanodb {
 
-DMLExecutor::DMLExecutor(Catalog& catalog) : catalog_(catalog) {}
+namespace {
+
+// A row this statement would change was changed by a transaction it cannot
+// see; the caller rolls the transaction back
+void reportConflict(std::ostream& out) {
+    out << "Error: Could not serialize access due to a concurrent update.\n";
+}
+
+// Whether a value may be stored in the column; NULL fits any column
+bool fitsColumn(const Value& v, const Column& col) {
+    if (isNull(v)) return true;
+    return col.type == ColumnType::INT ? std::holds_alternative<int>(v)
+                                       : std::holds_alternative<std::string>(v);
+}
+
+std::string typeMismatch(const Column& col) {
+    return "Type mismatch for column '" + col.name + "'.";
+}
+
+} // namespace
+
+DMLExecutor::DMLExecutor(Catalog& catalog, std::ostream& out) : catalog_(catalog), out_(out) {}
 
 int DMLExecutor::findColumnIndex(const Table& table, const std::string& colName) const {
     for (size_t i = 0; i < table.columns.size(); ++i) {
@@ -25,6 +47,13 @@ bool DMLExecutor::evaluateSingleCondition(const Row& row, const Table& table, co
     const Value& rowVal = row[colIdx];
     const Value& condVal = cond.value;
 
+    if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) {
+            if (!isNull(v) && rowVal == v) return true;
+        }
+        return false;
+    }
+
     if (std::holds_alternative<int>(rowVal) && std::holds_alternative<int>(condVal)) {
         int rv = std::get<int>(rowVal);
         int cv = std::get<int>(condVal);
@@ -35,6 +64,7 @@ bool DMLExecutor::evaluateSingleCondition(const Row& row, const Table& table, co
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     } else if (std::holds_alternative<std::string>(rowVal) && std::holds_alternative<std::string>(condVal)) {
         const std::string& rv = std::get<std::string>(rowVal);
@@ -46,6 +76,7 @@ bool DMLExecutor::evaluateSingleCondition(const Row& row, const Table& table, co
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     }
 
@@ -72,102 +103,182 @@ bool DMLExecutor::evaluateWhereClause(const Row& row, const Table& table, const
 }
 
 void DMLExecutor::executeInsert(const InsertQuery& query) {
-    Table* table = catalog_.getTable(query.tableName);
-    if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
+    std::string error;
+    size_t count = query.rows.size();
+    if (!appendRows(query.tableName, query.insertColumns, query.rows, error)) {
+        out_ << "Error: " << error << "\n";
         return;
     }
+    if (count == 1) {
+        out_ << "1 row inserted.\n";
+    } else {
+        out_ << count << " rows inserted.\n";
+    }
+}
 
-    Row newRow;
+bool DMLExecutor::appendRows(const std::string& tableName, const std::vector<std::string>& columns,
+                             std::vector<Row> rows, std::string& error) {
+    Table* table = catalog_.getTable(tableName);
+    if (!table) {
+        error = "Table '" + tableName + "' does not exist.";
+        return false;
+    }
 
-    if (!query.insertColumns.empty()) {
-        if (query.insertColumns.size() != query.values.size()) {
-            std::cout << "Error: Column count mismatch. Expected "
-                      << query.insertColumns.size() << ", got " << query.values.size() << ".\n";
-            return;
+    // Resolve the column list once for the whole batch; schema holds the
+    // column each row position is stored in
+    std::vector<size_t> targets;
+    std::vector<const Column*> schema;
+    if (columns.empty()) {
+        for (const auto& col : table->columns) schema.push_back(&col);
+    } else {
+        targets.reserve(columns.size());
+        for (const auto& name : columns) {
+            int colIdx = findColumnIndex(*table, name);
+            if (colIdx < 0) {
+                error = "Column '" + name + "' not found.";
+                return false;
+            }
+            targets.push_back(static_cast<size_t>(colIdx));
+            schema.push_back(&table->columns[colIdx]);
+        }
+    }
+
+    for (const auto& row : rows) {
+        if (row.size() != schema.size()) {
+            error = "Column count mismatch. Expected " + std::to_string(schema.size()) +
+                    ", got " + std::to_string(row.size()) + ".";
+            return false;
+        }
+        for (size_t i = 0; i < row.size(); ++i) {
+            if (!fitsColumn(row[i], *schema[i])) {
+                error = typeMismatch(*schema[i]);
+                return false;
+            }
         }
+    }
 
-        newRow.resize(table->columns.size());
-        for (size_t i = 0; i < table->columns.size(); ++i) {
-            if (table->columns[i].type == ColumnType::INT) {
-                newRow[i] = 0;
+    // Columns left out of the list get their type's default
+    Row defaults;
+    if (!targets.empty()) {
+        defaults.reserve(table->columns.size());
+        for (const auto& col : table->columns) {
+            if (col.type == ColumnType::INT) {
+                defaults.push_back(0);
             } else {
-                newRow[i] = std::string("");
+                defaults.push_back(std::string(""));
             }
         }
+    }
 
-        for (size_t i = 0; i < query.insertColumns.size(); ++i) {
-            int colIdx = findColumnIndex(*table, query.insertColumns[i]);
-            if (colIdx < 0) {
-                std::cout << "Error: Column '" << query.insertColumns[i] << "' not found.\n";
-                return;
+    // New versions stay invisible to other statements until commit
+    Transaction* txn = Transaction::running();
+    size_t firstRowId = table->rows.size();
+    table->rows.reserve(firstRowId + rows.size());
+    for (auto& row : rows) {
+        if (targets.empty()) {
+            txn->append(*table, std::move(row));
+        } else {
+            Row newRow = defaults;
+            for (size_t i = 0; i < targets.size(); ++i) {
+                newRow[targets[i]] = std::move(row[i]);
             }
-            newRow[colIdx] = query.values[i];
-        }
-    } else {
-        if (query.values.size() != table->columns.size()) {
-            std::cout << "Error: Column count mismatch. Expected "
-                      << table->columns.size() << ", got " << query.values.size() << ".\n";
-            return;
+            txn->append(*table, std::move(newRow));
         }
-        newRow = query.values;
     }
 
-    table->rows.push_back(newRow);
-    std::cout << "1 row inserted.\n";
+    indexRows(*table, firstRowId);
+    return true;
+}
+
+void DMLExecutor::indexRows(const Table& table, size_t firstRowId) {
+    const auto& indexes = catalog_.getIndexes(table.name);
+    if (indexes.empty()) return;
+    std::unique_lock<std::shared_mutex> latch(catalog_.indexLatch(table.name));
+    for (const auto& index : indexes) {
+        for (size_t rowId = firstRowId; rowId < table.rows.size(); ++rowId) {
+            index->insert(table.rows[rowId], rowId);
+        }
+    }
 }
 
 void DMLExecutor::executeUpdate(const UpdateQuery& query) {
     Table* table = catalog_.getTable(query.tableName);
     if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
+        out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
         return;
     }
 
+    std::vector<std::pair<int, const Value*>> assignments;
     for (const auto& sc : query.setClauses) {
-        if (findColumnIndex(*table, sc.column) < 0) {
-            std::cout << "Error: Column '" << sc.column << "' not found.\n";
+        int colIdx = findColumnIndex(*table, sc.column);
+        if (colIdx < 0) {
+            out_ << "Error: Column '" << sc.column << "' not found.\n";
+            return;
+        }
+        if (!fitsColumn(sc.value, table->columns[colIdx])) {
+            out_ << "Error: " << typeMismatch(table->columns[colIdx]) << "\n";
             return;
         }
+        assignments.emplace_back(colIdx, &sc.value);
     }
 
-    size_t updateCount = 0;
-    for (auto& row : table->rows) {
-        if (evaluateWhereClause(row, *table, query.where)) {
-            for (const auto& sc : query.setClauses) {
-                int colIdx = findColumnIndex(*table, sc.column);
-                row[colIdx] = sc.value;
-            }
-            ++updateCount;
+    // Rows are never changed in place, since concurrent readers may be
+    // looking at them: the matching version ends and an updated copy is
+    // appended. New versions are collected first so the scan never visits
+    // them.
+    Transaction* txn = Transaction::running();
+    std::vector<Row> updated;
+    ScanPlan plan = AccessPath::choose(catalog_, *table, query.where);
+    plan.forEachRow(*table, [&](size_t rowId) {
+        const Row& row = table->rows[rowId];
+        if (!evaluateWhereClause(row, *table, query.where)) return true;
+        if (!txn->expire(*table, rowId)) return false;
+        Row newRow = row;
+        for (const auto& [colIdx, value] : assignments) {
+            newRow[colIdx] = *value;
         }
+        updated.push_back(std::move(newRow));
+        return true;
+    });
+    if (txn->conflicted()) {
+        reportConflict(out_);
+        return;
     }
 
-    std::cout << updateCount << " row(s) updated.\n";
+    size_t firstRowId = table->rows.size();
+    table->rows.reserve(firstRowId + updated.size());
+    for (auto& row : updated) {
+        txn->append(*table, std::move(row));
+    }
+    indexRows(*table, firstRowId);
+
+    out_ << updated.size() << " row(s) updated.\n";
 }
 
 void DMLExecutor::executeDelete(const DeleteQuery& query) {
     Table* table = catalog_.getTable(query.tableName);
     if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
+        out_ << "Error: Table '" << query.tableName << "' does not exist.\n";
         return;
     }
 
-    size_t beforeCount = table->rows.size();
-
-    if (query.where.hasWhere) {
-        table->rows.erase(
-            std::remove_if(table->rows.begin(), table->rows.end(),
-                [this, table, &query](const Row& row) {
-                    return evaluateWhereClause(row, *table, query.where);
-                }),
-            table->rows.end()
-        );
-    } else {
-        table->rows.clear();
+    // Ending a version is all it takes; index entries stay until
+    // compaction drops the version and rebuilds the indexes
+    Transaction* txn = Transaction::running();
+    size_t deleteCount = 0;
+    ScanPlan plan = AccessPath::choose(catalog_, *table, query.where);
+    plan.forEachRow(*table, [&](size_t rowId) {
+        if (!evaluateWhereClause(table->rows[rowId], *table, query.where)) return true;
+        if (!txn->expire(*table, rowId)) return false;
+        ++deleteCount;
+        return true;
+    });
+    if (txn->conflicted()) {
+        reportConflict(out_);
+        return;
     }
 
-    size_t deleteCount = beforeCount - table->rows.size();
-    std::cout << deleteCount << " row(s) deleted.\n";
+    out_ << deleteCount << " row(s) deleted.\n";
 }
 
 } // namespace nanodb
@@ -1,11 +1,136 @@
 #include "nanodb/executor/join_executor.hpp"
+#include "nanodb/core/cancellation.hpp"
+#include "nanodb/core/memory.hpp"
+#include "nanodb/core/metrics.hpp"
+#include "nanodb/index/hash_index.hpp"
+#include "nanodb/index/bloom_index.hpp"
+#include "nanodb/executor/spill_file.hpp"
 
-#include <iostream>
-#include <iomanip>
-#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
 
 namespace nanodb {
 
+namespace {
+
+// Hash join for build sides over the memory limit (grace hash join): both
+// inputs are partitioned on the join key into spill files, so matching
+// rows land in partitions with the same number, and each pair is joined
+// on its own with a hash table of just that build partition
+class GraceJoin {
+public:
+    // Joins one probe row against a build partition; false once done
+    using ProbeFn = std::function<bool(const Row&, const HashIndex&, const std::vector<Row>&)>;
+
+    GraceJoin(const Table& buildTable, size_t buildJoinCol, size_t probeJoinCol, bool keepUnmatchedProbe,
+              ProbeFn probe)
+        : buildTable_(buildTable), buildJoinCol_(buildJoinCol), probeJoinCol_(probeJoinCol),
+          keepUnmatchedProbe_(keepUnmatchedProbe), probe_(std::move(probe)) {}
+
+    // Partitions the visible rows of both tables, then joins partition pairs;
+    // probed counts probe rows read, more turns false once probe does
+    bool run(const Table& probeTable, size_t& probed, bool& more, std::string& error) {
+        SpillPartitions build, probe;
+        if (!build.open(0, error) || !probe.open(0, error)) return false;
+        const Transaction& txn = Transaction::current();
+        for (size_t b = 0; b < buildTable_.rows.size(); ++b) {
+            if (!buildTable_.isDeleted(b, txn)) build.add(buildTable_.rows[b], {buildJoinCol_});
+        }
+        for (size_t p = 0; p < probeTable.rows.size(); ++p) {
+            if (probeTable.isDeleted(p, txn)) continue;
+            ++probed;
+            probe.add(probeTable.rows[p], {probeJoinCol_});
+        }
+        return joinPartitions(build, probe, more, error);
+    }
+
+    const SpillStats& stats() const { return stats_; }
+    size_t peakBytes() const { return peakBytes_; }
+    // Distinct build keys, summed over partitions
+    size_t keys() const { return keys_; }
+
+private:
+    bool joinPartitions(SpillPartitions& build, SpillPartitions& probe, bool& more, std::string& error) {
+        if (!build.finish(error) || !probe.finish(error)) return false;
+        stats_.add(build);
+        stats_.add(probe);
+        for (size_t i = 0; more && i < SpillPartitions::kFanout; ++i) {
+            if (CancellationToken::stopRequested()) {
+                more = false;
+                break;
+            }
+            if (!joinPartition(build[i], probe[i], build.level(), more, error)) return false;
+        }
+        return true;
+    }
+
+    bool joinPartition(SpillFile& buildFile, SpillFile& probeFile, size_t level, bool& more,
+                       std::string& error) {
+        if (probeFile.rows() == 0) return true;
+        if (buildFile.rows() == 0 && !keepUnmatchedProbe_) return true;
+
+        std::vector<Row> rows;
+        HashIndex index("", buildTable_.name, buildTable_.columns[buildJoinCol_].name, buildJoinCol_);
+        MemoryReservation memory;
+        size_t estimate = 0;
+        bool fits = true;
+        Row row;
+        while (fits && buildFile.read(row)) {
+            size_t keys = index.distinctKeys();
+            estimate += approxRowBytes(row) + sizeof(size_t);
+            rows.push_back(std::move(row));
+            index.insert(rows.back(), rows.size() - 1);
+            estimate += (index.distinctKeys() - keys) * HashIndex::keyOverheadBytes();
+            fits = memory.fits(estimate);
+        }
+        if (!buildFile.ok() || !probeFile.ok()) return readError(error);
+
+        if (!fits) {
+            // Still too large: split both sides of this pair again
+            if (level + 1 >= SpillPartitions::kMaxLevel) {
+                error = memoryLimitError();
+                return false;
+            }
+            rows.clear();
+            index.clear();
+            memory.reset();
+            SpillPartitions build, probe;
+            if (!build.open(level + 1, error) || !probe.open(level + 1, error)) return false;
+            if (!buildFile.finish(error)) return false;
+            while (buildFile.read(row)) build.add(row, {buildJoinCol_});
+            while (probeFile.read(row)) probe.add(row, {probeJoinCol_});
+            if (!buildFile.ok() || !probeFile.ok()) return readError(error);
+            return joinPartitions(build, probe, more, error);
+        }
+
+        peakBytes_ = std::max(peakBytes_, estimate);
+        keys_ += index.distinctKeys();
+        while (more && probeFile.read(row)) {
+            more = probe_(row, index, rows);
+        }
+        if (!probeFile.ok()) return readError(error);
+        return true;
+    }
+
+    static bool readError(std::string& error) {
+        error = "Cannot read spill file.";
+        return false;
+    }
+
+    const Table& buildTable_;
+    size_t buildJoinCol_;
+    size_t probeJoinCol_;
+    bool keepUnmatchedProbe_;
+    ProbeFn probe_;
+    SpillStats stats_;
+    size_t peakBytes_ = 0;
+    size_t keys_ = 0;
+};
+
+} // namespace
+
 JoinExecutor::JoinExecutor(Catalog& catalog) : catalog_(catalog) {}
 
 int JoinExecutor::findColumnIndex(const Table& table, const std::string& colName) const {
@@ -17,19 +142,20 @@ int JoinExecutor::findColumnIndex(const Table& table, const std::string& colName
     return -1;
 }
 
-void JoinExecutor::execute(const SelectQuery& query) {
+bool JoinExecutor::execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan) {
+    Stopwatch clock;
     // Get left table
     const Table* leftTable = catalog_.getTable(query.tableName);
     if (!leftTable) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
-        return;
+        sink.error("Table '" + query.tableName + "' does not exist.");
+        return false;
     }
 
     // Get right table
     const Table* rightTable = catalog_.getTable(query.join.tableName);
     if (!rightTable) {
-        std::cout << "Error: Table '" << query.join.tableName << "' does not exist.\n";
-        return;
+        sink.error("Table '" + query.join.tableName + "' does not exist.");
+        return false;
     }
 
     // Find join column indices
@@ -37,12 +163,12 @@ void JoinExecutor::execute(const SelectQuery& query) {
     int rightJoinCol = findColumnIndex(*rightTable, query.join.rightColumn);
 
     if (leftJoinCol < 0) {
-        std::cout << "Error: Column '" << query.join.leftColumn << "' not found in " << query.tableName << ".\n";
-        return;
+        sink.error("Column '" + query.join.leftColumn + "' not found in " + query.tableName + ".");
+        return false;
     }
     if (rightJoinCol < 0) {
-        std::cout << "Error: Column '" << query.join.rightColumn << "' not found in " << query.join.tableName << ".\n";
-        return;
+        sink.error("Column '" + query.join.rightColumn + "' not found in " + query.join.tableName + ".");
+        return false;
     }
 
     // Build combined schema
@@ -54,68 +180,14 @@ void JoinExecutor::execute(const SelectQuery& query) {
         combinedCols.push_back({query.join.tableName + "." + col.name, col.type});
     }
 
-    // Perform nested loop join
-    std::vector<Row> joinedRows;
-
-    if (query.join.type == JoinType::INNER) {
-        for (const auto& leftRow : leftTable->rows) {
-            for (const auto& rightRow : rightTable->rows) {
-                if (leftRow[leftJoinCol] == rightRow[rightJoinCol]) {
-                    Row combined = leftRow;
-                    combined.insert(combined.end(), rightRow.begin(), rightRow.end());
-                    joinedRows.push_back(combined);
-                }
-            }
-        }
-    } else if (query.join.type == JoinType::LEFT) {
-        for (const auto& leftRow : leftTable->rows) {
-            bool matched = false;
-            for (const auto& rightRow : rightTable->rows) {
-                if (leftRow[leftJoinCol] == rightRow[rightJoinCol]) {
-                    Row combined = leftRow;
-                    combined.insert(combined.end(), rightRow.begin(), rightRow.end());
-                    joinedRows.push_back(combined);
-                    matched = true;
-                }
-            }
-            if (!matched) {
-                Row combined = leftRow;
-                for (size_t i = 0; i < rightTable->columns.size(); ++i) {
-                    combined.push_back(NullValue{});
-                }
-                joinedRows.push_back(combined);
-            }
-        }
-    } else if (query.join.type == JoinType::RIGHT) {
-        for (const auto& rightRow : rightTable->rows) {
-            bool matched = false;
-            for (const auto& leftRow : leftTable->rows) {
-                if (leftRow[leftJoinCol] == rightRow[rightJoinCol]) {
-                    Row combined = leftRow;
-                    combined.insert(combined.end(), rightRow.begin(), rightRow.end());
-                    joinedRows.push_back(combined);
-                    matched = true;
-                }
-            }
-            if (!matched) {
-                Row combined;
-                for (size_t i = 0; i < leftTable->columns.size(); ++i) {
-                    combined.push_back(NullValue{});
-                }
-                combined.insert(combined.end(), rightRow.begin(), rightRow.end());
-                joinedRows.push_back(combined);
-            }
-        }
-    }
-
     // Determine which columns to display
     std::vector<size_t> colIndices;
-    std::vector<std::string> displayNames;
+    std::vector<Column> displayColumns;
 
     if (query.selectColumns.empty()) {
         for (size_t i = 0; i < combinedCols.size(); ++i) {
             colIndices.push_back(i);
-            displayNames.push_back(combinedCols[i].name);
+            displayColumns.push_back(combinedCols[i]);
         }
     } else {
         for (const auto& colName : query.selectColumns) {
@@ -124,55 +196,254 @@ void JoinExecutor::execute(const SelectQuery& query) {
                 if (combinedCols[i].name == colName ||
                     combinedCols[i].name.substr(combinedCols[i].name.find('.') + 1) == colName) {
                     colIndices.push_back(i);
-                    displayNames.push_back(colName);
+                    displayColumns.push_back({colName, combinedCols[i].type});
                     found = true;
                     break;
                 }
             }
             if (!found) {
-                std::cout << "Error: Column '" << colName << "' not found.\n";
-                return;
+                sink.error("Column '" + colName + "' not found.");
+                return false;
             }
         }
     }
 
-    // Print header
-    for (size_t i = 0; i < displayNames.size(); ++i) {
-        std::cout << std::setw(15) << displayNames[i];
-        if (i < displayNames.size() - 1) std::cout << " | ";
+    // Hash join: each outer (probe) row looks up its key in a hash index on
+    // the inner (build) table. An existing HASH index on the inner join
+    // column is used as a pre-built build side; otherwise one is built here.
+    bool rightOuter = query.join.type == JoinType::RIGHT;
+    const Table* buildTable = rightOuter ? leftTable : rightTable;
+    const Table* probeTable = rightOuter ? rightTable : leftTable;
+    int buildJoinCol = rightOuter ? leftJoinCol : rightJoinCol;
+    int probeJoinCol = rightOuter ? rightJoinCol : leftJoinCol;
+
+    const HashIndex* buildIndex = static_cast<const HashIndex*>(
+        catalog_.findIndex(buildTable->name, buildTable->columns[buildJoinCol].name, IndexType::HASH));
+
+    // In an inner join, a probe row group whose Bloom filter holds none of
+    // the build-side keys cannot produce output and is skipped wholesale
+    const Index* probeBloom = nullptr;
+    if (query.join.type == JoinType::INNER) {
+        probeBloom = catalog_.findIndex(probeTable->name, probeTable->columns[probeJoinCol].name,
+                                        IndexType::BLOOM);
     }
-    std::cout << "\n";
 
-    // Print separator
-    for (size_t i = 0; i < displayNames.size(); ++i) {
-        std::cout << std::string(15, '-');
-        if (i < displayNames.size() - 1) std::cout << "-+-";
+    std::unique_ptr<HashIndex> transientIndex;
+    MemoryReservation memory;
+    bool spilled = false;
+    std::unique_ptr<GraceJoin> grace;
+    bool explainOnly = plan && !plan->analyze;
+    if (!buildIndex && !explainOnly) {
+        transientIndex = std::make_unique<HashIndex>("", buildTable->name,
+            buildTable->columns[buildJoinCol].name, static_cast<size_t>(buildJoinCol));
+        // Inserted row by row so the hash table is charged against the
+        // memory limit as it grows
+        size_t estimate = 0;
+        const Transaction& txn = Transaction::current();
+        for (size_t b = 0; !spilled && b < buildTable->rows.size(); ++b) {
+            if (b % Table::kRowGroupSize == 0 && CancellationToken::stopRequested()) break;
+            if (buildTable->isDeleted(b, txn)) continue;
+            size_t keys = transientIndex->distinctKeys();
+            transientIndex->insert(buildTable->rows[b], b);
+            estimate += sizeof(size_t) + (transientIndex->distinctKeys() - keys) * HashIndex::keyOverheadBytes();
+            spilled = !memory.fits(estimate);
+        }
+        if (spilled) {
+            // Falls back to a grace hash join below
+            transientIndex.reset();
+            memory.reset();
+        } else {
+            buildIndex = transientIndex.get();
+        }
     }
-    std::cout << "\n";
+    double buildMs = clock.elapsedMs();
 
-    // Print rows
-    size_t rowCount = 0;
-    size_t maxRows = (query.limit > 0) ? static_cast<size_t>(query.limit) : joinedRows.size();
-
-    for (const auto& row : joinedRows) {
-        if (rowCount >= maxRows) break;
-
-        for (size_t i = 0; i < colIndices.size(); ++i) {
-            std::visit([](const auto& val) {
-                using T = std::decay_t<decltype(val)>;
-                if constexpr (std::is_same_v<T, NullValue>) {
-                    std::cout << std::setw(15) << "NULL";
-                } else {
-                    std::cout << std::setw(15) << val;
+    // Index latches: the build table's while a catalog hash index is read,
+    // the probe table's while its Bloom filter is. Taken together through
+    // std::lock, which orders them. The build latch is dropped between
+    // probe row groups so writers of the build table never wait long.
+    bool sharedBuild = buildIndex && !transientIndex;
+    std::shared_lock<std::shared_mutex> buildLatch(catalog_.indexLatch(buildTable->name), std::defer_lock);
+    std::shared_lock<std::shared_mutex> probeLatch(catalog_.indexLatch(probeTable->name), std::defer_lock);
+    if (buildTable == probeTable) {
+        if (sharedBuild || probeBloom) buildLatch.lock();
+    } else if (sharedBuild && probeBloom) {
+        std::lock(buildLatch, probeLatch);
+    } else if (sharedBuild) {
+        buildLatch.lock();
+    } else if (probeBloom) {
+        probeLatch.lock();
+    }
+
+    std::vector<bool> skippedGroups;
+    if (probeBloom && buildIndex && buildIndex->distinctKeys() <= kMaxBloomProbeKeys) {
+        const auto* bloom = static_cast<const BloomIndex*>(probeBloom);
+        size_t groupCount = (probeTable->rows.size() + Table::kRowGroupSize - 1) / Table::kRowGroupSize;
+        skippedGroups.assign(groupCount, true);
+        buildIndex->forEachKey([&](const Value& key) {
+            for (size_t g = 0; g < groupCount; ++g) {
+                if (skippedGroups[g] && bloom->mayContain(g, key)) {
+                    skippedGroups[g] = false;
                 }
-            }, row[colIndices[i]]);
-            if (i < colIndices.size() - 1) std::cout << " | ";
+            }
+        });
+    }
+    if (probeLatch.owns_lock()) probeLatch.unlock();
+    if (!sharedBuild && buildLatch.owns_lock()) buildLatch.unlock();
+
+    // Operator counters for EXPLAIN ANALYZE
+    size_t probed = 0;
+    size_t rowCount = 0;
+    auto describe = [&]() {
+        static const char* kJoinTypes[] = {"Inner", "Left", "Right"};
+        PlanNode join;
+        join.name = std::string("Hash ") + kJoinTypes[static_cast<int>(query.join.type)] + " Join";
+        join.details.push_back("Condition: " + query.tableName + "." + query.join.leftColumn + " = " +
+                               query.join.tableName + "." + query.join.rightColumn);
+        join.rowsIn = probed;
+        join.rowsOut = rowCount;
+        join.millis = clock.elapsedMs();
+
+        PlanNode probe;
+        probe.name = "Seq Scan on " + probeTable->name + " (probe)";
+        size_t skipped = std::count(skippedGroups.begin(), skippedGroups.end(), true);
+        if (skipped > 0) {
+            probe.details.push_back("Row groups skipped by Bloom filter: " + std::to_string(skipped) +
+                                    " of " + std::to_string(skippedGroups.size()));
+        }
+        probe.rowsIn = probed;
+        probe.rowsOut = probed;
+        probe.millis = join.millis;
+
+        PlanNode build;
+        const std::string& buildColumn = buildTable->columns[buildJoinCol].name;
+        if (transientIndex || !buildIndex) {
+            build.name = "Hash Build on " + buildTable->name + " (" + buildColumn + ")";
+        } else {
+            build.name = "Hash Index " + buildIndex->name() + " on " + buildTable->name + " (" + buildColumn + ")";
+        }
+        if (buildIndex) {
+            build.rowsIn = buildTable->liveRowCount();
+            build.rowsOut = buildIndex->distinctKeys();
+        }
+        build.millis = buildMs;
+        if (transientIndex) build.memoryBytes = transientIndex->memoryBytes();
+        if (spilled) {
+            build.rowsIn = buildTable->liveRowCount();
+            if (grace) {
+                build.rowsOut = grace->keys();
+                build.memoryBytes = grace->peakBytes();
+                build.details.push_back(grace->stats().describe());
+            }
+        }
+
+        join.children.push_back(std::move(probe));
+        join.children.push_back(std::move(build));
+        if (query.limit > 0) {
+            PlanNode limit;
+            limit.name = "Limit " + std::to_string(query.limit);
+            limit.rowsIn = rowCount;
+            limit.rowsOut = rowCount;
+            limit.millis = join.millis;
+            limit.children.push_back(std::move(join));
+            plan->root = std::move(limit);
+        } else {
+            plan->root = std::move(join);
+        }
+    };
+    if (explainOnly) {
+        describe();
+        return true;
+    }
+
+    sink.begin(displayColumns, false);
+
+    // Joined rows go to the sink one at a time, stopping at LIMIT or, every
+    // row group's worth of output, on cancellation: one skewed key can
+    // match far more rows than a probe row group holds
+    size_t maxRows = (query.limit > 0) ? static_cast<size_t>(query.limit) : SIZE_MAX;
+    Row combined;
+    auto emit = [&](const Row* leftRow, const Row* rightRow) -> bool {
+        combined.clear();
+        if (leftRow) {
+            combined.insert(combined.end(), leftRow->begin(), leftRow->end());
+        } else {
+            combined.resize(leftTable->columns.size(), NullValue{});
+        }
+        if (rightRow) {
+            combined.insert(combined.end(), rightRow->begin(), rightRow->end());
+        } else {
+            combined.resize(combinedCols.size(), NullValue{});
+        }
+        if (!sink.row(combined, colIndices)) return false;
+        if (++rowCount % Table::kRowGroupSize == 0 && CancellationToken::stopRequested()) return false;
+        return rowCount < maxRows;
+    };
+
+    // Joins one probe row against a build side; false once done.
+    // buildRow(b) returns build row b, or nullptr if the snapshot cannot
+    // see it (an index holds every row version).
+    auto probeOne = [&](const Row& probeRow, const HashIndex& index, auto&& buildRow) {
+        bool matched = false;
+        if (const std::vector<size_t>* matches = index.lookup(probeRow[probeJoinCol])) {
+            for (size_t b : *matches) {
+                const Row* row = buildRow(b);
+                if (!row) continue;
+                matched = true;
+                if (!(rightOuter ? emit(row, &probeRow) : emit(&probeRow, row))) return false;
+            }
+        }
+        if (matched) {
+            return true;
+        } else if (query.join.type == JoinType::LEFT) {
+            return emit(&probeRow, nullptr);
+        } else if (query.join.type == JoinType::RIGHT) {
+            return emit(nullptr, &probeRow);
+        }
+        return true;
+    };
+
+    bool more = true;
+    if (spilled) {
+        grace = std::make_unique<GraceJoin>(*buildTable, static_cast<size_t>(buildJoinCol),
+                                            static_cast<size_t>(probeJoinCol),
+                                            query.join.type != JoinType::INNER,
+            [&](const Row& probeRow, const HashIndex& index, const std::vector<Row>& rows) {
+                return probeOne(probeRow, index, [&rows](size_t b) { return &rows[b]; });
+            });
+        std::string error;
+        if (!grace->run(*probeTable, probed, more, error)) {
+            sink.error(error);
+            return false;
+        }
+    }
+    const Transaction& txn = Transaction::current();
+    auto visibleBuildRow = [&](size_t b) -> const Row* {
+        return buildTable->isDeleted(b, txn) ? nullptr : &buildTable->rows[b];
+    };
+    for (size_t p = 0; !spilled && more && p < probeTable->rows.size(); ++p) {
+        if (p % Table::kRowGroupSize == 0) {
+            if (CancellationToken::stopRequested()) break;
+            if (p > 0 && buildLatch.owns_lock()) {
+                buildLatch.unlock();
+                buildLatch.lock();
+            }
+        }
+        if (!skippedGroups.empty() && skippedGroups[p / Table::kRowGroupSize]) {
+            p += Table::kRowGroupSize - 1 - p % Table::kRowGroupSize;
+            continue;
         }
-        std::cout << "\n";
-        ++rowCount;
+        if (probeTable->isDeleted(p, txn)) continue;
+        ++probed;
+        more = probeOne(probeTable->rows[p], *buildIndex, visibleBuildRow);
     }
+    if (buildLatch.owns_lock()) buildLatch.unlock();
 
-    std::cout << rowCount << " row(s) returned.\n";
+    sink.end();
+    Metrics::addRows(probed + (transientIndex ? buildTable->liveRowCount() : 0), rowCount);
+    if (transientIndex) Metrics::addBytes(transientIndex->memoryBytes());
+    if (plan) describe();
+    return true;
 }
 
 } // namespace nanodb
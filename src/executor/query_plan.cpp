@@ -0,0 +1,78 @@
+#include "nanodb/executor/query_plan.hpp"
+
+#include <cstdio>
+
+namespace nanodb {
+
+namespace {
+
+std::string describeValue(const Value& v) {
+    if (std::holds_alternative<int>(v)) return std::to_string(std::get<int>(v));
+    if (std::holds_alternative<std::string>(v)) return "'" + std::get<std::string>(v) + "'";
+    return "NULL";
+}
+
+const char* describeOp(CompareOp op) {
+    switch (op) {
+        case CompareOp::EQ: return " = ";
+        case CompareOp::NE: return " != ";
+        case CompareOp::LT: return " < ";
+        case CompareOp::LE: return " <= ";
+        case CompareOp::GT: return " > ";
+        case CompareOp::GE: return " >= ";
+        case CompareOp::IN: return " IN ";
+    }
+    return " ? ";
+}
+
+void renderNode(const PlanNode& node, bool analyze, size_t depth, std::vector<std::string>& lines) {
+    std::string indent(depth == 0 ? 0 : depth * 5 - 3, ' ');
+    std::string line = indent + (depth == 0 ? "" : "-> ") + node.name;
+    if (analyze) {
+        char stats[128];
+        std::snprintf(stats, sizeof(stats), "  (rows in=%zu out=%zu, time=%.3f ms, memory=%s)",
+                      node.rowsIn, node.rowsOut, node.millis, describeBytes(node.memoryBytes).c_str());
+        line += stats;
+    }
+    lines.push_back(line);
+
+    std::string detailIndent(depth == 0 ? 2 : depth * 5 + 2, ' ');
+    for (const auto& detail : node.details) {
+        lines.push_back(detailIndent + detail);
+    }
+    for (const auto& child : node.children) {
+        renderNode(child, analyze, depth + 1, lines);
+    }
+}
+
+} // namespace
+
+std::vector<std::string> QueryPlan::render() const {
+    std::vector<std::string> lines;
+    renderNode(root, analyze, 0, lines);
+    return lines;
+}
+
+std::string describeWhere(const WhereClause& where) {
+    std::string text;
+    for (size_t i = 0; i < where.conditions.size(); ++i) {
+        if (i > 0 && i - 1 < where.logicalOps.size()) {
+            text += where.logicalOps[i - 1] == LogicalOp::AND ? " AND " : " OR ";
+        }
+        const Condition& cond = where.conditions[i];
+        text += cond.column + describeOp(cond.op);
+        if (cond.op == CompareOp::IN) {
+            text += "(";
+            for (size_t v = 0; v < cond.inValues.size(); ++v) {
+                if (v > 0) text += ", ";
+                text += describeValue(cond.inValues[v]);
+            }
+            text += ")";
+        } else {
+            text += describeValue(cond.value);
+        }
+    }
+    return text;
+}
+
+} // namespace nanodb
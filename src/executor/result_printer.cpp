@@ -0,0 +1,261 @@
+#include "nanodb/executor/result_printer.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace nanodb {
+
+namespace {
+
+const char kNull[] = "NULL";
+
+void appendInt(std::string& s, int value) {
+    char digits[16];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    (void)ec;
+    s.append(digits, static_cast<size_t>(end - digits));
+}
+
+void writePadding(BufferedWriter& out, size_t n) {
+    static const std::string spaces(64, ' ');
+    while (n > 0) {
+        size_t chunk = std::min(n, spaces.size());
+        out.write(std::string_view(spaces).substr(0, chunk));
+        n -= chunk;
+    }
+}
+
+} // namespace
+
+ResultPrinter::ResultPrinter(BufferedWriter& out, OutputMode mode, std::ostream& messages, bool header,
+                             char delimiter)
+    : out_(out), messages_(messages), mode_(mode), header_(header),
+      delimiter_(mode == OutputMode::TSV ? '\t' : delimiter) {}
+
+void ResultPrinter::begin(const std::vector<Column>& columns, bool) {
+    columns_ = columns;
+    rowCount_ = 0;
+
+    switch (mode_) {
+        case OutputMode::TABLE:
+            widths_.assign(columns.size(), 0);
+            for (size_t i = 0; i < columns.size(); ++i) {
+                widths_[i] = columns[i].name.size();
+            }
+            cells_.clear();
+            cellEnds_.clear();
+            widthsFixed_ = false;
+            break;
+        case OutputMode::CSV:
+        case OutputMode::TSV:
+            if (!header_) break;
+            for (size_t i = 0; i < columns.size(); ++i) {
+                if (i > 0) out_.put(delimiter_);
+                if (mode_ == OutputMode::CSV) {
+                    writeCsvField(columns[i].name);
+                } else {
+                    writeTsvField(columns[i].name);
+                }
+            }
+            out_.put('\n');
+            break;
+        case OutputMode::JSON:
+        case OutputMode::NONE:
+            break;
+    }
+}
+
+bool ResultPrinter::row(const Row& row, const std::vector<size_t>& projection) {
+    ++rowCount_;
+    switch (mode_) {
+        case OutputMode::TABLE:
+            bufferRow(row, projection);
+            if (widthsFixed_) {
+                writeTableRow(0);
+                cells_.clear();
+                cellEnds_.clear();
+            } else if (rowCount_ == kWidthSampleRows) {
+                flushTable();
+            }
+            break;
+        case OutputMode::CSV:
+        case OutputMode::TSV:
+            for (size_t i = 0; i < projection.size(); ++i) {
+                if (i > 0) out_.put(delimiter_);
+                const Value& v = row[projection[i]];
+                if (std::holds_alternative<int>(v)) {
+                    out_.writeInt(std::get<int>(v));
+                } else if (std::holds_alternative<std::string>(v)) {
+                    if (mode_ == OutputMode::CSV) {
+                        writeCsvField(std::get<std::string>(v));
+                    } else {
+                        writeTsvField(std::get<std::string>(v));
+                    }
+                } else if (mode_ == OutputMode::TSV) {
+                    out_.write("\\N");
+                }
+            }
+            out_.put('\n');
+            break;
+        case OutputMode::JSON:
+            out_.put('{');
+            for (size_t i = 0; i < projection.size(); ++i) {
+                if (i > 0) out_.write(", ");
+                writeJsonString(columns_[i].name);
+                out_.write(": ");
+                const Value& v = row[projection[i]];
+                if (std::holds_alternative<int>(v)) {
+                    out_.writeInt(std::get<int>(v));
+                } else if (std::holds_alternative<std::string>(v)) {
+                    writeJsonString(std::get<std::string>(v));
+                } else {
+                    out_.write("null");
+                }
+            }
+            out_.write("}\n");
+            break;
+        case OutputMode::NONE:
+            break;
+    }
+    return out_.ok();
+}
+
+void ResultPrinter::end() {
+    if (mode_ == OutputMode::TABLE) {
+        if (!widthsFixed_) flushTable();
+        out_.writeInt(static_cast<int64_t>(rowCount_));
+        out_.write(" row(s) returned.\n");
+    }
+    out_.flush();
+}
+
+void ResultPrinter::error(const std::string& message) {
+    // Rows already streamed stay ahead of the message; a table still
+    // measuring its column widths is dropped
+    out_.flush();
+    messages_ << "Error: " << message << "\n";
+}
+
+void ResultPrinter::bufferRow(const Row& row, const std::vector<size_t>& projection) {
+    for (size_t i = 0; i < projection.size(); ++i) {
+        const Value& v = row[projection[i]];
+        size_t start = cells_.size();
+        if (std::holds_alternative<int>(v)) {
+            appendInt(cells_, std::get<int>(v));
+        } else if (std::holds_alternative<std::string>(v)) {
+            cells_ += std::get<std::string>(v);
+        } else {
+            cells_ += kNull;
+        }
+        cellEnds_.push_back(static_cast<uint32_t>(cells_.size()));
+        if (!widthsFixed_) {
+            widths_[i] = std::max(widths_[i], cells_.size() - start);
+        }
+    }
+}
+
+void ResultPrinter::flushTable() {
+    widthsFixed_ = true;
+
+    // Header and separator
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (i > 0) out_.write(" | ");
+        writeAligned(i, columns_[i].name);
+    }
+    out_.put('\n');
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (i > 0) out_.write("-+-");
+        for (size_t w = 0; w < widths_[i]; ++w) out_.put('-');
+    }
+    out_.put('\n');
+
+    for (size_t cell = 0; cell < cellEnds_.size(); cell += columns_.size()) {
+        writeTableRow(cell);
+    }
+    cells_.clear();
+    cellEnds_.clear();
+}
+
+void ResultPrinter::writeTableRow(size_t firstCell) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        size_t cell = firstCell + i;
+        size_t start = cell == 0 ? 0 : cellEnds_[cell - 1];
+        if (i > 0) out_.write(" | ");
+        writeAligned(i, std::string_view(cells_.data() + start, cellEnds_[cell] - start));
+    }
+    out_.put('\n');
+}
+
+void ResultPrinter::writeAligned(size_t column, std::string_view text) {
+    size_t pad = text.size() < widths_[column] ? widths_[column] - text.size() : 0;
+    if (columns_[column].type == ColumnType::INT) {
+        writePadding(out_, pad);
+        out_.write(text);
+    } else {
+        out_.write(text);
+        // No trailing blanks at the end of a line
+        if (column + 1 < columns_.size()) writePadding(out_, pad);
+    }
+}
+
+void ResultPrinter::writeCsvField(const std::string& s) {
+    // Empty strings are quoted so they read back as "" rather than NULL
+    bool quote = s.empty();
+    for (char c : s) {
+        if (c == delimiter_ || c == '"' || c == '\n' || c == '\r') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) {
+        out_.write(s);
+        return;
+    }
+    out_.put('"');
+    size_t start = 0;
+    for (size_t q = s.find('"'); q != std::string::npos; q = s.find('"', start)) {
+        out_.write(std::string_view(s).substr(start, q + 1 - start));
+        out_.put('"');
+        start = q + 1;
+    }
+    out_.write(std::string_view(s).substr(start));
+    out_.put('"');
+}
+
+void ResultPrinter::writeTsvField(const std::string& s) {
+    for (char c : s) {
+        switch (c) {
+            case '\t': out_.write("\\t"); break;
+            case '\n': out_.write("\\n"); break;
+            case '\r': out_.write("\\r"); break;
+            case '\\': out_.write("\\\\"); break;
+            default: out_.put(c); break;
+        }
+    }
+}
+
+void ResultPrinter::writeJsonString(const std::string& s) {
+    static const char kHex[] = "0123456789abcdef";
+    out_.put('"');
+    for (char c : s) {
+        switch (c) {
+            case '"': out_.write("\\\""); break;
+            case '\\': out_.write("\\\\"); break;
+            case '\n': out_.write("\\n"); break;
+            case '\r': out_.write("\\r"); break;
+            case '\t': out_.write("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out_.write("\\u00");
+                    out_.put(kHex[(c >> 4) & 0xF]);
+                    out_.put(kHex[c & 0xF]);
+                } else {
+                    out_.put(c);
+                }
+                break;
+        }
+    }
+    out_.put('"');
+}
+
+} // namespace nanodb
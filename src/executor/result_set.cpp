@@ -0,0 +1,99 @@
+#include "nanodb/executor/result_set.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+namespace {
+
+const std::string& emptyString() {
+    static const std::string empty;
+    return empty;
+}
+
+} // namespace
+
+const Value& RowBatch::value(size_t row, size_t column) const {
+    return result_->value(first_ + row, column);
+}
+
+bool RowBatch::isNull(size_t row, size_t column) const {
+    return result_->isNull(first_ + row, column);
+}
+
+int RowBatch::getInt(size_t row, size_t column) const {
+    return result_->getInt(first_ + row, column);
+}
+
+const std::string& RowBatch::getString(size_t row, size_t column) const {
+    return result_->getString(first_ + row, column);
+}
+
+int ResultSet::columnIndex(const std::string& name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int ResultSet::getInt(size_t row, size_t column) const {
+    const Value& v = value(row, column);
+    return std::holds_alternative<int>(v) ? std::get<int>(v) : 0;
+}
+
+const std::string& ResultSet::getString(size_t row, size_t column) const {
+    const Value& v = value(row, column);
+    return std::holds_alternative<std::string>(v) ? std::get<std::string>(v) : emptyString();
+}
+
+bool ResultSet::next() {
+    if (!started_) {
+        started_ = true;
+        cursor_ = 0;
+    } else if (cursor_ < rows_.size()) {
+        ++cursor_;
+    }
+    return cursor_ < rows_.size();
+}
+
+RowBatch ResultSet::nextBatch(size_t maxRows) {
+    size_t first = batchStart_;
+    size_t size = std::min(maxRows, rows_.size() - first);
+    batchStart_ += size;
+    return RowBatch(this, first, size);
+}
+
+void ResultSet::begin(const std::vector<Column>& columns, bool stableRows) {
+    columns_ = columns;
+    stableRows_ = stableRows && borrowRows_;
+    rows_.clear();
+    owned_.clear();
+    projection_.clear();
+    error_.clear();
+    rewind();
+    batchStart_ = 0;
+}
+
+bool ResultSet::row(const Row& row, const std::vector<size_t>& projection) {
+    if (stableRows_) {
+        if (projection_.empty()) projection_ = projection;
+        rows_.push_back(&row);
+        return true;
+    }
+
+    // Keep only the projected values of rows that will not outlive the call
+    if (projection_.empty()) {
+        projection_.resize(projection.size());
+        for (size_t i = 0; i < projection_.size(); ++i) projection_[i] = i;
+    }
+    Row copy;
+    copy.reserve(projection.size());
+    for (size_t idx : projection) copy.push_back(row[idx]);
+    owned_.push_back(std::move(copy));
+    rows_.push_back(&owned_.back());
+    return true;
+}
+
+} // namespace nanodb
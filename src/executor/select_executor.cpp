@@ -1,10 +1,11 @@
 #include "nanodb/executor/select_executor.hpp"
+#include "nanodb/core/cancellation.hpp"
+#include "nanodb/core/memory.hpp"
+#include "nanodb/core/metrics.hpp"
 
-#include <iostream>
-#include <iomanip>
 #include <algorithm>
+#include <cstdint>
 #include <set>
-#include <type_traits>
 
 namespace nanodb {
 
@@ -28,6 +29,13 @@ bool SelectExecutor::evaluateSingleCondition(const Row& row, const Table& table,
     const Value& rowVal = row[colIdx];
     const Value& condVal = cond.value;
 
+    if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) {
+            if (!isNull(v) && rowVal == v) return true;
+        }
+        return false;
+    }
+
     if (std::holds_alternative<int>(rowVal) && std::holds_alternative<int>(condVal)) {
         int rv = std::get<int>(rowVal);
         int cv = std::get<int>(condVal);
@@ -38,6 +46,7 @@ bool SelectExecutor::evaluateSingleCondition(const Row& row, const Table& table,
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     } else if (std::holds_alternative<std::string>(rowVal) && std::holds_alternative<std::string>(condVal)) {
         const std::string& rv = std::get<std::string>(rowVal);
@@ -49,6 +58,7 @@ bool SelectExecutor::evaluateSingleCondition(const Row& row, const Table& table,
             case CompareOp::LE: return rv <= cv;
             case CompareOp::GT: return rv > cv;
             case CompareOp::GE: return rv >= cv;
+            case CompareOp::IN: break;
         }
     }
 
@@ -74,11 +84,12 @@ bool SelectExecutor::evaluateWhereClause(const Row& row, const Table& table, con
     return result;
 }
 
-void SelectExecutor::execute(const SelectQuery& query) {
+bool SelectExecutor::execute(const SelectQuery& query, RowSink& sink, QueryPlan* plan) {
+    Stopwatch clock;
     const Table* table = catalog_.getTable(query.tableName);
     if (!table) {
-        std::cout << "Error: Table '" << query.tableName << "' does not exist.\n";
-        return;
+        sink.error("Table '" + query.tableName + "' does not exist.");
+        return false;
     }
 
     // Determine which columns to display
@@ -91,31 +102,184 @@ void SelectExecutor::execute(const SelectQuery& query) {
         for (const auto& colName : query.selectColumns) {
             int idx = findColumnIndex(*table, colName);
             if (idx < 0) {
-                std::cout << "Error: Column '" << colName << "' not found.\n";
-                return;
+                sink.error("Column '" + colName + "' not found.");
+                return false;
             }
             colIndices.push_back(static_cast<size_t>(idx));
         }
     }
 
-    // Collect matching rows
-    std::vector<const Row*> matchingRows;
-    for (const auto& row : table->rows) {
-        if (evaluateWhereClause(row, *table, query.where)) {
-            matchingRows.push_back(&row);
+    // Columns the query touches, to find an index that covers all of them
+    std::vector<std::string> referenced;
+    for (size_t idx : colIndices) {
+        referenced.push_back(table->columns[idx].name);
+    }
+    for (const auto& cond : query.where.conditions) {
+        referenced.push_back(cond.column);
+    }
+    if (query.orderBy.hasOrderBy) {
+        referenced.push_back(query.orderBy.column);
+    }
+
+    // schema describes the layout of the rows the scan yields: the table
+    // itself, or the covered columns of an index for an index-only scan
+    const Table* schema = table;
+    bool presorted = false;
+    IndexOnlyPlan indexOnly;
+    bool useIndexOnly = AccessPath::chooseIndexOnly(catalog_, *table, referenced, query.where,
+                                                    &query.orderBy, indexOnly);
+    if (useIndexOnly) {
+        schema = &indexOnly.index->schema();
+        presorted = indexOnly.ordered;
+        for (size_t& idx : colIndices) {
+            idx = static_cast<size_t>(findColumnIndex(*schema, table->columns[idx].name));
         }
     }
 
-    // Apply ORDER BY
-    if (query.orderBy.hasOrderBy) {
-        int sortColIdx = findColumnIndex(*table, query.orderBy.column);
+    bool needSort = query.orderBy.hasOrderBy && !presorted;
+    int sortColIdx = -1;
+    if (needSort) {
+        sortColIdx = findColumnIndex(*schema, query.orderBy.column);
         if (sortColIdx < 0) {
-            std::cout << "Error: Column '" << query.orderBy.column << "' not found.\n";
-            return;
+            sink.error("Column '" + query.orderBy.column + "' not found.");
+            return false;
+        }
+    }
+
+    ScanPlan scanPlan;
+    if (!useIndexOnly) {
+        scanPlan = AccessPath::choose(catalog_, *table, query.where);
+    }
+
+    // Operator counters for EXPLAIN ANALYZE
+    size_t scanned = 0, matched = 0, sorted = 0, emitted = 0, distinctRows = 0;
+    size_t distinctBytes = 0;
+    double scanMs = 0, sortMs = 0;
+
+    std::vector<const Row*> matchingRows;
+    auto describe = [&]() {
+        PlanNode node = useIndexOnly ? AccessPath::describe(*table, indexOnly)
+                                     : AccessPath::describe(*table, scanPlan);
+        if (query.where.hasWhere) node.details.push_back("Filter: " + describeWhere(query.where));
+        node.rowsIn = scanned;
+        node.rowsOut = matched;
+        node.millis = scanMs;
+        if (needSort) {
+            PlanNode sort;
+            sort.name = "Sort";
+            sort.details.push_back("Key: " + query.orderBy.column +
+                                   (query.orderBy.order == SortOrder::ASC ? " ASC" : " DESC"));
+            sort.rowsIn = matched;
+            sort.rowsOut = sorted;
+            sort.millis = sortMs;
+            sort.memoryBytes = matchingRows.capacity() * sizeof(const Row*);
+            sort.children.push_back(std::move(node));
+            node = std::move(sort);
+        }
+        if (query.distinct) {
+            PlanNode distinct;
+            distinct.name = "Distinct";
+            distinct.rowsIn = emitted;
+            distinct.rowsOut = distinctRows;
+            distinct.millis = clock.elapsedMs();
+            distinct.memoryBytes = distinctBytes;
+            distinct.children.push_back(std::move(node));
+            node = std::move(distinct);
+        }
+        if (query.limit > 0) {
+            PlanNode limit;
+            limit.name = "Limit " + std::to_string(query.limit);
+            limit.rowsIn = query.distinct ? distinctRows : emitted;
+            limit.rowsOut = std::min(limit.rowsIn, static_cast<size_t>(query.limit));
+            limit.millis = clock.elapsedMs();
+            limit.children.push_back(std::move(node));
+            node = std::move(limit);
         }
+        plan->root = std::move(node);
+    };
+    if (plan && !plan->analyze) {
+        describe();
+        return true;
+    }
+
+    std::vector<Column> columns;
+    for (size_t idx : colIndices) {
+        columns.push_back(schema->columns[idx]);
+    }
+    sink.begin(columns, true);
 
+    // The sort buffer and DISTINCT set are charged against the memory limit
+    MemoryReservation memory;
+    bool overLimit = false;
+    auto charge = [&]() {
+        overLimit = !memory.fits(matchingRows.capacity() * sizeof(const Row*) + distinctBytes);
+        return !overLimit;
+    };
+
+    // Applies DISTINCT and LIMIT to rows in final order; false once done
+    size_t maxRows = (query.limit > 0) ? static_cast<size_t>(query.limit) : SIZE_MAX;
+    size_t rowCount = 0;
+    std::set<std::vector<Value>> seen;
+    auto emit = [&](const Row& row) -> bool {
+        if (rowCount >= maxRows) return false;
+        ++emitted;
+        if (query.distinct) {
+            std::vector<Value> key;
+            for (size_t idx : colIndices) {
+                key.push_back(row[idx]);
+            }
+            size_t keyBytes = approxRowBytes(key) + kTreeNodeBytes;
+            if (!seen.insert(std::move(key)).second) return true;
+            distinctBytes += keyBytes;
+            ++distinctRows;
+            if (!charge()) return false;
+        }
+        if (!sink.row(row, colIndices)) return false;
+        return ++rowCount < maxRows;
+    };
+
+    // Without a sort, matching rows go to the sink as the scan finds them
+    auto accept = [&](const Row& row) -> bool {
+        ++matched;
+        if (needSort) {
+            matchingRows.push_back(&row);
+            return charge();
+        }
+        return emit(row);
+    };
+
+    if (useIndexOnly) {
+        bool descending = presorted && query.orderBy.order == SortOrder::DESC;
+        // Entries stay put once inserted, so matchingRows may point into the
+        // index after the latch is released
+        std::shared_lock<std::shared_mutex> latch(catalog_.indexLatch(table->name));
+        indexOnly.index->scan(indexOnly.range, descending, [&](const Row& covered, size_t rowId) {
+            if (table->isDeleted(rowId)) return true;
+            if (++scanned % Table::kRowGroupSize == 0 && CancellationToken::stopRequested()) return false;
+            if (!evaluateWhereClause(covered, *schema, query.where)) return true;
+            return accept(covered);
+        });
+    } else {
+        scanPlan.forEachRow(*table, [&](size_t rowId) {
+            ++scanned;
+            const Row& row = table->rows[rowId];
+            if (!evaluateWhereClause(row, *table, query.where)) return true;
+            return accept(row);
+        });
+    }
+    scanMs = clock.elapsedMs();
+    if (overLimit) {
+        sink.error(memoryLimitError());
+        return false;
+    }
+
+    // Apply ORDER BY; a cancelled scan leaves nothing worth sorting
+    if (needSort && !CancellationToken::stopRequested()) {
         std::sort(matchingRows.begin(), matchingRows.end(),
             [sortColIdx, &query](const Row* a, const Row* b) {
+                // DESC swaps the operands; negating the result would break
+                // std::sort's strict weak ordering on equal keys
+                if (query.orderBy.order == SortOrder::DESC) std::swap(a, b);
                 const Value& va = (*a)[sortColIdx];
                 const Value& vb = (*b)[sortColIdx];
 
@@ -126,65 +290,25 @@ void SelectExecutor::execute(const SelectQuery& query) {
                     less = std::get<std::string>(va) < std::get<std::string>(vb);
                 }
 
-                return query.orderBy.order == SortOrder::ASC ? less : !less;
+                return less;
             });
-    }
 
-    // Apply DISTINCT
-    std::vector<const Row*> resultRows;
-    if (query.distinct) {
-        std::set<std::vector<Value>> seen;
         for (const auto* row : matchingRows) {
-            std::vector<Value> key;
-            for (size_t idx : colIndices) {
-                key.push_back((*row)[idx]);
-            }
-            if (seen.find(key) == seen.end()) {
-                seen.insert(key);
-                resultRows.push_back(row);
-            }
+            ++sorted;
+            if (!emit(*row)) break;
         }
-    } else {
-        resultRows = matchingRows;
-    }
-
-    // Print header
-    for (size_t i = 0; i < colIndices.size(); ++i) {
-        std::cout << std::setw(15) << table->columns[colIndices[i]].name;
-        if (i < colIndices.size() - 1) std::cout << " | ";
-    }
-    std::cout << "\n";
-
-    // Print separator
-    for (size_t i = 0; i < colIndices.size(); ++i) {
-        std::cout << std::string(15, '-');
-        if (i < colIndices.size() - 1) std::cout << "-+-";
-    }
-    std::cout << "\n";
-
-    // Print rows (with LIMIT)
-    size_t rowCount = 0;
-    size_t maxRows = (query.limit > 0) ? static_cast<size_t>(query.limit) : resultRows.size();
-
-    for (const auto* row : resultRows) {
-        if (rowCount >= maxRows) break;
-
-        for (size_t i = 0; i < colIndices.size(); ++i) {
-            std::visit([](const auto& val) {
-                using T = std::decay_t<decltype(val)>;
-                if constexpr (std::is_same_v<T, NullValue>) {
-                    std::cout << std::setw(15) << "NULL";
-                } else {
-                    std::cout << std::setw(15) << val;
-                }
-            }, (*row)[colIndices[i]]);
-            if (i < colIndices.size() - 1) std::cout << " | ";
+        sortMs = clock.elapsedMs();
+        if (overLimit) {
+            sink.error(memoryLimitError());
+            return false;
         }
-        std::cout << "\n";
-        ++rowCount;
     }
 
-    std::cout << rowCount << " row(s) returned.\n";
+    sink.end();
+    Metrics::addRows(scanned, rowCount);
+    Metrics::addBytes(matchingRows.capacity() * sizeof(const Row*) + distinctBytes);
+    if (plan) describe();
+    return true;
 }
 
 } // namespace nanodb
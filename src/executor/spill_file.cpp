@@ -0,0 +1,199 @@
+#include "nanodb/executor/spill_file.hpp"
+#include "nanodb/core/memory.hpp"
+#include "nanodb/index/index.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace nanodb {
+
+namespace {
+
+uint32_t decodeU32(const char* p) {
+    uint32_t out = 0;
+    for (int i = 0; i < 4; ++i) {
+        out |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    }
+    return out;
+}
+
+} // namespace
+
+SpillFile::SpillFile() : out_(kBufferBytes) {}
+
+SpillFile::~SpillFile() {
+    out_.close();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool SpillFile::open(std::string& error) {
+    const char* dir = std::getenv("TMPDIR");
+    std::string path = std::string(dir && *dir ? dir : "/tmp") + "/nanodb-spill-XXXXXX";
+    fd_ = mkstemp(path.data());
+    if (fd_ < 0) {
+        error = "Cannot create spill file in '" + path.substr(0, path.rfind('/')) + "': " + std::strerror(errno);
+        return false;
+    }
+    unlink(path.c_str());
+    out_.attach(fd_);
+    return true;
+}
+
+void SpillFile::writeValue(const Value& v) {
+    if (std::holds_alternative<int>(v)) {
+        out_.writeU8(1);
+        out_.writeU32(static_cast<uint32_t>(std::get<int>(v)));
+        bytes_ += 5;
+    } else if (std::holds_alternative<std::string>(v)) {
+        const std::string& s = std::get<std::string>(v);
+        out_.writeU8(2);
+        out_.writeU32(static_cast<uint32_t>(s.size()));
+        out_.write(s);
+        bytes_ += 5 + s.size();
+    } else {
+        out_.writeU8(0);
+        bytes_ += 1;
+    }
+}
+
+void SpillFile::write(const Row& row) {
+    out_.writeU32(static_cast<uint32_t>(row.size()));
+    bytes_ += 4;
+    for (const auto& v : row) writeValue(v);
+    ++rows_;
+}
+
+void SpillFile::write(const Row& row, const std::vector<size_t>& projection) {
+    out_.writeU32(static_cast<uint32_t>(projection.size()));
+    bytes_ += 4;
+    for (size_t idx : projection) writeValue(row[idx]);
+    ++rows_;
+}
+
+bool SpillFile::finish(std::string& error) {
+    if (!out_.flush() || lseek(fd_, 0, SEEK_SET) != 0) {
+        ok_ = false;
+        error = std::string("Cannot write spill file: ") + std::strerror(errno);
+        return false;
+    }
+    in_.resize(kBufferBytes);
+    inPos_ = inEnd_ = 0;
+    return true;
+}
+
+bool SpillFile::fill(size_t n) {
+    if (inEnd_ - inPos_ >= n) return true;
+    // Keep the unread tail, then top up the buffer
+    std::memmove(in_.data(), in_.data() + inPos_, inEnd_ - inPos_);
+    inEnd_ -= inPos_;
+    inPos_ = 0;
+    if (n > in_.size()) in_.resize(n);
+    while (inEnd_ < n) {
+        ssize_t got = ::read(fd_, in_.data() + inEnd_, in_.size() - inEnd_);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) ok_ = false;
+        if (got <= 0) return false;
+        inEnd_ += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool SpillFile::read(Row& row) {
+    if (!fill(4)) return false;
+    // Running out of data inside a row means the file is damaged
+    auto truncated = [this] {
+        ok_ = false;
+        return false;
+    };
+    uint32_t count = decodeU32(in_.data() + inPos_);
+    inPos_ += 4;
+    row.clear();
+    row.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!fill(1)) return truncated();
+        uint8_t tag = static_cast<uint8_t>(in_[inPos_++]);
+        if (tag == 0) {
+            row.emplace_back(NullValue{});
+            continue;
+        }
+        if (!fill(4)) return truncated();
+        uint32_t word = decodeU32(in_.data() + inPos_);
+        inPos_ += 4;
+        if (tag == 1) {
+            row.emplace_back(static_cast<int>(word));
+        } else {
+            if (!fill(word)) return truncated();
+            row.emplace_back(std::string(in_.data() + inPos_, word));
+            inPos_ += word;
+        }
+    }
+    return true;
+}
+
+bool SpillPartitions::open(size_t level, std::string& error) {
+    level_ = level;
+    files_.clear();
+    for (size_t i = 0; i < kFanout; ++i) {
+        files_.push_back(std::make_unique<SpillFile>());
+        if (!files_.back()->open(error)) return false;
+    }
+    return true;
+}
+
+size_t SpillPartitions::partitionOf(const Row& row, const std::vector<size_t>& keyColumns) const {
+    uint64_t h = 0x9e3779b97f4a7c15ULL * (level_ + 1);
+    for (size_t col : keyColumns) {
+        h = (h ^ hashValue(row[col])) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    // Each level draws on different hash bits
+    return static_cast<size_t>(h >> (60 - 4 * level_)) % kFanout;
+}
+
+void SpillPartitions::add(const Row& row, const std::vector<size_t>& keyColumns) {
+    files_[partitionOf(row, keyColumns)]->write(row);
+}
+
+void SpillPartitions::add(const Row& row, const std::vector<size_t>& keyColumns,
+                          const std::vector<size_t>& projection) {
+    files_[partitionOf(row, keyColumns)]->write(row, projection);
+}
+
+bool SpillPartitions::finish(std::string& error) {
+    for (auto& file : files_) {
+        if (!file->finish(error)) return false;
+    }
+    return true;
+}
+
+size_t SpillPartitions::rows() const {
+    size_t total = 0;
+    for (const auto& file : files_) total += file->rows();
+    return total;
+}
+
+uint64_t SpillPartitions::bytes() const {
+    uint64_t total = 0;
+    for (const auto& file : files_) total += file->bytes();
+    return total;
+}
+
+void SpillStats::add(const SpillPartitions& p) {
+    partitions += SpillPartitions::kFanout;
+    maxLevel = std::max(maxLevel, p.level());
+    rows += p.rows();
+    bytes += p.bytes();
+}
+
+std::string SpillStats::describe() const {
+    std::string text = "Spilled: " + std::to_string(partitions) + " partitions, " + std::to_string(rows) +
+                       " rows, " + describeBytes(static_cast<size_t>(bytes));
+    if (maxLevel > 0) text += ", " + std::to_string(maxLevel + 1) + " levels";
+    return text;
+}
+
+} // namespace nanodb
@@ -0,0 +1,83 @@
+#include "nanodb/index/bitmap_index.hpp"
+#include "nanodb/core/memory.hpp"
+
+namespace nanodb {
+
+BitmapIndex::BitmapIndex(const std::string& name, const std::string& tableName,
+                         const std::string& column, size_t columnIndex)
+    : Index(IndexType::BITMAP, name, tableName, column, columnIndex)
+{}
+
+void BitmapIndex::insert(const Row& row, size_t rowId) {
+    bitmaps_[row[columnIndex()]].add(static_cast<uint32_t>(rowId));
+}
+
+void BitmapIndex::remove(const Row& row, size_t rowId) {
+    auto it = bitmaps_.find(row[columnIndex()]);
+    if (it == bitmaps_.end()) return;
+    it->second.remove(static_cast<uint32_t>(rowId));
+    if (it->second.empty()) {
+        bitmaps_.erase(it);
+    }
+}
+
+void BitmapIndex::clear() {
+    bitmaps_.clear();
+}
+
+size_t BitmapIndex::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& [key, bitmap] : bitmaps_) {
+        bytes += kTreeNodeBytes + sizeof(Value) + sizeof(RoaringBitmap) + bitmap.memoryBytes();
+        if (std::holds_alternative<std::string>(key) && std::get<std::string>(key).capacity() > 15) {
+            bytes += std::get<std::string>(key).capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+const RoaringBitmap* BitmapIndex::lookup(const Value& key) const {
+    auto it = bitmaps_.find(key);
+    return it != bitmaps_.end() ? &it->second : nullptr;
+}
+
+bool BitmapIndex::keyMatches(const Value& key, const Condition& cond) {
+    if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) {
+            if (!isNull(v) && key == v) return true;
+        }
+        return false;
+    }
+
+    // Only values of the same type compare; NULL never matches
+    if (isNull(key) || key.index() != cond.value.index()) return false;
+
+    switch (cond.op) {
+        case CompareOp::EQ: return key == cond.value;
+        case CompareOp::NE: return !(key == cond.value);
+        case CompareOp::LT: return key < cond.value;
+        case CompareOp::LE: return !(cond.value < key);
+        case CompareOp::GT: return cond.value < key;
+        case CompareOp::GE: return !(key < cond.value);
+        case CompareOp::IN: break;
+    }
+    return false;
+}
+
+RoaringBitmap BitmapIndex::match(const Condition& cond) const {
+    if (cond.op == CompareOp::EQ) {
+        const RoaringBitmap* rows = lookup(cond.value);
+        return (rows && !isNull(cond.value)) ? *rows : RoaringBitmap();
+    }
+
+    // Few distinct keys by design, so testing each one is cheap
+    RoaringBitmap result;
+    for (const auto& [key, rows] : bitmaps_) {
+        if (keyMatches(key, cond)) {
+            result = RoaringBitmap::unite(result, rows);
+        }
+    }
+    return result;
+}
+
+} // namespace nanodb
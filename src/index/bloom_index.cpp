@@ -0,0 +1,66 @@
+#include "nanodb/index/bloom_index.hpp"
+
+namespace nanodb {
+
+BloomIndex::BloomIndex(const std::string& name, const std::string& tableName,
+                       const std::string& column, size_t columnIndex)
+    : Index(IndexType::BLOOM, name, tableName, column, columnIndex)
+{}
+
+size_t BloomIndex::blockOf(uint64_t hash) {
+    // Multiply-shift maps the high hash bits onto [0, kBlocks) without a modulo
+    return static_cast<size_t>(((hash >> 32) * kBlocks) >> 32);
+}
+
+void BloomIndex::insert(const Row& row, size_t rowId) {
+    size_t group = rowId / Table::kRowGroupSize;
+    if (group >= filters_.size()) {
+        filters_.resize(group + 1);
+    }
+    std::vector<uint64_t>& filter = filters_[group];
+    if (filter.empty()) {
+        filter.assign(kBlocks * kBlockWords, 0);
+    }
+
+    uint64_t hash = hashValue(row[columnIndex()]);
+    uint64_t* block = &filter[blockOf(hash) * kBlockWords];
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 16) | 1;
+    for (int i = 0; i < kProbes; ++i) {
+        uint32_t bit = (h1 + i * h2) & 511;
+        block[bit >> 6] |= uint64_t{1} << (bit & 63);
+    }
+}
+
+void BloomIndex::remove(const Row&, size_t) {
+    // Bloom filters cannot forget a key; stale bits only cost false
+    // positives until compaction rebuilds the filters from live rows
+}
+
+void BloomIndex::clear() {
+    filters_.clear();
+}
+
+size_t BloomIndex::memoryBytes() const {
+    size_t bytes = filters_.capacity() * sizeof(std::vector<uint64_t>);
+    for (const auto& filter : filters_) {
+        bytes += filter.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+bool BloomIndex::mayContain(size_t group, const Value& key) const {
+    if (group >= filters_.size() || filters_[group].empty()) return false;
+
+    uint64_t hash = hashValue(key);
+    const uint64_t* block = &filters_[group][blockOf(hash) * kBlockWords];
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 16) | 1;
+    for (int i = 0; i < kProbes; ++i) {
+        uint32_t bit = (h1 + i * h2) & 511;
+        if (!(block[bit >> 6] & (uint64_t{1} << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+} // namespace nanodb
@@ -0,0 +1,131 @@
+#include "nanodb/index/hash_index.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+HashIndex::HashIndex(const std::string& name, const std::string& tableName,
+                     const std::string& column, size_t columnIndex)
+    : Index(IndexType::HASH, name, tableName, column, columnIndex)
+{}
+
+size_t HashIndex::findSlot(const Value& key, uint64_t hash) const {
+    size_t mask = slots_.size() - 1;
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t pos = hash & mask;
+    while (true) {
+        const Slot& slot = slots_[pos];
+        if (slot.entry == kEmpty) return pos;
+        if (slot.tag == tag && entries_[slot.entry].key == key) return pos;
+        pos = (pos + 1) & mask;
+    }
+}
+
+void HashIndex::grow() {
+    size_t newSize = slots_.empty() ? 16 : slots_.size() * 2;
+    slots_.assign(newSize, Slot{});
+    size_t mask = newSize - 1;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        size_t pos = entries_[i].hash & mask;
+        while (slots_[pos].entry != kEmpty) {
+            pos = (pos + 1) & mask;
+        }
+        slots_[pos].entry = static_cast<uint32_t>(i);
+        slots_[pos].tag = static_cast<uint32_t>(entries_[i].hash >> 32);
+    }
+}
+
+void HashIndex::eraseEntry(size_t slot) {
+    size_t mask = slots_.size() - 1;
+    uint32_t entryIdx = slots_[slot].entry;
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (slots_[next].entry != kEmpty) {
+        size_t home = entries_[slots_[next].entry].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots_[hole] = Slot{};
+
+    // Keep entries_ dense: move the last entry into the freed position
+    size_t last = entries_.size() - 1;
+    if (entryIdx != last) {
+        size_t lastSlot = findSlot(entries_[last].key, entries_[last].hash);
+        slots_[lastSlot].entry = entryIdx;
+        entries_[entryIdx] = std::move(entries_[last]);
+    }
+    entries_.pop_back();
+}
+
+void HashIndex::insert(const Row& row, size_t rowId) {
+    const Value& key = row[columnIndex()];
+    uint64_t hash = hashValue(key);
+
+    if ((entries_.size() + 1) * 2 > slots_.size()) {
+        grow();
+    }
+
+    size_t pos = findSlot(key, hash);
+    if (slots_[pos].entry == kEmpty) {
+        slots_[pos].entry = static_cast<uint32_t>(entries_.size());
+        slots_[pos].tag = static_cast<uint32_t>(hash >> 32);
+        entries_.push_back({key, hash, {rowId}});
+        return;
+    }
+
+    // Posting lists stay sorted so index scans visit rows in table order
+    std::vector<size_t>& rowIds = entries_[slots_[pos].entry].rowIds;
+    if (rowIds.empty() || rowIds.back() < rowId) {
+        rowIds.push_back(rowId);
+    } else {
+        rowIds.insert(std::upper_bound(rowIds.begin(), rowIds.end(), rowId), rowId);
+    }
+}
+
+void HashIndex::remove(const Row& row, size_t rowId) {
+    if (slots_.empty()) return;
+
+    const Value& key = row[columnIndex()];
+    size_t pos = findSlot(key, hashValue(key));
+    if (slots_[pos].entry == kEmpty) return;
+
+    std::vector<size_t>& rowIds = entries_[slots_[pos].entry].rowIds;
+    auto it = std::lower_bound(rowIds.begin(), rowIds.end(), rowId);
+    if (it == rowIds.end() || *it != rowId) return;
+    rowIds.erase(it);
+
+    if (rowIds.empty()) {
+        eraseEntry(pos);
+    }
+}
+
+void HashIndex::clear() {
+    slots_.clear();
+    entries_.clear();
+}
+
+const std::vector<size_t>* HashIndex::lookup(const Value& key) const {
+    if (slots_.empty()) return nullptr;
+    size_t pos = findSlot(key, hashValue(key));
+    if (slots_[pos].entry == kEmpty) return nullptr;
+    return &entries_[slots_[pos].entry].rowIds;
+}
+
+size_t HashIndex::keyOverheadBytes() {
+    return sizeof(Entry) + 2 * sizeof(Slot);
+}
+
+size_t HashIndex::memoryBytes() const {
+    size_t bytes = slots_.capacity() * sizeof(Slot) + entries_.capacity() * sizeof(Entry);
+    for (const auto& entry : entries_) {
+        bytes += entry.rowIds.capacity() * sizeof(size_t);
+    }
+    return bytes;
+}
+
+} // namespace nanodb
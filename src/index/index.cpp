@@ -0,0 +1,53 @@
+#include "nanodb/index/index.hpp"
+
+#include <functional>
+#include <type_traits>
+
+namespace nanodb {
+
+namespace {
+
+// splitmix64 finalizer: spreads sequential ints across the whole hash range
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
+uint64_t hashValue(const Value& v) {
+    return std::visit([](const auto& val) -> uint64_t {
+        using T = std::decay_t<decltype(val)>;
+        if constexpr (std::is_same_v<T, NullValue>) {
+            return 0x9e3779b97f4a7c15ULL;
+        } else if constexpr (std::is_same_v<T, int>) {
+            return mix(static_cast<uint64_t>(static_cast<uint32_t>(val)));
+        } else {
+            return mix(std::hash<std::string>{}(val) ^ 0x5bd1e995ULL);
+        }
+    }, v);
+}
+
+Index::Index(IndexType type, const std::string& name, const std::string& tableName,
+             const std::string& column, size_t columnIndex)
+    : type_(type)
+    , name_(name)
+    , tableName_(tableName)
+    , column_(column)
+    , columnIndex_(columnIndex)
+{}
+
+void Index::rebuild(const Table& table) {
+    clear();
+    // Every version, visible to someone or not: snapshots differ in which
+    // they see, and scans filter by visibility anyway
+    for (size_t i = 0; i < table.rows.size(); ++i) {
+        insert(table.rows[i], i);
+    }
+}
+
+} // namespace nanodb
@@ -0,0 +1,144 @@
+#include "nanodb/index/ordered_index.hpp"
+#include "nanodb/core/memory.hpp"
+
+#include <climits>
+
+namespace nanodb {
+
+OrderedIndex::OrderedIndex(const std::string& name, const Table& table, size_t columnIndex,
+                           const std::vector<size_t>& includeColumns)
+    : Index(IndexType::ORDERED, name, table.name, table.columns[columnIndex].name, columnIndex)
+{
+    sourceColumns_.push_back(columnIndex);
+    for (size_t col : includeColumns) {
+        if (col != columnIndex) sourceColumns_.push_back(col);
+    }
+    schema_.name = table.name;
+    for (size_t col : sourceColumns_) {
+        schema_.columns.push_back(table.columns[col]);
+    }
+}
+
+Row OrderedIndex::project(const Row& row) const {
+    Row covered;
+    covered.reserve(sourceColumns_.size());
+    for (size_t col : sourceColumns_) {
+        covered.push_back(row[col]);
+    }
+    return covered;
+}
+
+void OrderedIndex::insert(const Row& row, size_t rowId) {
+    entries_.insert(Entry{project(row), rowId});
+}
+
+void OrderedIndex::remove(const Row& row, size_t rowId) {
+    Entry probe{Row{row[columnIndex()]}, rowId};
+    entries_.erase(probe);
+}
+
+void OrderedIndex::clear() {
+    entries_.clear();
+}
+
+size_t OrderedIndex::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : entries_) {
+        bytes += kTreeNodeBytes + sizeof(Entry) - sizeof(Row) + approxRowBytes(entry.covered);
+    }
+    return bytes;
+}
+
+bool OrderedIndex::dependsOn(size_t columnIndex) const {
+    for (size_t col : sourceColumns_) {
+        if (col == columnIndex) return true;
+    }
+    return false;
+}
+
+bool OrderedIndex::covers(const std::string& column) const {
+    for (const auto& col : schema_.columns) {
+        if (col.name == column) return true;
+    }
+    return false;
+}
+
+void OrderedIndex::addRange(const KeyRange& range, RoaringBitmap& out, size_t typeIndex) const {
+    scan(range, false, [&](const Row& covered, size_t rowId) {
+        if (covered[0].index() == typeIndex) {
+            out.add(static_cast<uint32_t>(rowId));
+        }
+        return true;
+    });
+}
+
+RoaringBitmap OrderedIndex::match(const Condition& cond) const {
+    RoaringBitmap out;
+
+    if (cond.op == CompareOp::IN) {
+        for (const auto& v : cond.inValues) {
+            if (isNull(v)) continue;
+            addRange(KeyRange{&v, true, &v, true}, out, v.index());
+        }
+        return out;
+    }
+
+    // Only values of the same type compare; NULL never matches. Keys are
+    // ordered by type first, so each type occupies one contiguous run.
+    const Value& v = cond.value;
+    if (isNull(v)) return out;
+    bool isInt = std::holds_alternative<int>(v);
+    Value typeMin = isInt ? Value(INT_MIN) : Value(std::string());
+    Value typeMax = INT_MAX;
+    const Value* upperEnd = isInt ? &typeMax : nullptr;  // Strings sort last
+
+    switch (cond.op) {
+        case CompareOp::EQ:
+            addRange(KeyRange{&v, true, &v, true}, out, v.index());
+            break;
+        case CompareOp::LT:
+            addRange(KeyRange{&typeMin, true, &v, false}, out, v.index());
+            break;
+        case CompareOp::LE:
+            addRange(KeyRange{&typeMin, true, &v, true}, out, v.index());
+            break;
+        case CompareOp::GT:
+            addRange(KeyRange{&v, false, upperEnd, true}, out, v.index());
+            break;
+        case CompareOp::GE:
+            addRange(KeyRange{&v, true, upperEnd, true}, out, v.index());
+            break;
+        case CompareOp::NE:
+            addRange(KeyRange{&typeMin, true, &v, false}, out, v.index());
+            addRange(KeyRange{&v, false, upperEnd, true}, out, v.index());
+            break;
+        case CompareOp::IN:
+            break;
+    }
+    return out;
+}
+
+bool OrderedIndex::minInt(const Table& table, int& out) const {
+    const Transaction& txn = Transaction::current();
+    for (auto it = entries_.lower_bound(Value(INT_MIN)); it != entries_.end(); ++it) {
+        if (!std::holds_alternative<int>(it->covered[0])) return false;
+        if (table.isDeleted(it->rowId, txn)) continue;
+        out = std::get<int>(it->covered[0]);
+        return true;
+    }
+    return false;
+}
+
+bool OrderedIndex::maxInt(const Table& table, int& out) const {
+    const Transaction& txn = Transaction::current();
+    for (auto it = entries_.upper_bound(Value(INT_MAX)); it != entries_.begin();) {
+        --it;
+        if (!std::holds_alternative<int>(it->covered[0])) return false;
+        if (table.isDeleted(it->rowId, txn)) continue;
+        out = std::get<int>(it->covered[0]);
+        return true;
+    }
+    return false;
+}
+
+} // namespace nanodb
@@ -0,0 +1,220 @@
+#include "nanodb/index/roaring_bitmap.hpp"
+
+#include <algorithm>
+
+namespace nanodb {
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitmap) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::add(uint16_t low) {
+    if (isBitmap) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (!(bits[low >> 6] & mask)) {
+            bits[low >> 6] |= mask;
+            ++card;
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) return;
+    array.insert(it, low);
+    ++card;
+    if (card > kArrayMax) toBitmap();
+}
+
+void RoaringBitmap::Container::remove(uint16_t low) {
+    if (isBitmap) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (bits[low >> 6] & mask) {
+            bits[low >> 6] &= ~mask;
+            --card;
+            if (card <= kArrayMax) toArray();
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) return;
+    array.erase(it);
+    --card;
+}
+
+void RoaringBitmap::Container::toBitmap() {
+    bits.assign(kBitmapWords, 0);
+    for (uint16_t low : array) {
+        bits[low >> 6] |= uint64_t{1} << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+    isBitmap = true;
+}
+
+void RoaringBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(card);
+    for (size_t w = 0; w < bits.size(); ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+            array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+    isBitmap = false;
+}
+
+RoaringBitmap::Container* RoaringBitmap::find(uint16_t key) {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers_.end() && it->key == key) ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find(uint16_t key) const {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+        [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers_.end() && it->key == key) ? &*it : nullptr;
+}
+
+void RoaringBitmap::add(uint32_t id) {
+    uint16_t key = static_cast<uint16_t>(id >> 16);
+    // Row ids arrive mostly ascending, so check the last container first
+    if (containers_.empty() || containers_.back().key < key) {
+        containers_.emplace_back();
+        containers_.back().key = key;
+        containers_.back().add(static_cast<uint16_t>(id));
+        return;
+    }
+    Container* c = find(key);
+    if (!c) {
+        auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+            [](const Container& ct, uint16_t k) { return ct.key < k; });
+        c = &*containers_.emplace(it);
+        c->key = key;
+    }
+    c->add(static_cast<uint16_t>(id));
+}
+
+void RoaringBitmap::remove(uint32_t id) {
+    Container* c = find(static_cast<uint16_t>(id >> 16));
+    if (!c) return;
+    c->remove(static_cast<uint16_t>(id));
+    if (c->card == 0) {
+        containers_.erase(containers_.begin() + (c - containers_.data()));
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t id) const {
+    const Container* c = find(static_cast<uint16_t>(id >> 16));
+    return c && c->contains(static_cast<uint16_t>(id));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& c : containers_) {
+        total += c.card;
+    }
+    return total;
+}
+
+size_t RoaringBitmap::memoryBytes() const {
+    size_t bytes = containers_.capacity() * sizeof(Container);
+    for (const auto& c : containers_) {
+        bytes += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container out;
+    out.key = a.key;
+    if (a.isBitmap && b.isBitmap) {
+        out.isBitmap = true;
+        out.bits.resize(kBitmapWords);
+        for (size_t w = 0; w < kBitmapWords; ++w) {
+            out.bits[w] = a.bits[w] & b.bits[w];
+            out.card += static_cast<uint32_t>(__builtin_popcountll(out.bits[w]));
+        }
+        if (out.card <= kArrayMax) out.toArray();
+    } else if (a.isBitmap || b.isBitmap) {
+        const Container& arr = a.isBitmap ? b : a;
+        const Container& bmp = a.isBitmap ? a : b;
+        for (uint16_t low : arr.array) {
+            if (bmp.contains(low)) out.array.push_back(low);
+        }
+        out.card = static_cast<uint32_t>(out.array.size());
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(out.array));
+        out.card = static_cast<uint32_t>(out.array.size());
+    }
+    return out;
+}
+
+RoaringBitmap::Container RoaringBitmap::unite(const Container& a, const Container& b) {
+    Container out;
+    out.key = a.key;
+    if (!a.isBitmap && !b.isBitmap && a.card + b.card <= kArrayMax) {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(out.array));
+        out.card = static_cast<uint32_t>(out.array.size());
+        return out;
+    }
+
+    out.isBitmap = true;
+    out.bits.assign(kBitmapWords, 0);
+    for (const Container* c : {&a, &b}) {
+        if (c->isBitmap) {
+            for (size_t w = 0; w < kBitmapWords; ++w) out.bits[w] |= c->bits[w];
+        } else {
+            for (uint16_t low : c->array) out.bits[low >> 6] |= uint64_t{1} << (low & 63);
+        }
+    }
+    for (uint64_t word : out.bits) {
+        out.card += static_cast<uint32_t>(__builtin_popcountll(word));
+    }
+    if (out.card <= kArrayMax) out.toArray();
+    return out;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap out;
+    size_t i = 0, j = 0;
+    while (i < a.containers_.size() && j < b.containers_.size()) {
+        const Container& ca = a.containers_[i];
+        const Container& cb = b.containers_[j];
+        if (ca.key < cb.key) {
+            ++i;
+        } else if (cb.key < ca.key) {
+            ++j;
+        } else {
+            Container c = intersect(ca, cb);
+            if (c.card > 0) out.containers_.push_back(std::move(c));
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+    RoaringBitmap out;
+    size_t i = 0, j = 0;
+    while (i < a.containers_.size() || j < b.containers_.size()) {
+        if (j == b.containers_.size() ||
+            (i < a.containers_.size() && a.containers_[i].key < b.containers_[j].key)) {
+            out.containers_.push_back(a.containers_[i++]);
+        } else if (i == a.containers_.size() || b.containers_[j].key < a.containers_[i].key) {
+            out.containers_.push_back(b.containers_[j++]);
+        } else {
+            out.containers_.push_back(unite(a.containers_[i++], b.containers_[j++]));
+        }
+    }
+    return out;
+}
+
+} // namespace nanodb
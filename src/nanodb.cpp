@@ -1,63 +1,719 @@
 #include "nanodb/nanodb.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 
+#include <unistd.h>
+
 namespace nanodb {
 
-NanoDB::NanoDB()
-    : ddlExecutor_(std::make_unique<DDLExecutor>(catalog_))
-    , dmlExecutor_(std::make_unique<DMLExecutor>(catalog_))
+NanoDB::NanoDB() : NanoDB(std::make_shared<Shared>(), std::cout) {}
+
+NanoDB::NanoDB(std::shared_ptr<Shared> shared, std::ostream& out)
+    : shared_(std::move(shared))
+    , catalog_(shared_->catalog)
+    , planCache_(shared_->planCache)
+    , ddlExecutor_(std::make_unique<DDLExecutor>(catalog_, out))
+    , dmlExecutor_(std::make_unique<DMLExecutor>(catalog_, out))
     , selectExecutor_(std::make_unique<SelectExecutor>(catalog_))
     , aggregateExecutor_(std::make_unique<AggregateExecutor>(catalog_))
     , joinExecutor_(std::make_unique<JoinExecutor>(catalog_))
-{}
+    , copyExecutor_(std::make_unique<CopyExecutor>(catalog_,
+          [this](const SelectQuery& q, RowSink& sink) { return runQuery(q, sink, nullptr); }, out))
+    , slowLog_(shared_->slowLog)
+    , out_(out)
+{
+    console_.attach(STDOUT_FILENO);
+}
+
+NanoDB::~NanoDB() {
+    std::unique_lock<std::mutex> lock(asyncMutex_);
+    if (runningToken_) runningToken_->cancel();
+    for (auto& pending : submitted_) pending.token->cancel();
+    asyncIdle_.wait(lock, [this] { return !asyncRunning_; });
+}
+
+std::unique_ptr<NanoDB> NanoDB::openSession(std::ostream& messages) {
+    shared_->multiSession = true;
+    shared_->gc.start();
+    return std::unique_ptr<NanoDB>(new NanoDB(shared_, messages));
+}
+
+namespace {
+
+bool isCacheable(QueryType type) {
+    return type == QueryType::SELECT || type == QueryType::INSERT ||
+           type == QueryType::UPDATE || type == QueryType::DELETE_Q;
+}
+
+// Swallows the rows of an EXPLAIN ANALYZE run, keeping any error
+class DiscardSink : public RowSink {
+public:
+    void begin(const std::vector<Column>&, bool) override {}
+    bool row(const Row&, const std::vector<size_t>&) override { return true; }
+    void end() override {}
+    void error(const std::string& message) override { message_ = message; }
+
+    const std::string& message() const { return message_; }
+
+private:
+    std::string message_;
+};
+
+// Every table a statement names, including joined tables and child queries
+void collectTables(const Query& query, std::vector<std::string>& tables) {
+    if (!query.tableName.empty()) tables.push_back(query.tableName);
+    if (query.type == QueryType::SELECT) {
+        const auto& select = static_cast<const SelectQuery&>(query);
+        if (select.join.hasJoin) tables.push_back(select.join.tableName);
+    }
+    if (query.left) collectTables(*query.left, tables);
+    if (query.right) collectTables(*query.right, tables);
+}
+
+bool isSchemaChange(QueryType type) {
+    return type == QueryType::CREATE || type == QueryType::DROP ||
+           type == QueryType::CREATE_INDEX || type == QueryType::DROP_INDEX;
+}
+
+const char* const kTransactionAborted =
+    "Current transaction is aborted; statements are ignored until COMMIT or ROLLBACK.";
+
+// The transaction a statement runs in, current for its lifetime: the
+// session's open transaction, or else one of the statement's own that ends
+// with it (autocommit)
+class StatementTransaction {
+public:
+    StatementTransaction(TransactionManager& manager, Transaction* open)
+        : manager_(manager), txn_(open ? *open : own_), scope_(txn_) {
+        if (!open) manager_.begin(own_);
+    }
+
+    // Commits an autocommit transaction. After a write conflict, rolls back
+    // whichever transaction it was. Returns whether writes were committed.
+    bool finish() {
+        if (txn_.conflicted()) {
+            if (txn_.active()) manager_.rollback(txn_);
+            return false;
+        }
+        if (!own_.active()) return false;
+        bool wrote = own_.hasWrites();
+        manager_.commit(own_);
+        return wrote;
+    }
+
+private:
+    TransactionManager& manager_;
+    Transaction own_;
+    Transaction& txn_;
+    TransactionScope scope_;
+};
+
+} // namespace
+
+std::shared_ptr<Query> NanoDB::parseCached(const std::string& sql, std::string& error) {
+    if (sql.size() > PlanCache::kMaxStatementLength) {
+        return SQLParser::parse(sql, error);
+    }
+
+    std::string key = SQLParser::normalize(sql);
+    std::shared_ptr<Query> query = planCache_.lookup(key, catalog_.schemaVersion());
+    if (query) {
+        return query;
+    }
+
+    query = SQLParser::parse(sql, error);
+    if (query && isCacheable(query->type)) {
+        planCache_.insert(key, query, catalog_.schemaVersion());
+    }
+    return query;
+}
+
+std::shared_ptr<Query> NanoDB::parseForBinding(const std::string& sql, std::string& error) {
+    auto query = parseCached(sql, error);
+    if (query && !query->paramSlots.empty()) {
+        return SQLParser::parse(sql, error);
+    }
+    return query;
+}
+
+StatementLock NanoDB::lockFor(const Query& query) {
+    switch (query.type) {
+        case QueryType::CREATE:
+        case QueryType::DROP:
+        case QueryType::CREATE_INDEX:
+        case QueryType::DROP_INDEX:
+            return StatementLock(catalog_, StatementLock::Mode::SCHEMA);
+        case QueryType::PREPARE:
+        case QueryType::DEALLOCATE:
+        case QueryType::EXECUTE:
+        case QueryType::BEGIN:
+        case QueryType::COMMIT:
+        case QueryType::ROLLBACK:
+            // Session-local; EXECUTE locks for the statement it runs.
+            // Transactions end without locks: compaction leaves tables with
+            // uncommitted writes alone (see Table::pendingWriters).
+            return StatementLock();
+        default:
+            break;
+    }
+
+    using Access = StatementLock::Access;
+    StatementLock lock(catalog_, StatementLock::Mode::SHARED);
+    std::vector<std::pair<std::string, Access>> tables;
+    auto add = [&tables](const std::vector<std::string>& names, Access access) {
+        for (const auto& name : names) tables.emplace_back(name, access);
+    };
+    if (query.type == QueryType::SHOW) {
+        if (static_cast<const ShowQuery&>(query).target == ShowTarget::TABLE_SIZES) {
+            add(catalog_.tableNames(), Access::READ);
+        }
+    } else if (query.type == QueryType::VACUUM) {
+        // Without a table name VACUUM compacts them all
+        add(query.tableName.empty() ? catalog_.tableNames() : std::vector<std::string>{query.tableName},
+            Access::EXCLUSIVE);
+    } else {
+        std::vector<std::string> reads;
+        collectTables(query, reads);
+        add(reads, Access::READ);
+        bool copyFrom = query.type == QueryType::COPY && !static_cast<const CopyQuery&>(query).toFile;
+        if (query.type == QueryType::INSERT || query.type == QueryType::UPDATE ||
+            query.type == QueryType::DELETE_Q || copyFrom) {
+            tables.emplace_back(query.tableName, Access::WRITE);
+        }
+    }
+    lock.lockTables(std::move(tables));
+    return lock;
+}
 
 void NanoDB::executeSQL(const std::string& sql) {
-    auto query = SQLParser::parse(sql);
+    std::string error;
+    auto query = parseCached(sql, error);
     if (!query) {
-        std::cout << "Error: Unknown SQL command\n";
+        out_ << "Error: " << error << "\n";
+        return;
+    }
+    if (!query->paramSlots.empty()) {
+        out_ << "Error: Statement has '?' parameters; use PREPARE and EXECUTE\n";
+        return;
+    }
+
+    if (!slowLog_.enabled()) {
+        dispatch(*query);
+        return;
+    }
+
+    // ANALYZE only adds counters the executors keep anyway; the plan is
+    // rendered only if the statement turns out to be slow
+    QueryPlan plan;
+    plan.analyze = true;
+    capturePlan_ = &plan;
+    auto startedAt = std::chrono::system_clock::now();
+    ResourceUsage before = Metrics::threadUsage();
+    auto start = std::chrono::steady_clock::now();
+    dispatch(*query);
+    auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    capturePlan_ = nullptr;
+    if (!slowLog_.isSlow(nanos)) return;
+
+    SlowQueryEntry entry;
+    entry.sql = sql;
+    entry.startedAt = startedAt;
+    entry.nanos = nanos;
+    entry.usage = Metrics::threadUsage() - before;
+    if (!plan.root.name.empty()) entry.plan = plan.render();
+    slowLog_.record(std::move(entry));
+}
+
+void NanoDB::executeSQL(const std::string& sql, RowSink& results) {
+    results_ = &results;
+    executeSQL(sql);
+    results_ = nullptr;
+}
+
+bool NanoDB::enableSlowQueryLog(const std::string& path, double thresholdMs, std::string& error) {
+    return slowLog_.open(path, thresholdMs, error);
+}
+
+std::shared_ptr<PreparedStatement> NanoDB::prepare(const std::string& sql) {
+    std::string error;
+    auto query = parseForBinding(sql, error);
+    if (!query) {
+        out_ << "Error: " << error << "\n";
+        return nullptr;
+    }
+    if (!isCacheable(query->type)) {
+        out_ << "Error: Only SELECT, INSERT, UPDATE and DELETE can be prepared\n";
+        return nullptr;
+    }
+
+    auto stmt = std::make_shared<PreparedStatement>();
+    stmt->sql = sql;
+    stmt->query = std::move(query);
+    stmt->schemaVersion = catalog_.schemaVersion();
+    return stmt;
+}
+
+bool NanoDB::bindPrepared(PreparedStatement& stmt, const std::vector<Value>& params, std::string& error) {
+    if (stmt.schemaVersion != catalog_.schemaVersion()) {
+        // DDL ran since the statement was prepared; re-parse against the new schema
+        auto query = parseForBinding(stmt.sql, error);
+        if (!query) {
+            return false;
+        }
+        stmt.query = std::move(query);
+        stmt.schemaVersion = catalog_.schemaVersion();
+    }
+    return SQLParser::bind(*stmt.query, params, error);
+}
+
+void NanoDB::execute(PreparedStatement& stmt, const std::vector<Value>& params) {
+    std::string error;
+    if (!bindPrepared(stmt, params, error)) {
+        out_ << "Error: " << error << "\n";
+        return;
+    }
+    dispatch(*stmt.query);
+}
+
+ResultSet NanoDB::query(const std::string& sql) {
+    ResultSet result(!shared_->multiSession);
+    queryText(sql, result);
+    return result;
+}
+
+ResultSet NanoDB::query(PreparedStatement& stmt, const std::vector<Value>& params) {
+    ResultSet result(!shared_->multiSession);
+    queryPrepared(stmt, params, result);
+    return result;
+}
+
+QueryFuture NanoDB::submit(const std::string& sql, double timeoutMs) {
+    auto token = std::make_shared<CancellationToken>();
+    Submitted statement;
+    statement.sql = sql;
+    statement.token = token;
+    statement.timeoutMs = timeoutMs;
+    std::future<ResultSet> result = statement.result.get_future();
+
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    submitted_.push_back(std::move(statement));
+    if (!asyncRunning_) {
+        asyncRunning_ = true;
+        shared_->workers.post([this] { runSubmitted(); });
+    }
+    return QueryFuture(std::move(result), std::move(token));
+}
+
+void NanoDB::runSubmitted() {
+    Submitted statement;
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex_);
+        statement = std::move(submitted_.front());
+        submitted_.pop_front();
+        runningToken_ = statement.token;
+    }
+
+    const CancellationToken& token = *statement.token;
+    ResultSet result(false);
+    if (!token.fired()) {
+        if (statement.timeoutMs > 0) statement.token->setTimeout(statement.timeoutMs);
+        CancellationScope scope(token);
+        queryText(statement.sql, result);
+    }
+    // Operators stop early as if at a LIMIT, so the rows so far look like
+    // a complete result; replace them with the reason
+    if (token.fired() && result.ok()) {
+        result = ResultSet(false);
+        result.error(token.error());
+    }
+    statement.result.set_value(std::move(result));
+
+    // Notified under the lock: once asyncRunning_ is clear the destructor
+    // may proceed and take the condition variable with it
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    runningToken_.reset();
+    if (submitted_.empty()) {
+        asyncRunning_ = false;
+        asyncIdle_.notify_all();
+    } else {
+        shared_->workers.post([this] { runSubmitted(); });
+    }
+}
+
+void NanoDB::queryText(const std::string& sql, ResultSet& result) {
+    std::string error;
+    auto parsed = parseCached(sql, error);
+    if (!parsed) {
+        result.error(error);
+        return;
+    }
+
+    if (parsed->type == QueryType::EXECUTE) {
+        const auto* q = static_cast<const ExecuteQuery*>(parsed.get());
+        auto it = prepared_.find(q->name);
+        if (it == prepared_.end()) {
+            result.error("Prepared statement '" + q->name + "' does not exist");
+            return;
+        }
+        queryPrepared(*it->second, q->params, result);
+        return;
+    }
+
+    if (parsed->type != QueryType::SELECT && parsed->type != QueryType::EXPLAIN &&
+        parsed->type != QueryType::SHOW) {
+        result.error("query() expects a SELECT statement");
+        return;
+    }
+    if (!parsed->paramSlots.empty()) {
+        result.error("Statement has '?' parameters; use prepare()");
+        return;
+    }
+    StatementTimer timer(parsed->type);
+    if (parsed->type == QueryType::EXPLAIN) {
+        explain(*static_cast<const ExplainQuery*>(parsed.get()), result);
+    } else if (parsed->type == QueryType::SHOW) {
+        show(*static_cast<const ShowQuery*>(parsed.get()), result);
+    } else {
+        query(*static_cast<const SelectQuery*>(parsed.get()), result);
+    }
+}
+
+void NanoDB::queryPrepared(PreparedStatement& stmt, const std::vector<Value>& params, ResultSet& result) {
+    std::string error;
+    if (!bindPrepared(stmt, params, error)) {
+        result.error(error);
+        return;
+    }
+    if (stmt.query->type != QueryType::SELECT) {
+        result.error("query() expects a SELECT statement");
+        return;
+    }
+    StatementTimer timer(QueryType::SELECT);
+    query(*static_cast<const SelectQuery*>(stmt.query.get()), result);
+}
+
+bool NanoDB::query(const SelectQuery& q, RowSink& sink, QueryPlan* plan) {
+    if (transactionAborted()) {
+        sink.error(kTransactionAborted);
+        return false;
+    }
+    StatementLock lock = lockFor(q);
+    StatementTransaction txn(catalog_.transactions(), txn_.get());
+    bool ok = runQuery(q, sink, plan);
+    txn.finish();
+    return ok;
+}
+
+bool NanoDB::explain(const ExplainQuery& q, RowSink& sink) {
+    if (transactionAborted()) {
+        sink.error(kTransactionAborted);
+        return false;
+    }
+    StatementLock lock = lockFor(q);
+    StatementTransaction txn(catalog_.transactions(), txn_.get());
+    bool ok = runExplain(q, sink);
+    txn.finish();
+    return ok;
+}
+
+bool NanoDB::show(const ShowQuery& q, RowSink& sink) {
+    if (transactionAborted()) {
+        sink.error(kTransactionAborted);
+        return false;
+    }
+    StatementLock lock = lockFor(q);
+    StatementTransaction txn(catalog_.transactions(), txn_.get());
+    bool ok = runShow(q, sink);
+    txn.finish();
+    return ok;
+}
+
+bool NanoDB::runQuery(const SelectQuery& q, RowSink& sink, QueryPlan* plan) {
+    if (q.join.hasJoin) {
+        return joinExecutor_->execute(q, sink, plan);
+    } else if (q.groupBy.hasGroupBy) {
+        return aggregateExecutor_->executeWithGroupBy(q, sink, plan);
+    } else if (!q.aggregates.empty()) {
+        return aggregateExecutor_->execute(q, sink, plan);
+    }
+    return selectExecutor_->execute(q, sink, plan);
+}
+
+bool NanoDB::runExplain(const ExplainQuery& q, RowSink& sink) {
+    QueryPlan plan;
+    plan.analyze = q.analyze;
+    DiscardSink discard;
+    Stopwatch clock;
+    if (!runQuery(*static_cast<const SelectQuery*>(q.left.get()), discard, &plan)) {
+        sink.error(discard.message());
+        return false;
+    }
+    double millis = clock.elapsedMs();
+
+    std::vector<std::string> lines = plan.render();
+    if (q.analyze) {
+        char total[64];
+        std::snprintf(total, sizeof(total), "Execution Time: %.3f ms", millis);
+        lines.push_back(total);
+    }
+    sink.begin({{"QUERY PLAN", ColumnType::STRING}}, false);
+    Row row(1);
+    for (auto& line : lines) {
+        row[0] = std::move(line);
+        if (!sink.row(row, {0})) break;
+    }
+    sink.end();
+    return true;
+}
+
+bool NanoDB::runShow(const ShowQuery& q, RowSink& sink) {
+    if (q.target == ShowTarget::TABLE_SIZES) {
+        return showTableSizes(sink);
+    }
+    auto rows = Metrics::snapshot().rows();
+    rows.emplace_back("memory.in_use", std::to_string(MemoryTracker::inUse()));
+    rows.emplace_back("memory.peak", std::to_string(MemoryTracker::peak()));
+    rows.emplace_back("memory.limit", std::to_string(MemoryTracker::limit()));
+    rows.emplace_back("transactions.active", std::to_string(catalog_.transactions().activeCount()));
+    rows.emplace_back("transactions.last_commit", std::to_string(catalog_.transactions().lastCommitted()));
+    rows.emplace_back("gc.reclaimed_versions", std::to_string(shared_->gc.reclaimed()));
+
+    sink.begin({{"metric", ColumnType::STRING}, {"value", ColumnType::STRING}}, false);
+    Row row(2);
+    for (auto& [metric, value] : rows) {
+        row[0] = std::move(metric);
+        row[1] = std::move(value);
+        if (!sink.row(row, {0, 1})) break;
+    }
+    sink.end();
+    return true;
+}
+
+bool NanoDB::showTableSizes(RowSink& sink) {
+    std::vector<std::pair<std::string, TableMemory>> tables;
+    for (const auto& name : catalog_.tableNames()) {
+        tables.emplace_back(name, catalog_.memoryUsage(*catalog_.getTable(name)));
+    }
+    auto total = [](const TableMemory& m) { return m.dataBytes + m.indexBytes; };
+    std::sort(tables.begin(), tables.end(), [&](const auto& a, const auto& b) {
+        return total(a.second) > total(b.second) || (total(a.second) == total(b.second) && a.first < b.first);
+    });
+
+    // Sizes in KiB keep large tables within the INT range
+    auto kib = [](size_t bytes) { return static_cast<int>((bytes + 1023) / 1024); };
+    sink.begin({{"table", ColumnType::STRING}, {"rows", ColumnType::INT}, {"data_kib", ColumnType::INT},
+                {"index_kib", ColumnType::INT}, {"total_kib", ColumnType::INT}, {"total", ColumnType::STRING}},
+               false);
+    Row row(6);
+    for (auto& [name, memory] : tables) {
+        row[0] = std::move(name);
+        row[1] = static_cast<int>(memory.rows);
+        row[2] = kib(memory.dataBytes);
+        row[3] = kib(memory.indexBytes);
+        row[4] = kib(total(memory));
+        row[5] = describeBytes(total(memory));
+        if (!sink.row(row, {0, 1, 2, 3, 4, 5})) break;
+    }
+    sink.end();
+    return true;
+}
+
+void NanoDB::executePrepare(const PrepareQuery& query) {
+    if (prepared_.count(query.name)) {
+        out_ << "Error: Prepared statement '" << query.name << "' already exists\n";
         return;
     }
+    auto stmt = prepare(query.sql);
+    if (!stmt) {
+        return;
+    }
+    prepared_[query.name] = std::move(stmt);
+    out_ << "Statement '" << query.name << "' prepared.\n";
+}
 
-    switch (query->type) {
+void NanoDB::executeExecute(const ExecuteQuery& query) {
+    auto it = prepared_.find(query.name);
+    if (it == prepared_.end()) {
+        out_ << "Error: Prepared statement '" << query.name << "' does not exist\n";
+        return;
+    }
+    execute(*it->second, query.params);
+}
+
+void NanoDB::executeDeallocate(const DeallocateQuery& query) {
+    if (prepared_.erase(query.name) == 0) {
+        out_ << "Error: Prepared statement '" << query.name << "' does not exist\n";
+        return;
+    }
+    out_ << "Statement '" << query.name << "' deallocated.\n";
+}
+
+template <typename Fn>
+void NanoDB::withResultSink(Fn&& fn) {
+    if (results_) {
+        fn(*results_);
+        return;
+    }
+    // Keep earlier messages ahead of the result
+    out_.flush();
+    ResultPrinter printer(console_, outputMode_, out_);
+    fn(printer);
+}
+
+void NanoDB::dispatch(const Query& query) {
+    StatementTimer timer(query.type);
+    switch (query.type) {
+        case QueryType::BEGIN:
+            executeBegin();
+            return;
+        case QueryType::COMMIT:
+            endTransaction(true);
+            return;
+        case QueryType::ROLLBACK:
+            endTransaction(false);
+            return;
+        default:
+            break;
+    }
+    if (transactionAborted()) {
+        out_ << "Error: " << kTransactionAborted << "\n";
+        return;
+    }
+    if (txn_ && isSchemaChange(query.type)) {
+        out_ << "Error: Schema changes cannot run inside a transaction.\n";
+        return;
+    }
+
+    StatementLock lock = lockFor(query);
+    // Outside of BEGIN...COMMIT the statement gets a transaction of its own,
+    // begun after the locks so that a writer's snapshot includes the
+    // table's last commit
+    StatementTransaction txn(catalog_.transactions(), txn_.get());
+    switch (query.type) {
         case QueryType::CREATE: {
-            auto* q = static_cast<CreateQuery*>(query.get());
+            const auto* q = static_cast<const CreateQuery*>(&query);
             ddlExecutor_->executeCreateTable(*q);
             break;
         }
         case QueryType::DROP: {
-            auto* q = static_cast<DropQuery*>(query.get());
+            const auto* q = static_cast<const DropQuery*>(&query);
             ddlExecutor_->executeDropTable(*q);
             break;
         }
         case QueryType::INSERT: {
-            auto* q = static_cast<InsertQuery*>(query.get());
+            const auto* q = static_cast<const InsertQuery*>(&query);
             dmlExecutor_->executeInsert(*q);
             break;
         }
         case QueryType::UPDATE: {
-            auto* q = static_cast<UpdateQuery*>(query.get());
+            const auto* q = static_cast<const UpdateQuery*>(&query);
             dmlExecutor_->executeUpdate(*q);
             break;
         }
         case QueryType::DELETE_Q: {
-            auto* q = static_cast<DeleteQuery*>(query.get());
+            const auto* q = static_cast<const DeleteQuery*>(&query);
             dmlExecutor_->executeDelete(*q);
             break;
         }
         case QueryType::SELECT: {
-            auto* q = static_cast<SelectQuery*>(query.get());
-            if (q->join.hasJoin) {
-                joinExecutor_->execute(*q);
-            } else if (q->groupBy.hasGroupBy) {
-                aggregateExecutor_->executeWithGroupBy(*q);
-            } else if (!q->aggregates.empty()) {
-                aggregateExecutor_->execute(*q);
-            } else {
-                selectExecutor_->execute(*q);
-            }
+            const auto* q = static_cast<const SelectQuery*>(&query);
+            withResultSink([&](RowSink& sink) { runQuery(*q, sink, capturePlan_); });
+            break;
+        }
+        case QueryType::CREATE_INDEX: {
+            const auto* q = static_cast<const CreateIndexQuery*>(&query);
+            ddlExecutor_->executeCreateIndex(*q);
+            break;
+        }
+        case QueryType::DROP_INDEX: {
+            const auto* q = static_cast<const DropIndexQuery*>(&query);
+            ddlExecutor_->executeDropIndex(*q);
+            break;
+        }
+        case QueryType::VACUUM: {
+            const auto* q = static_cast<const VacuumQuery*>(&query);
+            ddlExecutor_->executeVacuum(*q);
+            break;
+        }
+        case QueryType::PREPARE: {
+            const auto* q = static_cast<const PrepareQuery*>(&query);
+            executePrepare(*q);
             break;
         }
+        case QueryType::EXECUTE: {
+            const auto* q = static_cast<const ExecuteQuery*>(&query);
+            executeExecute(*q);
+            break;
+        }
+        case QueryType::DEALLOCATE: {
+            const auto* q = static_cast<const DeallocateQuery*>(&query);
+            executeDeallocate(*q);
+            break;
+        }
+        case QueryType::COPY: {
+            const auto* q = static_cast<const CopyQuery*>(&query);
+            copyExecutor_->execute(*q);
+            break;
+        }
+        case QueryType::EXPLAIN: {
+            const auto* q = static_cast<const ExplainQuery*>(&query);
+            withResultSink([&](RowSink& sink) { runExplain(*q, sink); });
+            break;
+        }
+        case QueryType::SHOW: {
+            const auto* q = static_cast<const ShowQuery*>(&query);
+            withResultSink([&](RowSink& sink) { runShow(*q, sink); });
+            break;
+        }
+        case QueryType::BEGIN:
+        case QueryType::COMMIT:
+        case QueryType::ROLLBACK:
+            break;  // Handled above
+    }
+
+    bool wrote = txn.finish();
+    if (transactionAborted()) {
+        out_ << "Transaction rolled back.\n";
+    }
+    // With one session there is no collector thread; compact right after
+    // the write instead, once this statement's locks are gone
+    if (wrote && !shared_->gc.running()) {
+        lock.unlock();
+        catalog_.collectGarbage();
+    }
+}
+
+void NanoDB::executeBegin() {
+    if (txn_) {
+        out_ << "Error: A transaction is already in progress.\n";
+        return;
+    }
+    txn_ = std::make_unique<Transaction>(catalog_.transactions());
+    out_ << "Transaction started.\n";
+}
+
+void NanoDB::endTransaction(bool commit) {
+    if (!txn_) {
+        out_ << "Error: No transaction is in progress.\n";
+        return;
+    }
+    bool wrote = false;
+    if (!txn_->active()) {
+        commit = false;  // Already rolled back after a conflict
+    } else if (commit) {
+        wrote = txn_->hasWrites();
+        catalog_.transactions().commit(*txn_);
+    } else {
+        catalog_.transactions().rollback(*txn_);
+    }
+    txn_.reset();
+    out_ << (commit ? "Transaction committed.\n" : "Transaction rolled back.\n");
+    if (wrote && !shared_->gc.running()) {
+        catalog_.collectGarbage();
     }
 }
 
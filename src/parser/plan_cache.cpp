@@ -0,0 +1,64 @@
+#include "nanodb/parser/plan_cache.hpp"
+
+namespace nanodb {
+
+std::shared_ptr<Query> PlanCache::lookup(const std::string& key, uint64_t schemaVersion) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    if (it->second->schemaVersion != schemaVersion) {
+        entries_.erase(it->second);
+        map_.erase(it);
+        ++misses_;
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++hits_;
+    return it->second->query;
+}
+
+void PlanCache::insert(const std::string& key, std::shared_ptr<Query> query, uint64_t schemaVersion) {
+    if (capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+        it->second->query = std::move(query);
+        it->second->schemaVersion = schemaVersion;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+
+    if (entries_.size() >= capacity_) {
+        map_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{key, std::move(query), schemaVersion});
+    map_.emplace(key, entries_.begin());
+}
+
+void PlanCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    map_.clear();
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t PlanCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t PlanCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+} // namespace nanodb
@@ -1,736 +1,872 @@
 #include "nanodb/parser/sql_parser.hpp"
+#include "nanodb/parser/tokenizer.hpp"
 
-#include <algorithm>
-#include <sstream>
+#include <charconv>
+#include <cstdint>
 
 namespace nanodb {
 
-std::unique_ptr<Query> SQLParser::parse(const std::string& sql) {
-    std::string trimmed = trim(sql);
-    std::string upper = toUpper(trimmed);
-
-    if (upper.find("CREATE TABLE") == 0) {
-        return parseCreateTable(trimmed);
-    } else if (upper.find("DROP TABLE") == 0) {
-        return parseDropTable(trimmed);
-    } else if (upper.find("INSERT INTO") == 0) {
-        return parseInsert(trimmed);
-    } else if (upper.find("UPDATE") == 0) {
-        return parseUpdate(trimmed);
-    } else if (upper.find("DELETE FROM") == 0) {
-        return parseDelete(trimmed);
-    } else if (upper.find("SELECT") == 0) {
-        return parseSelect(trimmed);
-    }
-
-    return nullptr;
+namespace {
+
+// Recursive-descent parser over the token stream. One token of lookahead
+// (tok_) is enough for every statement except aggregate calls, which peek
+// one token further. Identifiers are copied exactly once, into the Query.
+class Parser {
+public:
+    explicit Parser(std::string_view sql) : tokenizer_(sql) { advance(); }
+
+    std::unique_ptr<Query> parseStatement();
+    const std::string& error() const { return error_; }
+    std::vector<size_t>& paramSlots() { return paramSlots_; }
+
+private:
+    void advance() { tok_ = tokenizer_.next(); }
+    Token peek() const {
+        Tokenizer copy = tokenizer_;
+        return copy.next();
+    }
+
+    bool isKeyword(std::string_view keyword) const {
+        return tok_.type == TokenType::IDENTIFIER && equalsIgnoreCase(tok_.text, keyword);
+    }
+    bool isSymbol(std::string_view symbol) const {
+        return tok_.type == TokenType::SYMBOL && tok_.text == symbol;
+    }
+    bool acceptKeyword(std::string_view keyword);
+    bool acceptSymbol(std::string_view symbol);
+    bool expectKeyword(std::string_view keyword);
+    bool expectSymbol(std::string_view symbol);
+    bool fail(std::string_view expected);
+    // Optional trailing semicolon, then nothing else
+    bool finish();
+
+    bool parseName(std::string& out);
+    // name or table.name
+    bool parseQualifiedName(std::string& out);
+    bool parseNameList(std::vector<std::string>& out);
+    bool parseInt(int& out);
+    bool parseValue(Value& out);
+    bool parseValueList(std::vector<Value>& out);
+    bool parseCompareOp(CompareOp& op);
+    bool parseCondition(Condition& cond);
+    bool parseWhere(WhereClause& where);
+    // Matches COUNT/SUM/AVG/MIN/MAX followed by '('
+    bool isAggregateCall(AggregateFunc& func) const;
+    // func '(' column | '*' ')', with tok_ on the function name
+    bool parseAggregateCall(AggregateFunc& func, std::string& column);
+
+    std::unique_ptr<Query> parseCreateTable();
+    std::unique_ptr<Query> parseCreateIndex();
+    std::unique_ptr<Query> parseDrop();
+    std::unique_ptr<Query> parseInsert();
+    std::unique_ptr<Query> parseUpdate();
+    std::unique_ptr<Query> parseDelete();
+    std::unique_ptr<Query> parseSelect();
+    // SELECT without the statement terminator, for COPY (SELECT ...)
+    std::unique_ptr<SelectQuery> parseSelectBody();
+    std::unique_ptr<Query> parseVacuum();
+    std::unique_ptr<Query> parsePrepare();
+    std::unique_ptr<Query> parseExecute();
+    std::unique_ptr<Query> parseDeallocate();
+    std::unique_ptr<Query> parseCopy();
+    std::unique_ptr<Query> parseExplain();
+    std::unique_ptr<Query> parseShow();
+    std::unique_ptr<Query> parseTransaction(QueryType type);
+    bool parseCopyOptions(CopyQuery& query);
+    bool parseSelectList(SelectQuery& query);
+    bool parseJoin(SelectQuery& query);
+
+    Tokenizer tokenizer_;
+    Token tok_;
+    std::string error_;
+    size_t valueCount_ = 0;
+    std::vector<size_t> paramSlots_;
+};
+
+bool Parser::acceptKeyword(std::string_view keyword) {
+    if (!isKeyword(keyword)) return false;
+    advance();
+    return true;
 }
 
-std::string SQLParser::trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) return "";
-    size_t end = str.find_last_not_of(" \t\n\r");
-    return str.substr(start, end - start + 1);
+bool Parser::acceptSymbol(std::string_view symbol) {
+    if (!isSymbol(symbol)) return false;
+    advance();
+    return true;
 }
 
-std::string SQLParser::toUpper(const std::string& str) {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
-    return result;
+bool Parser::expectKeyword(std::string_view keyword) {
+    return acceptKeyword(keyword) || fail(keyword);
 }
 
-Value SQLParser::parseValue(const std::string& val) {
-    std::string trimVal = trim(val);
+bool Parser::expectSymbol(std::string_view symbol) {
+    return acceptSymbol(symbol) || fail(std::string("'") + std::string(symbol) + "'");
+}
 
-    if (trimVal.empty()) {
-        return NullValue{};
+bool Parser::fail(std::string_view expected) {
+    if (!error_.empty()) return false;
+    error_ = "Syntax error: expected ";
+    error_ += expected;
+    if (tok_.type == TokenType::END) {
+        error_ += " at end of statement";
+    } else {
+        error_ += " near '";
+        error_ += tok_.text;
+        error_ += "'";
     }
+    return false;
+}
 
-    // Remove trailing semicolon
-    if (!trimVal.empty() && trimVal.back() == ';') {
-        trimVal.pop_back();
-        trimVal = trim(trimVal);
-    }
+bool Parser::finish() {
+    acceptSymbol(";");
+    return tok_.type == TokenType::END || fail("end of statement");
+}
 
-    // Check for NULL
-    if (toUpper(trimVal) == "NULL") {
-        return NullValue{};
-    }
+bool Parser::parseName(std::string& out) {
+    if (tok_.type != TokenType::IDENTIFIER) return fail("a name");
+    out.assign(tok_.text);
+    advance();
+    return true;
+}
 
-    // Check if it's a string (quoted)
-    if (trimVal.size() >= 2 &&
-        ((trimVal.front() == '\'' && trimVal.back() == '\'') ||
-         (trimVal.front() == '"' && trimVal.back() == '"'))) {
-        return trimVal.substr(1, trimVal.size() - 2);
+bool Parser::parseQualifiedName(std::string& out) {
+    if (tok_.type != TokenType::IDENTIFIER) return fail("a name");
+    std::string_view source = tokenizer_.source();
+    size_t start = tok_.offset;
+    size_t end = tok_.offset + tok_.text.size();
+    advance();
+    if (isSymbol(".")) {
+        advance();
+        if (tok_.type != TokenType::IDENTIFIER) return fail("a column name");
+        end = tok_.offset + tok_.text.size();
+        advance();
+        // Normalize "t . c" to "t.c"; the common "t.c" is a single slice
+        std::string_view qualified = source.substr(start, end - start);
+        if (qualified.find_first_of(" \t\r\n") != std::string_view::npos) {
+            out.clear();
+            for (char c : qualified) {
+                if (c != ' ' && c != '\t' && c != '\r' && c != '\n') out += c;
+            }
+            return true;
+        }
+        out.assign(qualified);
+        return true;
     }
+    out.assign(source.substr(start, end - start));
+    return true;
+}
 
-    // Try to parse as integer
-    try {
-        return std::stoi(trimVal);
-    } catch (...) {
-        return trimVal;
-    }
+bool Parser::parseNameList(std::vector<std::string>& out) {
+    if (!expectSymbol("(")) return false;
+    do {
+        std::string name;
+        if (!parseQualifiedName(name)) return false;
+        out.push_back(std::move(name));
+    } while (acceptSymbol(","));
+    return expectSymbol(")");
 }
 
-Condition SQLParser::parseSingleCondition(const std::string& condStr) {
-    Condition cond;
-    cond.hasCondition = true;
+bool Parser::parseInt(int& out) {
+    bool negative = acceptSymbol("-");
+    if (tok_.type != TokenType::NUMBER) return fail("a number");
+    std::string_view digits = tok_.text.substr(0, tok_.text.find('.'));
+    long long value = 0;
+    auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    (void)ptr;
+    if (negative) value = -value;
+    if (ec != std::errc() || value < INT32_MIN || value > INT32_MAX) return fail("a 32-bit integer");
+    out = static_cast<int>(value);
+    advance();
+    return true;
+}
 
-    std::string trimmed = trim(condStr);
+bool Parser::parseValue(Value& out) {
+    size_t ordinal = valueCount_++;
+    switch (tok_.type) {
+        case TokenType::NUMBER: {
+            // Fractions are truncated; out-of-range numbers are kept as text
+            std::string_view digits = tok_.text.substr(0, tok_.text.find('.'));
+            int value = 0;
+            auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+            (void)ptr;
+            if (ec == std::errc()) {
+                out = value;
+            } else {
+                out = std::string(tok_.text);
+            }
+            advance();
+            return true;
+        }
+        case TokenType::STRING: {
+            if (!tok_.escaped) {
+                out = std::string(tok_.text);
+            } else {
+                char quote = tokenizer_.source()[tok_.offset];
+                std::string text;
+                text.reserve(tok_.text.size());
+                for (size_t i = 0; i < tok_.text.size(); ++i) {
+                    text += tok_.text[i];
+                    if (tok_.text[i] == quote) ++i;  // Skip the doubled quote
+                }
+                out = std::move(text);
+            }
+            advance();
+            return true;
+        }
+        case TokenType::IDENTIFIER:
+            // Unquoted words other than NULL are taken as strings
+            if (equalsIgnoreCase(tok_.text, "NULL")) {
+                out = NullValue{};
+            } else {
+                out = std::string(tok_.text);
+            }
+            advance();
+            return true;
+        case TokenType::SYMBOL:
+            if (isSymbol("?")) {
+                // Placeholder; stays NULL until bound
+                out = NullValue{};
+                paramSlots_.push_back(ordinal);
+                advance();
+                return true;
+            }
+            if (isSymbol("-")) {
+                int value = 0;
+                if (!parseInt(value)) return false;
+                out = value;
+                return true;
+            }
+            return fail("a value");
+        default:
+            return fail("a value");
+    }
+}
 
-    // Parse operator and split into column and value
-    size_t opPos = std::string::npos;
-    CompareOp op = CompareOp::EQ;
-    size_t opLen = 1;
+bool Parser::parseValueList(std::vector<Value>& out) {
+    if (!expectSymbol("(")) return false;
+    do {
+        Value v;
+        if (!parseValue(v)) return false;
+        out.push_back(std::move(v));
+    } while (acceptSymbol(","));
+    return expectSymbol(")");
+}
 
-    // Check for two-character operators first
-    if ((opPos = trimmed.find(">=")) != std::string::npos) {
-        op = CompareOp::GE;
-        opLen = 2;
-    } else if ((opPos = trimmed.find("<=")) != std::string::npos) {
-        op = CompareOp::LE;
-        opLen = 2;
-    } else if ((opPos = trimmed.find("!=")) != std::string::npos) {
-        op = CompareOp::NE;
-        opLen = 2;
-    } else if ((opPos = trimmed.find("<>")) != std::string::npos) {
+bool Parser::parseCompareOp(CompareOp& op) {
+    if (tok_.type != TokenType::SYMBOL) return fail("a comparison operator");
+    std::string_view s = tok_.text;
+    if (s == "=") {
+        op = CompareOp::EQ;
+    } else if (s == "!=" || s == "<>") {
         op = CompareOp::NE;
-        opLen = 2;
-    } else if ((opPos = trimmed.find(">")) != std::string::npos) {
-        op = CompareOp::GT;
-        opLen = 1;
-    } else if ((opPos = trimmed.find("<")) != std::string::npos) {
+    } else if (s == "<") {
         op = CompareOp::LT;
-        opLen = 1;
-    } else if ((opPos = trimmed.find("=")) != std::string::npos) {
-        op = CompareOp::EQ;
-        opLen = 1;
+    } else if (s == "<=") {
+        op = CompareOp::LE;
+    } else if (s == ">") {
+        op = CompareOp::GT;
+    } else if (s == ">=") {
+        op = CompareOp::GE;
+    } else {
+        return fail("a comparison operator");
     }
+    advance();
+    return true;
+}
 
-    if (opPos != std::string::npos) {
-        cond.column = trim(trimmed.substr(0, opPos));
-        cond.op = op;
-        cond.value = parseValue(trimmed.substr(opPos + opLen));
+bool Parser::parseCondition(Condition& cond) {
+    cond.hasCondition = true;
+    if (!parseQualifiedName(cond.column)) return false;
+    if (acceptKeyword("IN")) {
+        cond.op = CompareOp::IN;
+        return parseValueList(cond.inValues);
     }
-
-    return cond;
+    return parseCompareOp(cond.op) && parseValue(cond.value);
 }
 
-void SQLParser::parseWhereClause(const std::string& sql, const std::string& upper, WhereClause& where) {
-    size_t wherePos = upper.find("WHERE");
-    if (wherePos == std::string::npos) return;
-
+bool Parser::parseWhere(WhereClause& where) {
     where.hasWhere = true;
-
-    // Find the end of WHERE clause
-    size_t endPos = upper.length();
-    size_t groupPos = upper.find("GROUP BY", wherePos);
-    size_t havingPos = upper.find("HAVING", wherePos);
-    size_t orderPos = upper.find("ORDER BY", wherePos);
-    size_t limitPos = upper.find("LIMIT", wherePos);
-
-    if (groupPos != std::string::npos && groupPos < endPos) endPos = groupPos;
-    if (havingPos != std::string::npos && havingPos < endPos) endPos = havingPos;
-    if (orderPos != std::string::npos && orderPos < endPos) endPos = orderPos;
-    if (limitPos != std::string::npos && limitPos < endPos) endPos = limitPos;
-
-    std::string whereStr = sql.substr(wherePos + 5, endPos - wherePos - 5);
-    whereStr = trim(whereStr);
-
-    // Remove trailing semicolon
-    if (!whereStr.empty() && whereStr.back() == ';') {
-        whereStr.pop_back();
-        whereStr = trim(whereStr);
-    }
-
-    // Split by AND/OR while preserving order
-    std::string upperWhere = toUpper(whereStr);
-    std::vector<std::string> parts;
-    std::vector<LogicalOp> ops;
-
-    size_t pos = 0;
-    while (pos < whereStr.length()) {
-        size_t andPos = upperWhere.find(" AND ", pos);
-        size_t orPos = upperWhere.find(" OR ", pos);
-
-        size_t nextOp = std::string::npos;
-        LogicalOp op = LogicalOp::NONE;
-        size_t opLen = 0;
-
-        if (andPos != std::string::npos && (orPos == std::string::npos || andPos < orPos)) {
-            nextOp = andPos;
-            op = LogicalOp::AND;
-            opLen = 5;  // " AND "
-        } else if (orPos != std::string::npos) {
-            nextOp = orPos;
-            op = LogicalOp::OR;
-            opLen = 4;  // " OR "
-        }
-
-        if (nextOp != std::string::npos) {
-            parts.push_back(trim(whereStr.substr(pos, nextOp - pos)));
-            ops.push_back(op);
-            pos = nextOp + opLen;
+    do {
+        Condition cond;
+        if (!parseCondition(cond)) return false;
+        where.conditions.push_back(std::move(cond));
+
+        if (acceptKeyword("AND")) {
+            where.logicalOps.push_back(LogicalOp::AND);
+        } else if (acceptKeyword("OR")) {
+            where.logicalOps.push_back(LogicalOp::OR);
         } else {
-            parts.push_back(trim(whereStr.substr(pos)));
             break;
         }
-    }
+    } while (true);
+    return true;
+}
 
-    // Parse each condition
-    for (const auto& part : parts) {
-        where.conditions.push_back(parseSingleCondition(part));
+bool Parser::isAggregateCall(AggregateFunc& func) const {
+    if (tok_.type != TokenType::IDENTIFIER) return false;
+    if (equalsIgnoreCase(tok_.text, "COUNT")) {
+        func = AggregateFunc::COUNT;
+    } else if (equalsIgnoreCase(tok_.text, "SUM")) {
+        func = AggregateFunc::SUM;
+    } else if (equalsIgnoreCase(tok_.text, "AVG")) {
+        func = AggregateFunc::AVG;
+    } else if (equalsIgnoreCase(tok_.text, "MIN")) {
+        func = AggregateFunc::MIN;
+    } else if (equalsIgnoreCase(tok_.text, "MAX")) {
+        func = AggregateFunc::MAX;
+    } else {
+        return false;
     }
-    where.logicalOps = ops;
+    Token next = peek();
+    return next.type == TokenType::SYMBOL && next.text == "(";
 }
 
-void SQLParser::parseOrderBy(const std::string& sql, const std::string& upper, SelectQuery& query) {
-    size_t orderPos = upper.find("ORDER BY");
-    if (orderPos == std::string::npos) return;
-
-    query.orderBy.hasOrderBy = true;
-
-    // Find end of ORDER BY (LIMIT or end)
-    size_t endPos = upper.length();
-    size_t limitPos = upper.find("LIMIT", orderPos);
-    if (limitPos != std::string::npos) endPos = limitPos;
+bool Parser::parseAggregateCall(AggregateFunc& func, std::string& column) {
+    advance();  // Function name
+    if (!expectSymbol("(")) return false;
+    if (acceptSymbol("*")) {
+        if (func != AggregateFunc::COUNT) return fail("a column name");
+        func = AggregateFunc::COUNT_STAR;
+    } else if (!parseQualifiedName(column)) {
+        return false;
+    }
+    return expectSymbol(")");
+}
 
-    std::string orderStr = sql.substr(orderPos + 8, endPos - orderPos - 8);
-    orderStr = trim(orderStr);
+std::unique_ptr<Query> Parser::parseStatement() {
+    if (acceptKeyword("CREATE")) {
+        if (acceptKeyword("TABLE")) return parseCreateTable();
+        if (acceptKeyword("INDEX")) return parseCreateIndex();
+        fail("TABLE or INDEX");
+        return nullptr;
+    }
+    if (acceptKeyword("DROP")) return parseDrop();
+    if (acceptKeyword("INSERT")) return parseInsert();
+    if (acceptKeyword("UPDATE")) return parseUpdate();
+    if (acceptKeyword("DELETE")) return parseDelete();
+    if (acceptKeyword("SELECT")) return parseSelect();
+    if (acceptKeyword("VACUUM")) return parseVacuum();
+    if (acceptKeyword("PREPARE")) return parsePrepare();
+    if (acceptKeyword("EXECUTE")) return parseExecute();
+    if (acceptKeyword("DEALLOCATE")) return parseDeallocate();
+    if (acceptKeyword("COPY")) return parseCopy();
+    if (acceptKeyword("EXPLAIN")) return parseExplain();
+    if (acceptKeyword("SHOW")) return parseShow();
+    if (acceptKeyword("BEGIN")) return parseTransaction(QueryType::BEGIN);
+    if (acceptKeyword("START")) {
+        if (!expectKeyword("TRANSACTION")) return nullptr;
+        return parseTransaction(QueryType::BEGIN);
+    }
+    if (acceptKeyword("COMMIT")) return parseTransaction(QueryType::COMMIT);
+    if (acceptKeyword("ROLLBACK")) return parseTransaction(QueryType::ROLLBACK);
+
+    error_ = "Unknown SQL command";
+    return nullptr;
+}
 
-    // Remove trailing semicolon
-    if (!orderStr.empty() && orderStr.back() == ';') {
-        orderStr.pop_back();
-        orderStr = trim(orderStr);
-    }
+std::unique_ptr<Query> Parser::parseCreateTable() {
+    auto query = std::make_unique<CreateQuery>();
+    if (!parseName(query->tableName) || !expectSymbol("(")) return nullptr;
 
-    // Check for ASC/DESC
-    std::string upperOrder = toUpper(orderStr);
-    if (upperOrder.find(" DESC") != std::string::npos) {
-        query.orderBy.order = SortOrder::DESC;
-        size_t descPos = upperOrder.find(" DESC");
-        query.orderBy.column = trim(orderStr.substr(0, descPos));
-    } else if (upperOrder.find(" ASC") != std::string::npos) {
-        query.orderBy.order = SortOrder::ASC;
-        size_t ascPos = upperOrder.find(" ASC");
-        query.orderBy.column = trim(orderStr.substr(0, ascPos));
-    } else {
-        query.orderBy.order = SortOrder::ASC;  // Default
-        query.orderBy.column = orderStr;
-    }
-}
-
-void SQLParser::parseAggregates(const std::string& columnsPart, SelectQuery& query) {
-    std::string upper = toUpper(columnsPart);
-
-    // Check for aggregate functions
-    auto parseAgg = [&](const std::string& funcName, AggregateFunc func) {
-        size_t pos = upper.find(funcName + "(");
-        if (pos != std::string::npos) {
-            size_t start = pos + funcName.length() + 1;
-            size_t end = upper.find(")", start);
-            if (end != std::string::npos) {
-                AggregateExpr agg;
-                agg.func = func;
-                std::string col = trim(columnsPart.substr(start, end - start));
-                if (col == "*") {
-                    agg.func = AggregateFunc::COUNT_STAR;
-                } else {
-                    agg.column = col;
-                }
-                query.aggregates.push_back(agg);
-            }
+    do {
+        Column col;
+        std::string_view type;
+        if (!parseName(col.name)) return nullptr;
+        if (tok_.type != TokenType::IDENTIFIER) {
+            fail("a column type");
+            return nullptr;
         }
-    };
+        type = tok_.text;
+        advance();
+        col.type = (equalsIgnoreCase(type, "INT") || equalsIgnoreCase(type, "INTEGER"))
+                       ? ColumnType::INT : ColumnType::STRING;
+
+        // Skip type arguments and constraints, e.g. VARCHAR(255) NOT NULL
+        int depth = 0;
+        while (tok_.type != TokenType::END && tok_.type != TokenType::INVALID) {
+            if (depth == 0 && (isSymbol(",") || isSymbol(")"))) break;
+            if (isSymbol("(")) ++depth;
+            if (isSymbol(")")) --depth;
+            advance();
+        }
+        query->columns.push_back(std::move(col));
+    } while (acceptSymbol(","));
 
-    parseAgg("COUNT", AggregateFunc::COUNT);
-    parseAgg("SUM", AggregateFunc::SUM);
-    parseAgg("AVG", AggregateFunc::AVG);
-    parseAgg("MIN", AggregateFunc::MIN);
-    parseAgg("MAX", AggregateFunc::MAX);
+    if (!expectSymbol(")") || !finish()) return nullptr;
+    return query;
 }
 
-void SQLParser::parseGroupBy(const std::string& sql, const std::string& upper, SelectQuery& query) {
-    size_t groupPos = upper.find("GROUP BY");
-    if (groupPos == std::string::npos) return;
-
-    query.groupBy.hasGroupBy = true;
-
-    // Find end of GROUP BY
-    size_t endPos = upper.length();
-    size_t havingPos = upper.find("HAVING", groupPos);
-    size_t orderPos = upper.find("ORDER BY", groupPos);
-    size_t limitPos = upper.find("LIMIT", groupPos);
+std::unique_ptr<Query> Parser::parseCreateIndex() {
+    // CREATE INDEX name ON table [USING method] (column) [USING method] [INCLUDE (col, ...)]
+    auto query = std::make_unique<CreateIndexQuery>();
+    if (!parseName(query->indexName) || !expectKeyword("ON") || !parseName(query->tableName)) {
+        return nullptr;
+    }
+
+    auto parseMethod = [&]() -> bool {
+        if (tok_.type != TokenType::IDENTIFIER) return fail("an index method");
+        if (equalsIgnoreCase(tok_.text, "ORDERED") || equalsIgnoreCase(tok_.text, "BTREE")) {
+            query->indexType = IndexType::ORDERED;
+        } else if (equalsIgnoreCase(tok_.text, "HASH")) {
+            query->indexType = IndexType::HASH;
+        } else if (equalsIgnoreCase(tok_.text, "BITMAP")) {
+            query->indexType = IndexType::BITMAP;
+        } else if (equalsIgnoreCase(tok_.text, "BLOOM")) {
+            query->indexType = IndexType::BLOOM;
+        } else {
+            return fail("ORDERED, BTREE, HASH, BITMAP or BLOOM");
+        }
+        advance();
+        return true;
+    };
 
-    if (havingPos != std::string::npos && havingPos < endPos) endPos = havingPos;
-    if (orderPos != std::string::npos && orderPos < endPos) endPos = orderPos;
-    if (limitPos != std::string::npos && limitPos < endPos) endPos = limitPos;
+    if (acceptKeyword("USING") && !parseMethod()) return nullptr;
+    if (!expectSymbol("(") || !parseName(query->column) || !expectSymbol(")")) return nullptr;
+    if (acceptKeyword("USING") && !parseMethod()) return nullptr;
+    if (acceptKeyword("INCLUDE") && !parseNameList(query->includeColumns)) return nullptr;
 
-    std::string groupStr = sql.substr(groupPos + 8, endPos - groupPos - 8);
-    groupStr = trim(groupStr);
+    if (!finish()) return nullptr;
+    return query;
+}
 
-    // Remove trailing semicolon
-    if (!groupStr.empty() && groupStr.back() == ';') {
-        groupStr.pop_back();
-        groupStr = trim(groupStr);
+std::unique_ptr<Query> Parser::parseDrop() {
+    if (acceptKeyword("TABLE")) {
+        auto query = std::make_unique<DropQuery>();
+        if (!parseName(query->tableName) || !finish()) return nullptr;
+        return query;
     }
-
-    // Parse comma-separated columns
-    std::stringstream ss(groupStr);
-    std::string col;
-    while (std::getline(ss, col, ',')) {
-        query.groupBy.columns.push_back(trim(col));
+    if (acceptKeyword("INDEX")) {
+        auto query = std::make_unique<DropIndexQuery>();
+        if (!parseName(query->indexName) || !finish()) return nullptr;
+        return query;
     }
+    fail("TABLE or INDEX");
+    return nullptr;
 }
 
-void SQLParser::parseHaving(const std::string& sql, const std::string& upper, SelectQuery& query) {
-    size_t havingPos = upper.find("HAVING");
-    if (havingPos == std::string::npos) return;
-
-    query.having.hasHaving = true;
-
-    // Find end of HAVING
-    size_t endPos = upper.length();
-    size_t orderPos = upper.find("ORDER BY", havingPos);
-    size_t limitPos = upper.find("LIMIT", havingPos);
-
-    if (orderPos != std::string::npos && orderPos < endPos) endPos = orderPos;
-    if (limitPos != std::string::npos && limitPos < endPos) endPos = limitPos;
-
-    std::string havingStr = sql.substr(havingPos + 6, endPos - havingPos - 6);
-    havingStr = trim(havingStr);
+std::unique_ptr<Query> Parser::parseInsert() {
+    // INSERT INTO table [(col, ...)] VALUES (v, ...) [, (v, ...) ...]
+    auto query = std::make_unique<InsertQuery>();
+    if (!expectKeyword("INTO") || !parseName(query->tableName)) return nullptr;
+    if (isSymbol("(") && !parseNameList(query->insertColumns)) return nullptr;
+    if (!expectKeyword("VALUES")) return nullptr;
+    do {
+        Row row;
+        if (!parseValueList(row)) return nullptr;
+        query->rows.push_back(std::move(row));
+    } while (acceptSymbol(","));
+    if (!finish()) return nullptr;
+    return query;
+}
 
-    // Remove trailing semicolon
-    if (!havingStr.empty() && havingStr.back() == ';') {
-        havingStr.pop_back();
-        havingStr = trim(havingStr);
-    }
+std::unique_ptr<Query> Parser::parseUpdate() {
+    // UPDATE table SET col = val [, ...] [WHERE ...]
+    auto query = std::make_unique<UpdateQuery>();
+    if (!parseName(query->tableName) || !expectKeyword("SET")) return nullptr;
 
-    std::string upperHaving = toUpper(havingStr);
+    do {
+        SetClause sc;
+        if (!parseQualifiedName(sc.column) || !expectSymbol("=") || !parseValue(sc.value)) return nullptr;
+        query->setClauses.push_back(std::move(sc));
+    } while (acceptSymbol(","));
 
-    // Parse aggregate function in HAVING (e.g., COUNT(*) > 1, SUM(col) >= 100)
-    auto parseHavingAgg = [&](const std::string& funcName, AggregateFunc func) -> bool {
-        size_t funcPos = upperHaving.find(funcName + "(");
-        if (funcPos != std::string::npos) {
-            size_t parenStart = funcPos + funcName.length() + 1;
-            size_t parenEnd = upperHaving.find(")", parenStart);
-            if (parenEnd != std::string::npos) {
-                query.having.func = func;
-                std::string col = trim(havingStr.substr(parenStart, parenEnd - parenStart));
-                if (col == "*") {
-                    query.having.func = AggregateFunc::COUNT_STAR;
-                } else {
-                    query.having.column = col;
-                }
+    if (acceptKeyword("WHERE") && !parseWhere(query->where)) return nullptr;
+    if (!finish()) return nullptr;
+    return query;
+}
 
-                // Parse comparison after the function
-                std::string afterFunc = havingStr.substr(parenEnd + 1);
-                afterFunc = trim(afterFunc);
-
-                // Find operator
-                size_t opPos = std::string::npos;
-                size_t opLen = 1;
-                if ((opPos = afterFunc.find(">=")) != std::string::npos) {
-                    query.having.op = CompareOp::GE;
-                    opLen = 2;
-                } else if ((opPos = afterFunc.find("<=")) != std::string::npos) {
-                    query.having.op = CompareOp::LE;
-                    opLen = 2;
-                } else if ((opPos = afterFunc.find("!=")) != std::string::npos) {
-                    query.having.op = CompareOp::NE;
-                    opLen = 2;
-                } else if ((opPos = afterFunc.find(">")) != std::string::npos) {
-                    query.having.op = CompareOp::GT;
-                    opLen = 1;
-                } else if ((opPos = afterFunc.find("<")) != std::string::npos) {
-                    query.having.op = CompareOp::LT;
-                    opLen = 1;
-                } else if ((opPos = afterFunc.find("=")) != std::string::npos) {
-                    query.having.op = CompareOp::EQ;
-                    opLen = 1;
-                }
+std::unique_ptr<Query> Parser::parseDelete() {
+    // DELETE FROM table [WHERE ...]
+    auto query = std::make_unique<DeleteQuery>();
+    if (!expectKeyword("FROM") || !parseName(query->tableName)) return nullptr;
+    if (acceptKeyword("WHERE") && !parseWhere(query->where)) return nullptr;
+    if (!finish()) return nullptr;
+    return query;
+}
 
-                if (opPos != std::string::npos) {
-                    std::string valStr = trim(afterFunc.substr(opPos + opLen));
-                    try {
-                        query.having.value = std::stoi(valStr);
-                    } catch (...) {
-                        query.having.value = 0;
-                    }
-                }
-                return true;
-            }
+bool Parser::parseSelectList(SelectQuery& query) {
+    if (acceptSymbol("*")) return true;
+    if (isKeyword("FROM")) return fail("a column list");
+
+    std::vector<std::string> columns;
+    do {
+        AggregateFunc func = AggregateFunc::NONE;
+        if (isAggregateCall(func)) {
+            AggregateExpr agg;
+            agg.func = func;
+            if (!parseAggregateCall(agg.func, agg.column)) return false;
+            if (acceptKeyword("AS") && !parseName(agg.alias)) return false;
+            query.aggregates.push_back(std::move(agg));
+        } else {
+            std::string col;
+            if (!parseQualifiedName(col)) return false;
+            columns.push_back(std::move(col));
         }
-        return false;
-    };
+    } while (acceptSymbol(","));
 
-    if (!parseHavingAgg("COUNT", AggregateFunc::COUNT)) {
-        if (!parseHavingAgg("SUM", AggregateFunc::SUM)) {
-            if (!parseHavingAgg("AVG", AggregateFunc::AVG)) {
-                if (!parseHavingAgg("MIN", AggregateFunc::MIN)) {
-                    parseHavingAgg("MAX", AggregateFunc::MAX);
-                }
-            }
-        }
+    // With aggregates the plain columns are the GROUP BY keys, printed from there
+    if (query.aggregates.empty()) {
+        query.selectColumns = std::move(columns);
     }
+    return true;
 }
 
-void SQLParser::parseJoin(const std::string& sql, const std::string& upper, SelectQuery& query) {
-    // Look for JOIN types
-    size_t joinPos = std::string::npos;
-    JoinType joinType = JoinType::INNER;
-
-    size_t innerPos = upper.find("INNER JOIN");
-    size_t leftPos = upper.find("LEFT JOIN");
-    size_t rightPos = upper.find("RIGHT JOIN");
-    size_t simpleJoinPos = upper.find(" JOIN ");
-
-    // Find the first JOIN keyword
-    if (leftPos != std::string::npos) {
-        joinPos = leftPos;
-        joinType = JoinType::LEFT;
-    } else if (rightPos != std::string::npos) {
-        joinPos = rightPos;
-        joinType = JoinType::RIGHT;
-    } else if (innerPos != std::string::npos) {
-        joinPos = innerPos;
-        joinType = JoinType::INNER;
-    } else if (simpleJoinPos != std::string::npos) {
-        joinPos = simpleJoinPos;
-        joinType = JoinType::INNER;  // Default to INNER
-    }
-
-    if (joinPos == std::string::npos) return;
-
-    query.join.hasJoin = true;
-    query.join.type = joinType;
-
-    // Find the join table name and ON clause
-    size_t joinKeywordEnd = joinPos;
-    if (joinType == JoinType::LEFT) {
-        joinKeywordEnd = joinPos + 9;  // "LEFT JOIN"
-    } else if (joinType == JoinType::RIGHT) {
-        joinKeywordEnd = joinPos + 10;  // "RIGHT JOIN"
-    } else if (upper.find("INNER JOIN", joinPos) == joinPos) {
-        joinKeywordEnd = joinPos + 10;  // "INNER JOIN"
+bool Parser::parseJoin(SelectQuery& query) {
+    // [INNER | LEFT [OUTER] | RIGHT [OUTER]] JOIN table ON a.col = b.col
+    if (acceptKeyword("INNER")) {
+        query.join.type = JoinType::INNER;
+        if (!expectKeyword("JOIN")) return false;
+    } else if (acceptKeyword("LEFT")) {
+        query.join.type = JoinType::LEFT;
+        acceptKeyword("OUTER");
+        if (!expectKeyword("JOIN")) return false;
+    } else if (acceptKeyword("RIGHT")) {
+        query.join.type = JoinType::RIGHT;
+        acceptKeyword("OUTER");
+        if (!expectKeyword("JOIN")) return false;
+    } else if (acceptKeyword("JOIN")) {
+        query.join.type = JoinType::INNER;
     } else {
-        joinKeywordEnd = joinPos + 5;  // " JOIN"
+        return true;
     }
+    query.join.hasJoin = true;
 
-    size_t onPos = upper.find(" ON ", joinKeywordEnd);
-    if (onPos == std::string::npos) return;
-
-    // Extract join table name
-    query.join.tableName = trim(sql.substr(joinKeywordEnd, onPos - joinKeywordEnd));
-
-    // Find end of ON clause
-    size_t endPos = upper.length();
-    size_t wherePos = upper.find("WHERE", onPos);
-    size_t groupPos = upper.find("GROUP BY", onPos);
-    size_t orderPos = upper.find("ORDER BY", onPos);
-    size_t limitPos = upper.find("LIMIT", onPos);
-
-    if (wherePos != std::string::npos && wherePos < endPos) endPos = wherePos;
-    if (groupPos != std::string::npos && groupPos < endPos) endPos = groupPos;
-    if (orderPos != std::string::npos && orderPos < endPos) endPos = orderPos;
-    if (limitPos != std::string::npos && limitPos < endPos) endPos = limitPos;
-
-    std::string onClause = sql.substr(onPos + 4, endPos - onPos - 4);
-    onClause = trim(onClause);
-
-    // Remove trailing semicolon
-    if (!onClause.empty() && onClause.back() == ';') {
-        onClause.pop_back();
-        onClause = trim(onClause);
+    std::string left, right;
+    if (!parseName(query.join.tableName) || !expectKeyword("ON") ||
+        !parseQualifiedName(left) || !expectSymbol("=") || !parseQualifiedName(right)) {
+        return false;
     }
 
-    // Parse ON condition: table1.col = table2.col
-    size_t eqPos = onClause.find('=');
-    if (eqPos != std::string::npos) {
-        std::string leftSide = trim(onClause.substr(0, eqPos));
-        std::string rightSide = trim(onClause.substr(eqPos + 1));
-
-        // Parse left side (table.column or just column)
-        size_t leftDot = leftSide.find('.');
-        if (leftDot != std::string::npos) {
-            query.join.leftTable = trim(leftSide.substr(0, leftDot));
-            query.join.leftColumn = trim(leftSide.substr(leftDot + 1));
+    auto split = [](const std::string& name, std::string& table, std::string& column) {
+        size_t dot = name.find('.');
+        if (dot != std::string::npos) {
+            table = name.substr(0, dot);
+            column = name.substr(dot + 1);
         } else {
-            query.join.leftColumn = leftSide;
+            column = name;
         }
-
-        // Parse right side (table.column or just column)
-        size_t rightDot = rightSide.find('.');
-        if (rightDot != std::string::npos) {
-            query.join.rightTable = trim(rightSide.substr(0, rightDot));
-            query.join.rightColumn = trim(rightSide.substr(rightDot + 1));
-        } else {
-            query.join.rightColumn = rightSide;
-        }
-    }
+    };
+    split(left, query.join.leftTable, query.join.leftColumn);
+    split(right, query.join.rightTable, query.join.rightColumn);
+    return true;
 }
 
-std::unique_ptr<CreateQuery> SQLParser::parseCreateTable(const std::string& sql) {
-    auto query = std::make_unique<CreateQuery>();
-
-    size_t tableStart = sql.find("TABLE") + 5;
-    if (tableStart == std::string::npos + 5) {
-        tableStart = sql.find("table") + 5;
-    }
-
-    size_t parenStart = sql.find('(');
-    if (parenStart == std::string::npos) return query;
+std::unique_ptr<Query> Parser::parseSelect() {
+    std::unique_ptr<SelectQuery> query = parseSelectBody();
+    if (!query || !finish()) return nullptr;
+    return query;
+}
 
-    query->tableName = trim(sql.substr(tableStart, parenStart - tableStart));
+std::unique_ptr<SelectQuery> Parser::parseSelectBody() {
+    auto query = std::make_unique<SelectQuery>();
+    query->distinct = acceptKeyword("DISTINCT");
 
-    size_t parenEnd = sql.find(')');
-    if (parenEnd == std::string::npos) return query;
+    if (!parseSelectList(*query) || !expectKeyword("FROM") || !parseName(query->tableName)) return nullptr;
+    if (!parseJoin(*query)) return nullptr;
 
-    std::string colDefs = sql.substr(parenStart + 1, parenEnd - parenStart - 1);
-    std::stringstream ss(colDefs);
-    std::string colDef;
+    if (acceptKeyword("WHERE") && !parseWhere(query->where)) return nullptr;
 
-    while (std::getline(ss, colDef, ',')) {
-        colDef = trim(colDef);
-        std::stringstream colSs(colDef);
-        std::string colName, colType;
-        colSs >> colName >> colType;
+    if (acceptKeyword("GROUP")) {
+        if (!expectKeyword("BY")) return nullptr;
+        query->groupBy.hasGroupBy = true;
+        do {
+            std::string col;
+            if (!parseQualifiedName(col)) return nullptr;
+            query->groupBy.columns.push_back(std::move(col));
+        } while (acceptSymbol(","));
+    }
+
+    if (acceptKeyword("HAVING")) {
+        // HAVING func(col | *) op integer
+        HavingClause& having = query->having;
+        having.hasHaving = true;
+        if (!isAggregateCall(having.func)) {
+            fail("an aggregate function");
+            return nullptr;
+        }
+        if (!parseAggregateCall(having.func, having.column) ||
+            !parseCompareOp(having.op) || !parseInt(having.value)) {
+            return nullptr;
+        }
+    }
 
-        Column col;
-        col.name = colName;
-        std::string upperType = toUpper(colType);
-        if (upperType == "INT" || upperType == "INTEGER") {
-            col.type = ColumnType::INT;
+    if (acceptKeyword("ORDER")) {
+        if (!expectKeyword("BY") || !parseQualifiedName(query->orderBy.column)) return nullptr;
+        query->orderBy.hasOrderBy = true;
+        if (acceptKeyword("DESC")) {
+            query->orderBy.order = SortOrder::DESC;
         } else {
-            col.type = ColumnType::STRING;
+            acceptKeyword("ASC");
         }
-        query->columns.push_back(col);
     }
 
+    if (acceptKeyword("LIMIT") && !parseInt(query->limit)) return nullptr;
     return query;
 }
 
-std::unique_ptr<InsertQuery> SQLParser::parseInsert(const std::string& sql) {
-    auto query = std::make_unique<InsertQuery>();
-    std::string upper = toUpper(sql);
-    size_t intoPos = upper.find("INTO") + 4;
-    size_t valuesPos = upper.find("VALUES");
-
-    if (valuesPos == std::string::npos) return query;
-
-    std::string tableAndCols = trim(sql.substr(intoPos, valuesPos - intoPos));
-
-    // Check for explicit column names: INSERT INTO table (col1, col2) VALUES ...
-    size_t colParenStart = tableAndCols.find('(');
-    if (colParenStart != std::string::npos) {
-        query->tableName = trim(tableAndCols.substr(0, colParenStart));
-        size_t colParenEnd = tableAndCols.find(')');
-        if (colParenEnd != std::string::npos) {
-            std::string colList = tableAndCols.substr(colParenStart + 1, colParenEnd - colParenStart - 1);
-            std::stringstream ss(colList);
-            std::string col;
-            while (std::getline(ss, col, ',')) {
-                query->insertColumns.push_back(trim(col));
-            }
-        }
-    } else {
-        query->tableName = tableAndCols;
-    }
-
-    size_t parenStart = sql.find('(', valuesPos);
-    size_t parenEnd = sql.find(')', parenStart);
-    if (parenStart == std::string::npos || parenEnd == std::string::npos) return query;
+std::unique_ptr<Query> Parser::parseVacuum() {
+    // VACUUM [table]
+    auto query = std::make_unique<VacuumQuery>();
+    if (tok_.type == TokenType::IDENTIFIER && !parseName(query->tableName)) return nullptr;
+    if (!finish()) return nullptr;
+    return query;
+}
 
-    std::string valueStr = sql.substr(parenStart + 1, parenEnd - parenStart - 1);
-    std::stringstream ss(valueStr);
-    std::string val;
+std::unique_ptr<Query> Parser::parsePrepare() {
+    // PREPARE name AS statement | PREPARE name FROM 'statement'
+    auto query = std::make_unique<PrepareQuery>();
+    if (!parseName(query->name)) return nullptr;
 
-    while (std::getline(ss, val, ',')) {
-        query->values.push_back(parseValue(val));
+    if (acceptKeyword("FROM")) {
+        Value text;
+        if (tok_.type != TokenType::STRING) {
+            fail("a quoted statement");
+            return nullptr;
+        }
+        if (!parseValue(text) || !finish()) return nullptr;
+        query->sql = std::get<std::string>(text);
+        return query;
     }
 
+    if (!isKeyword("AS")) {
+        fail("AS or FROM");
+        return nullptr;
+    }
+    advance();
+    if (tok_.type == TokenType::END) {
+        fail("a statement");
+        return nullptr;
+    }
+    // The statement itself is parsed when it is prepared
+    query->sql.assign(tokenizer_.source().substr(tok_.offset));
     return query;
 }
 
-std::unique_ptr<SelectQuery> SQLParser::parseSelect(const std::string& sql) {
-    auto query = std::make_unique<SelectQuery>();
-    std::string upper = toUpper(sql);
+std::unique_ptr<Query> Parser::parseExecute() {
+    // EXECUTE name [(v, ...)] | EXECUTE name USING v, ...
+    auto query = std::make_unique<ExecuteQuery>();
+    if (!parseName(query->name)) return nullptr;
 
-    // Check for DISTINCT
-    size_t selectEnd = 6;  // Length of "SELECT"
-    if (upper.find("SELECT DISTINCT") == 0) {
-        query->distinct = true;
-        selectEnd = 15;  // Length of "SELECT DISTINCT"
+    if (isSymbol("(")) {
+        if (!parseValueList(query->params)) return nullptr;
+    } else if (acceptKeyword("USING")) {
+        do {
+            Value v;
+            if (!parseValue(v)) return nullptr;
+            query->params.push_back(std::move(v));
+        } while (acceptSymbol(","));
     }
-
-    // Find FROM position
-    size_t fromPos = upper.find("FROM");
-    if (fromPos == std::string::npos) return query;
-
-    // Parse columns between SELECT [DISTINCT] and FROM
-    std::string columnsPart = trim(sql.substr(selectEnd, fromPos - selectEnd));
-
-    // Check for aggregate functions
-    parseAggregates(columnsPart, *query);
-
-    // If no aggregates, parse as regular columns
-    if (query->aggregates.empty() && columnsPart != "*") {
-        std::stringstream ss(columnsPart);
-        std::string col;
-        while (std::getline(ss, col, ',')) {
-            query->selectColumns.push_back(trim(col));
-        }
+    if (!paramSlots_.empty()) {
+        error_ = "EXECUTE parameters must be literal values";
+        return nullptr;
     }
 
-    // Check for JOIN first
-    parseJoin(sql, upper, *query);
-
-    // Find boundaries for table name
-    size_t tableEnd = upper.length();
-
-    // If there's a JOIN, table name is between FROM and JOIN
-    size_t joinPos = upper.find(" JOIN ", fromPos);
-    size_t innerJoinPos = upper.find("INNER JOIN", fromPos);
-    size_t leftJoinPos = upper.find("LEFT JOIN", fromPos);
-    size_t rightJoinPos = upper.find("RIGHT JOIN", fromPos);
-
-    size_t firstJoin = std::string::npos;
-    if (joinPos != std::string::npos) firstJoin = joinPos;
-    if (innerJoinPos != std::string::npos && (firstJoin == std::string::npos || innerJoinPos < firstJoin)) firstJoin = innerJoinPos;
-    if (leftJoinPos != std::string::npos && (firstJoin == std::string::npos || leftJoinPos < firstJoin)) firstJoin = leftJoinPos;
-    if (rightJoinPos != std::string::npos && (firstJoin == std::string::npos || rightJoinPos < firstJoin)) firstJoin = rightJoinPos;
-
-    size_t wherePos = upper.find("WHERE", fromPos);
-    size_t groupPos = upper.find("GROUP BY", fromPos);
-    size_t havingPos = upper.find("HAVING", fromPos);
-    size_t orderPos = upper.find("ORDER BY", fromPos);
-    size_t limitPos = upper.find("LIMIT", fromPos);
-
-    if (firstJoin != std::string::npos && firstJoin < tableEnd) tableEnd = firstJoin;
-    if (wherePos != std::string::npos && wherePos < tableEnd) tableEnd = wherePos;
-    if (groupPos != std::string::npos && groupPos < tableEnd) tableEnd = groupPos;
-    if (havingPos != std::string::npos && havingPos < tableEnd) tableEnd = havingPos;
-    if (orderPos != std::string::npos && orderPos < tableEnd) tableEnd = orderPos;
-    if (limitPos != std::string::npos && limitPos < tableEnd) tableEnd = limitPos;
+    if (!finish()) return nullptr;
+    return query;
+}
 
-    query->tableName = trim(sql.substr(fromPos + 4, tableEnd - fromPos - 4));
+std::unique_ptr<Query> Parser::parseDeallocate() {
+    // DEALLOCATE [PREPARE] name
+    auto query = std::make_unique<DeallocateQuery>();
+    acceptKeyword("PREPARE");
+    if (!parseName(query->name) || !finish()) return nullptr;
+    return query;
+}
 
-    // Remove trailing semicolon from table name
-    if (!query->tableName.empty() && query->tableName.back() == ';') {
-        query->tableName.pop_back();
-        query->tableName = trim(query->tableName);
+std::unique_ptr<Query> Parser::parseCopy() {
+    // COPY table [(col, ...)] FROM | TO 'path' [[WITH] (option, ...)]
+    // COPY (SELECT ...) TO 'path' [[WITH] (option, ...)]
+    auto query = std::make_unique<CopyQuery>();
+    if (acceptSymbol("(")) {
+        // The query to export becomes the left child
+        if (!expectKeyword("SELECT")) return nullptr;
+        std::unique_ptr<SelectQuery> select = parseSelectBody();
+        if (!select || !expectSymbol(")") || !expectKeyword("TO")) return nullptr;
+        query->tableName = select->tableName;
+        query->left = std::move(select);
+        query->toFile = true;
+    } else {
+        if (!parseName(query->tableName)) return nullptr;
+        if (isSymbol("(") && !parseNameList(query->columns)) return nullptr;
+        if (acceptKeyword("TO")) {
+            auto select = std::make_shared<SelectQuery>();
+            select->tableName = query->tableName;
+            select->selectColumns = query->columns;
+            query->left = std::move(select);
+            query->toFile = true;
+        } else if (!acceptKeyword("FROM")) {
+            fail("FROM or TO");
+            return nullptr;
+        }
     }
 
-    // Parse WHERE clause (with AND/OR support)
-    parseWhereClause(sql, upper, query->where);
-
-    // Parse GROUP BY
-    parseGroupBy(sql, upper, *query);
-
-    // Parse HAVING
-    parseHaving(sql, upper, *query);
-
-    // Parse ORDER BY
-    parseOrderBy(sql, upper, *query);
-
-    // Parse LIMIT
-    if (limitPos != std::string::npos) {
-        std::string limitStr = sql.substr(limitPos + 5);
-        limitStr = trim(limitStr);
-        if (!limitStr.empty() && limitStr.back() == ';') {
-            limitStr.pop_back();
-        }
-        try {
-            query->limit = std::stoi(limitStr);
-        } catch (...) {
-            query->limit = -1;
-        }
+    if (tok_.type != TokenType::STRING) {
+        fail("a quoted file name");
+        return nullptr;
     }
+    Value path;
+    if (!parseValue(path)) return nullptr;
+    query->path = std::get<std::string>(path);
 
+    if (!parseCopyOptions(*query) || !finish()) return nullptr;
     return query;
 }
 
-std::unique_ptr<DeleteQuery> SQLParser::parseDelete(const std::string& sql) {
-    auto query = std::make_unique<DeleteQuery>();
-    std::string upper = toUpper(sql);
-    size_t fromPos = upper.find("FROM") + 4;
-
-    // Find WHERE if present
-    size_t wherePos = upper.find("WHERE");
+std::unique_ptr<Query> Parser::parseExplain() {
+    // EXPLAIN [ANALYZE] SELECT ...
+    auto query = std::make_unique<ExplainQuery>();
+    query->analyze = acceptKeyword("ANALYZE");
+    if (!expectKeyword("SELECT")) return nullptr;
+    std::unique_ptr<SelectQuery> select = parseSelectBody();
+    if (!select || !finish()) return nullptr;
+    query->tableName = select->tableName;
+    query->left = std::move(select);
+    return query;
+}
 
-    if (wherePos != std::string::npos) {
-        query->tableName = trim(sql.substr(fromPos, wherePos - fromPos));
-        parseWhereClause(sql, upper, query->where);
+std::unique_ptr<Query> Parser::parseShow() {
+    // SHOW STATS | SHOW TABLE SIZES
+    auto query = std::make_unique<ShowQuery>();
+    if (acceptKeyword("TABLE")) {
+        if (!expectKeyword("SIZES")) return nullptr;
+        query->target = ShowTarget::TABLE_SIZES;
+    } else if (acceptKeyword("STATS")) {
+        query->target = ShowTarget::STATS;
     } else {
-        query->tableName = trim(sql.substr(fromPos));
-        // Remove trailing semicolon
-        if (!query->tableName.empty() && query->tableName.back() == ';') {
-            query->tableName.pop_back();
-            query->tableName = trim(query->tableName);
-        }
+        fail("STATS or TABLE SIZES");
+        return nullptr;
     }
+    if (!finish()) return nullptr;
+    return query;
+}
 
+std::unique_ptr<Query> Parser::parseTransaction(QueryType type) {
+    // BEGIN | COMMIT | ROLLBACK [TRANSACTION | WORK], START TRANSACTION
+    auto query = std::make_unique<TransactionQuery>(type);
+    if (!acceptKeyword("TRANSACTION")) acceptKeyword("WORK");
+    if (!finish()) return nullptr;
     return query;
 }
 
-std::unique_ptr<DropQuery> SQLParser::parseDropTable(const std::string& sql) {
-    auto query = std::make_unique<DropQuery>();
-    std::string upper = toUpper(sql);
-    size_t tablePos = upper.find("TABLE") + 5;
+bool Parser::parseCopyOptions(CopyQuery& query) {
+    // FORMAT CSV | BINARY, HEADER [TRUE | FALSE], DELIMITER 'c'
+    acceptKeyword("WITH");
+    if (!acceptSymbol("(")) return true;
+
+    do {
+        if (acceptKeyword("FORMAT")) {
+            if (acceptKeyword("CSV")) {
+                query.format = CopyFormat::CSV;
+            } else if (acceptKeyword("BINARY")) {
+                query.format = CopyFormat::BINARY;
+            } else {
+                return fail("CSV or BINARY");
+            }
+        } else if (acceptKeyword("HEADER")) {
+            query.header = !acceptKeyword("FALSE");
+            if (query.header) acceptKeyword("TRUE");
+        } else if (acceptKeyword("DELIMITER")) {
+            if (tok_.type != TokenType::STRING || tok_.text.size() != 1) {
+                return fail("a single-character delimiter");
+            }
+            query.delimiter = tok_.text[0];
+            advance();
+        } else {
+            return fail("FORMAT, HEADER or DELIMITER");
+        }
+    } while (acceptSymbol(","));
+    return expectSymbol(")");
+}
 
-    query->tableName = trim(sql.substr(tablePos));
-    // Remove trailing semicolon
-    if (!query->tableName.empty() && query->tableName.back() == ';') {
-        query->tableName.pop_back();
-        query->tableName = trim(query->tableName);
+// Every literal value in the order the parser met it, so that the ordinals
+// recorded in Query::paramSlots can be resolved back to their Value
+void collectWhereValues(WhereClause& where, std::vector<Value*>& out) {
+    for (auto& cond : where.conditions) {
+        if (cond.op == CompareOp::IN) {
+            for (auto& v : cond.inValues) out.push_back(&v);
+        } else {
+            out.push_back(&cond.value);
+        }
     }
-
-    return query;
 }
 
-std::unique_ptr<UpdateQuery> SQLParser::parseUpdate(const std::string& sql) {
-    auto query = std::make_unique<UpdateQuery>();
-    std::string upper = toUpper(sql);
-
-    // UPDATE table SET col = val WHERE ...
-    size_t setPos = upper.find("SET");
-    if (setPos == std::string::npos) return query;
+void collectValues(Query& query, std::vector<Value*>& out) {
+    switch (query.type) {
+        case QueryType::INSERT:
+            for (auto& row : static_cast<InsertQuery&>(query).rows) {
+                for (auto& v : row) out.push_back(&v);
+            }
+            break;
+        case QueryType::UPDATE: {
+            auto& q = static_cast<UpdateQuery&>(query);
+            for (auto& sc : q.setClauses) out.push_back(&sc.value);
+            collectWhereValues(q.where, out);
+            break;
+        }
+        case QueryType::DELETE_Q:
+            collectWhereValues(static_cast<DeleteQuery&>(query).where, out);
+            break;
+        case QueryType::SELECT:
+            collectWhereValues(static_cast<SelectQuery&>(query).where, out);
+            break;
+        default:
+            break;
+    }
+}
 
-    query->tableName = trim(sql.substr(6, setPos - 6));  // 6 = length of "UPDATE"
+} // namespace
 
-    // Find WHERE if present
-    size_t wherePos = upper.find("WHERE");
+std::unique_ptr<Query> SQLParser::parse(std::string_view sql) {
+    std::string error;
+    return parse(sql, error);
+}
 
-    std::string setClause;
-    if (wherePos != std::string::npos) {
-        setClause = sql.substr(setPos + 3, wherePos - setPos - 3);
-        parseWhereClause(sql, upper, query->where);
-    } else {
-        setClause = sql.substr(setPos + 3);
+std::unique_ptr<Query> SQLParser::parse(std::string_view sql, std::string& error) {
+    Parser parser(sql);
+    std::unique_ptr<Query> query = parser.parseStatement();
+    if (!query) {
+        error = parser.error();
+        return nullptr;
     }
+    query->paramSlots = std::move(parser.paramSlots());
+    return query;
+}
 
-    // Parse SET clauses (col = val, col2 = val2, ...)
-    setClause = trim(setClause);
-    if (!setClause.empty() && setClause.back() == ';') {
-        setClause.pop_back();
-        setClause = trim(setClause);
+bool SQLParser::bind(Query& query, const std::vector<Value>& params, std::string& error) {
+    if (params.size() != query.paramSlots.size()) {
+        error = "Statement expects " + std::to_string(query.paramSlots.size()) +
+                " parameter(s), got " + std::to_string(params.size());
+        return false;
     }
+    if (params.empty()) return true;
 
-    std::stringstream ss(setClause);
-    std::string assignment;
+    std::vector<Value*> values;
+    collectValues(query, values);
+    for (size_t i = 0; i < params.size(); ++i) {
+        *values[query.paramSlots[i]] = params[i];
+    }
+    return true;
+}
 
-    while (std::getline(ss, assignment, ',')) {
-        assignment = trim(assignment);
-        size_t eqPos = assignment.find('=');
-        if (eqPos != std::string::npos) {
-            SetClause sc;
-            sc.column = trim(assignment.substr(0, eqPos));
-            sc.value = parseValue(assignment.substr(eqPos + 1));
-            query->setClauses.push_back(sc);
+std::string SQLParser::normalize(std::string_view sql) {
+    std::string key;
+    key.reserve(sql.size());
+    Tokenizer tokenizer(sql);
+    for (Token tok = tokenizer.next(); tok.type != TokenType::END; tok = tokenizer.next()) {
+        if (tok.type == TokenType::SYMBOL && tok.text == ";") {
+            Tokenizer rest = tokenizer;
+            if (rest.next().type == TokenType::END) break;
+        }
+        if (!key.empty()) key += ' ';
+        if (tok.type == TokenType::STRING) {
+            // Keep the quotes so 'x' and x stay distinct
+            size_t end = tok.offset + tok.text.size() + 2;
+            key.append(sql.substr(tok.offset, end - tok.offset));
+        } else {
+            key.append(tok.text);
         }
     }
-
-    return query;
+    return key;
 }
 
 } // namespace nanodb
@@ -0,0 +1,120 @@
+#include "nanodb/parser/tokenizer.hpp"
+
+namespace nanodb {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isIdentStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool isIdentChar(char c) {
+    return isIdentStart(c) || isDigit(c);
+}
+
+char asciiUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+} // namespace
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (asciiUpper(a[i]) != asciiUpper(b[i])) return false;
+    }
+    return true;
+}
+
+Token Tokenizer::next() {
+    while (pos_ < sql_.size() && isSpace(sql_[pos_])) {
+        ++pos_;
+    }
+
+    Token tok;
+    tok.offset = pos_;
+    if (pos_ >= sql_.size()) {
+        tok.type = TokenType::END;
+        return tok;
+    }
+
+    size_t start = pos_;
+    char c = sql_[pos_];
+
+    if (isIdentStart(c)) {
+        while (pos_ < sql_.size() && isIdentChar(sql_[pos_])) ++pos_;
+        tok.type = TokenType::IDENTIFIER;
+        tok.text = sql_.substr(start, pos_ - start);
+        return tok;
+    }
+
+    if (isDigit(c)) {
+        while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+        // A fractional part is consumed so "1.5" stays one token
+        if (pos_ + 1 < sql_.size() && sql_[pos_] == '.' && isDigit(sql_[pos_ + 1])) {
+            ++pos_;
+            while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+        }
+        tok.type = TokenType::NUMBER;
+        tok.text = sql_.substr(start, pos_ - start);
+        return tok;
+    }
+
+    if (c == '\'' || c == '"') {
+        // A doubled quote inside the literal stands for one quote character
+        ++pos_;
+        while (pos_ < sql_.size()) {
+            if (sql_[pos_] == c) {
+                if (pos_ + 1 < sql_.size() && sql_[pos_ + 1] == c) {
+                    tok.escaped = true;
+                    pos_ += 2;
+                    continue;
+                }
+                tok.type = TokenType::STRING;
+                tok.text = sql_.substr(start + 1, pos_ - start - 1);
+                ++pos_;
+                return tok;
+            }
+            ++pos_;
+        }
+        tok.type = TokenType::INVALID;
+        tok.text = sql_.substr(start);
+        return tok;
+    }
+
+    // Two-character operators first
+    if (pos_ + 1 < sql_.size()) {
+        char n = sql_[pos_ + 1];
+        if ((c == '!' && n == '=') || (c == '<' && n == '>') ||
+            (c == '<' && n == '=') || (c == '>' && n == '=')) {
+            pos_ += 2;
+            tok.type = TokenType::SYMBOL;
+            tok.text = sql_.substr(start, 2);
+            return tok;
+        }
+    }
+
+    switch (c) {
+        case '(': case ')': case ',': case ';': case '.': case '*':
+        case '=': case '<': case '>': case '-': case '?':
+            ++pos_;
+            tok.type = TokenType::SYMBOL;
+            tok.text = sql_.substr(start, 1);
+            return tok;
+        default:
+            ++pos_;
+            tok.type = TokenType::INVALID;
+            tok.text = sql_.substr(start, 1);
+            return tok;
+    }
+}
+
+} // namespace nanodb
@@ -0,0 +1,213 @@
+#include "nanodb/server/client.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace nanodb {
+
+namespace {
+
+constexpr size_t kReadBytes = 64 * 1024;
+
+} // namespace
+
+Client::~Client() {
+    close();
+}
+
+bool Client::connectTcp(const std::string& host, uint16_t port, std::string& error) {
+    close();
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+    if (rc != 0) {
+        error = "Cannot resolve '" + host + "': " + ::gai_strerror(rc);
+        return false;
+    }
+    for (addrinfo* ai = addresses; ai && fd_ < 0; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            error = "Cannot connect to " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+            ::close(fd);
+            continue;
+        }
+        // Pipelined statements go out as soon as flush() is called
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        fd_ = fd;
+    }
+    ::freeaddrinfo(addresses);
+    return connected();
+}
+
+bool Client::connectUnix(const std::string& path, std::string& error) {
+    close();
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        error = "Invalid socket path '" + path + "'.";
+        return false;
+    }
+    path.copy(addr.sun_path, path.size());
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = "Cannot connect to '" + path + "': " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    return true;
+}
+
+void Client::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    output_.clear();
+    input_.clear();
+    inputPos_ = 0;
+    pending_ = 0;
+}
+
+void Client::send(const std::string& sql) {
+    FrameWriter(output_).text(MessageType::QUERY, sql);
+    ++pending_;
+}
+
+bool Client::flush() {
+    size_t sent = 0;
+    while (sent < output_.size()) {
+        ssize_t n = ::send(fd_, output_.data() + sent, output_.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    output_.clear();
+    return true;
+}
+
+ResultSet Client::query(const std::string& sql) {
+    send(sql);
+    return receive();
+}
+
+ResultSet Client::receive() {
+    ResultSet result(false);
+    if (!connected()) {
+        result.error("Not connected.");
+        return result;
+    }
+    if (pending_ == 0) {
+        result.error("No statement is pending.");
+        return result;
+    }
+    if (!output_.empty() && !flush()) {
+        return fail(std::move(result), std::string("Cannot send: ") + std::strerror(errno));
+    }
+
+    message_.clear();
+    std::vector<size_t> projection;
+    Row row;
+    bool haveColumns = false;
+    while (true) {
+        Frame frame;
+        size_t frameBytes = 0;
+        std::string error;
+        if (!readFrame(frame, frameBytes, error)) {
+            return fail(std::move(result), error);
+        }
+
+        FrameReader reader(frame.payload);
+        switch (frame.type) {
+            case MessageType::COLUMNS: {
+                std::vector<Column> columns;
+                if (!reader.readColumns(columns)) {
+                    return fail(std::move(result), "Malformed COLUMNS frame from server.");
+                }
+                projection.resize(columns.size());
+                std::iota(projection.begin(), projection.end(), 0);
+                row.resize(columns.size());
+                result.begin(columns, false);
+                haveColumns = true;
+                break;
+            }
+            case MessageType::ROWS: {
+                uint32_t count = 0;
+                if (!haveColumns || !reader.readU32(count)) {
+                    return fail(std::move(result), "Malformed ROWS frame from server.");
+                }
+                for (uint32_t r = 0; r < count; ++r) {
+                    for (auto& value : row) {
+                        if (!reader.readValue(value)) {
+                            return fail(std::move(result), "Malformed ROWS frame from server.");
+                        }
+                    }
+                    result.row(row, projection);
+                }
+                break;
+            }
+            case MessageType::DONE:
+                message_.assign(frame.payload);
+                inputPos_ += frameBytes;
+                --pending_;
+                return result;
+            case MessageType::ERROR:
+                result.error(std::string(frame.payload));
+                inputPos_ += frameBytes;
+                --pending_;
+                return result;
+            case MessageType::QUERY:
+                return fail(std::move(result), "Unexpected QUERY frame from server.");
+        }
+        inputPos_ += frameBytes;
+    }
+}
+
+bool Client::readFrame(Frame& frame, size_t& frameBytes, std::string& error) {
+    while (true) {
+        FrameStatus status = nextFrame(std::string_view(input_).substr(inputPos_), frame, frameBytes);
+        if (status == FrameStatus::COMPLETE) return true;
+        if (status == FrameStatus::MALFORMED) {
+            error = "Malformed frame from server.";
+            return false;
+        }
+
+        // Drop consumed frames before reading more
+        input_.erase(0, inputPos_);
+        inputPos_ = 0;
+        size_t size = input_.size();
+        input_.resize(size + kReadBytes);
+        ssize_t n = ::recv(fd_, &input_[size], kReadBytes, 0);
+        int err = errno;
+        input_.resize(size + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+        if (n == 0) {
+            error = "Connection closed by server.";
+            return false;
+        }
+        if (n < 0 && err != EINTR) {
+            error = std::string("Cannot receive: ") + std::strerror(err);
+            return false;
+        }
+    }
+}
+
+ResultSet Client::fail(ResultSet result, const std::string& error) {
+    close();
+    result.error(error);
+    return result;
+}
+
+} // namespace nanodb
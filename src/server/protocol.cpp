@@ -0,0 +1,144 @@
+#include "nanodb/server/protocol.hpp"
+
+namespace nanodb {
+
+void FrameWriter::begin(MessageType type) {
+    start_ = out_.size();
+    putU32(0);
+    putU8(static_cast<uint8_t>(type));
+}
+
+void FrameWriter::end() {
+    setU32(start_, static_cast<uint32_t>(out_.size() - start_ - 4));
+}
+
+void FrameWriter::putU32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void FrameWriter::putString(std::string_view s) {
+    putU32(static_cast<uint32_t>(s.size()));
+    out_.append(s);
+}
+
+void FrameWriter::putValue(const Value& value) {
+    if (std::holds_alternative<int>(value)) {
+        putU8(1);
+        putU32(static_cast<uint32_t>(std::get<int>(value)));
+    } else if (std::holds_alternative<std::string>(value)) {
+        putU8(2);
+        putString(std::get<std::string>(value));
+    } else {
+        putU8(0);
+    }
+}
+
+void FrameWriter::setU32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out_[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void FrameWriter::text(MessageType type, std::string_view text) {
+    begin(type);
+    out_.append(text);
+    end();
+}
+
+void FrameWriter::columns(const std::vector<Column>& columns) {
+    begin(MessageType::COLUMNS);
+    putU32(static_cast<uint32_t>(columns.size()));
+    for (const auto& col : columns) {
+        putU8(col.type == ColumnType::INT ? 0 : 1);
+        putString(col.name);
+    }
+    end();
+}
+
+FrameStatus nextFrame(std::string_view data, Frame& frame, size_t& frameBytes) {
+    if (data.size() < kFrameHeaderBytes) return FrameStatus::INCOMPLETE;
+    uint32_t length = 0;
+    FrameReader(data).readU32(length);
+    if (length == 0 || length > kMaxFrameBytes) return FrameStatus::MALFORMED;
+    uint8_t type = static_cast<uint8_t>(data[4]);
+    switch (static_cast<MessageType>(type)) {
+        case MessageType::QUERY:
+        case MessageType::COLUMNS:
+        case MessageType::ROWS:
+        case MessageType::DONE:
+        case MessageType::ERROR:
+            break;
+        default:
+            return FrameStatus::MALFORMED;
+    }
+    if (data.size() - 4 < length) return FrameStatus::INCOMPLETE;
+
+    frame.type = static_cast<MessageType>(type);
+    frame.payload = data.substr(kFrameHeaderBytes, length - 1);
+    frameBytes = length + 4;
+    return FrameStatus::COMPLETE;
+}
+
+bool FrameReader::readU8(uint8_t& out) {
+    if (pos_ + 1 > data_.size()) return false;
+    out = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+}
+
+bool FrameReader::readU32(uint32_t& out) {
+    if (pos_ + 4 > data_.size()) return false;
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+        out |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_ + i])) << (8 * i);
+    }
+    pos_ += 4;
+    return true;
+}
+
+bool FrameReader::readString(std::string& out) {
+    uint32_t length = 0;
+    if (!readU32(length) || length > data_.size() - pos_) return false;
+    out.assign(data_.substr(pos_, length));
+    pos_ += length;
+    return true;
+}
+
+bool FrameReader::readValue(Value& out) {
+    uint8_t tag = 0;
+    if (!readU8(tag)) return false;
+    if (tag == 0) {
+        out = NullValue{};
+        return true;
+    }
+    if (tag == 1) {
+        uint32_t word = 0;
+        if (!readU32(word)) return false;
+        out = static_cast<int>(word);
+        return true;
+    }
+    if (tag == 2) {
+        std::string s;
+        if (!readString(s)) return false;
+        out = std::move(s);
+        return true;
+    }
+    return false;
+}
+
+bool FrameReader::readColumns(std::vector<Column>& out) {
+    uint32_t count = 0;
+    if (!readU32(count)) return false;
+    out.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        uint8_t type = 0;
+        Column col;
+        if (!readU8(type) || type > 1 || !readString(col.name)) return false;
+        col.type = type == 0 ? ColumnType::INT : ColumnType::STRING;
+        out.push_back(std::move(col));
+    }
+    return true;
+}
+
+} // namespace nanodb
@@ -0,0 +1,533 @@
+#include "nanodb/server/server.hpp"
+#include "nanodb/server/protocol.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <sstream>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace nanodb {
+
+struct Server::Connection {
+    int fd = -1;
+    std::ostringstream messages;        // The session's statement outcomes
+    std::unique_ptr<NanoDB> session;    // Used by one worker at a time
+
+    // Event loop thread only
+    std::string input;                  // Received bytes not yet framed
+    std::string sending;                // Output being written
+    size_t sent = 0;
+    bool eof = false;                   // The client has finished sending
+    bool wantWrite = false;             // The socket was full
+    uint32_t events = 0;                // Registered with epoll
+
+    std::mutex mutex;
+    std::condition_variable drained;    // output was taken, or the connection closed
+    std::deque<std::string> statements; // Received, not yet run
+    bool scheduled = false;             // Queued for, or being served by, a worker
+    bool outputQueued = false;          // In outputReady_
+    std::string output;                 // Encoded results not yet taken for sending
+    bool closed = false;
+};
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadBytes = 64 * 1024;
+// ROWS frames are cut at about this size even before kRowsPerFrame rows
+constexpr size_t kFrameTargetBytes = 256 * 1024;
+
+// Encodes a statement's result into frames, handing each ROWS frame over
+// as soon as it is complete so that large results stream
+class ResponseSink : public RowSink {
+public:
+    using Deliver = std::function<bool(std::string&)>;
+
+    explicit ResponseSink(Deliver deliver) : writer_(frames_), deliver_(std::move(deliver)) {}
+
+    void begin(const std::vector<Column>& columns, bool) override {
+        writer_.columns(columns);
+    }
+
+    bool row(const Row& row, const std::vector<size_t>& projection) override {
+        if (batchRows_ == 0) {
+            writer_.begin(MessageType::ROWS);
+            countOffset_ = writer_.size();
+            writer_.putU32(0);
+        }
+        for (size_t idx : projection) writer_.putValue(row[idx]);
+        if (++batchRows_ < Server::kRowsPerFrame && frames_.size() < kFrameTargetBytes) return true;
+        endBatch();
+        // Stops the executor once the client is gone
+        return deliver_(frames_);
+    }
+
+    void end() override { endBatch(); }
+    void error(const std::string& message) override { error_ = message; }
+
+    // Appends the frame that ends the statement; messages is what the
+    // session printed while running it
+    void finish(std::string messages) {
+        endBatch();
+        while (!messages.empty() && messages.back() == '\n') messages.pop_back();
+        if (!error_.empty()) {
+            writer_.text(MessageType::ERROR, error_);
+        } else if (messages.compare(0, 7, "Error: ") == 0) {
+            writer_.text(MessageType::ERROR, std::string_view(messages).substr(7));
+        } else {
+            writer_.text(MessageType::DONE, messages);
+        }
+    }
+
+    std::string& frames() { return frames_; }
+
+private:
+    void endBatch() {
+        if (batchRows_ == 0) return;
+        writer_.setU32(countOffset_, static_cast<uint32_t>(batchRows_));
+        writer_.end();
+        batchRows_ = 0;
+    }
+
+    std::string frames_;
+    FrameWriter writer_;
+    Deliver deliver_;
+    size_t batchRows_ = 0;
+    size_t countOffset_ = 0;
+    std::string error_;
+};
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+Server::Server(NanoDB& db, size_t workers)
+    : db_(db)
+    , workerCount_(workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency()))
+    , wakeFd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{}
+
+Server::~Server() {
+    for (int fd : listenFds_) ::close(fd);
+    if (!unixPath_.empty()) ::unlink(unixPath_.c_str());
+    if (epollFd_ >= 0) ::close(epollFd_);
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+}
+
+bool Server::listenTcp(const std::string& host, uint16_t port, std::string& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), std::to_string(port).c_str(),
+                           &hints, &addresses);
+    if (rc != 0) {
+        error = "Cannot resolve '" + host + "': " + ::gai_strerror(rc);
+        return false;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = addresses; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            error = systemError("Cannot create socket");
+            continue;
+        }
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            break;
+        }
+        error = systemError("Cannot listen on " + host + ":" + std::to_string(port));
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0) return false;
+
+    // Port 0 asked for any free port; find out which one it got
+    sockaddr_storage bound{};
+    socklen_t length = sizeof(bound);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &length) == 0) {
+        if (bound.ss_family == AF_INET) {
+            port_ = ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        } else if (bound.ss_family == AF_INET6) {
+            port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port);
+        }
+    }
+    listenFds_.push_back(fd);
+    return true;
+}
+
+bool Server::listenUnix(const std::string& path, std::string& error) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        error = "Invalid socket path '" + path + "'.";
+        return false;
+    }
+    path.copy(addr.sun_path, path.size());
+
+    // A socket left behind by an earlier server would make bind fail
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        ::unlink(path.c_str());
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = systemError("Cannot create socket");
+        return false;
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        error = systemError("Cannot listen on '" + path + "'");
+        ::close(fd);
+        return false;
+    }
+    unixPath_ = path;
+    listenFds_.push_back(fd);
+    return true;
+}
+
+void Server::stop() {
+    stopping_.store(true);
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    (void)n;
+}
+
+bool Server::run(std::string& error) {
+    if (listenFds_.empty()) {
+        error = "Not listening on any socket.";
+        return false;
+    }
+    if (wakeFd_ < 0) {
+        error = "Cannot create eventfd.";
+        return false;
+    }
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        error = systemError("Cannot create epoll instance");
+        return false;
+    }
+    std::vector<int> watched = listenFds_;
+    watched.push_back(wakeFd_);
+    for (int fd : watched) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    workersStopping_ = false;
+    for (size_t i = 0; i < workerCount_; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    bool ok = true;
+    epoll_event events[kMaxEvents];
+    while (!stopping_.load()) {
+        int n = ::epoll_wait(epollFd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = systemError("epoll_wait failed");
+            ok = false;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                uint64_t count = 0;
+                ssize_t r = ::read(wakeFd_, &count, sizeof(count));
+                (void)r;
+                flushReady();
+                continue;
+            }
+            if (std::find(listenFds_.begin(), listenFds_.end(), fd) != listenFds_.end()) {
+                accept(fd);
+                continue;
+            }
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            ConnectionPtr conn = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close(conn);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) read(conn);
+            if (conn->fd >= 0 && (events[i].events & EPOLLOUT)) write(conn);
+        }
+    }
+
+    // Closing first releases workers waiting on output; a statement that
+    // is still running finishes, and its session goes with its worker
+    while (!connections_.empty()) {
+        ConnectionPtr conn = connections_.begin()->second;
+        close(conn);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        workersStopping_ = true;
+        queue_.clear();
+    }
+    queueReady_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+    {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        outputReady_.clear();
+    }
+    ::close(epollFd_);
+    epollFd_ = -1;
+    return ok;
+}
+
+void Server::accept(int listenFd) {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;  // Drained, or out of descriptors until a connection closes
+        }
+        // Results go out as soon as they are complete; fails harmlessly on
+        // Unix domain sockets
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        auto conn = std::make_shared<Connection>();
+        conn->fd = fd;
+        conn->session = db_.openSession(conn->messages);
+        conn->events = EPOLLIN;
+        epoll_event ev{};
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+    }
+}
+
+void Server::read(const ConnectionPtr& conn) {
+    // One read per event keeps a busy client from starving the others; the
+    // level-triggered event fires again for whatever is left
+    char buffer[kReadBytes];
+    ssize_t n = ::recv(conn->fd, buffer, sizeof(buffer), 0);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) close(conn);
+        return;
+    }
+    if (n == 0) {
+        // Statements already received still run and get their results
+        conn->eof = true;
+        updateEvents(conn);
+        closeIfDone(conn);
+        return;
+    }
+    conn->input.append(buffer, static_cast<size_t>(n));
+
+    std::vector<std::string> statements;
+    std::string_view data(conn->input);
+    size_t consumed = 0;
+    while (true) {
+        Frame frame;
+        size_t frameBytes = 0;
+        FrameStatus status = nextFrame(data.substr(consumed), frame, frameBytes);
+        if (status == FrameStatus::INCOMPLETE) break;
+        if (status == FrameStatus::MALFORMED || frame.type != MessageType::QUERY) {
+            // Not a client speaking this protocol
+            close(conn);
+            return;
+        }
+        statements.emplace_back(frame.payload);
+        consumed += frameBytes;
+    }
+    conn->input.erase(0, consumed);
+    if (statements.empty()) return;
+
+    bool idle = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        for (auto& sql : statements) conn->statements.push_back(std::move(sql));
+        idle = !conn->scheduled;
+        conn->scheduled = true;
+    }
+    if (idle) schedule(conn);
+}
+
+void Server::write(const ConnectionPtr& conn) {
+    while (true) {
+        if (conn->sent == conn->sending.size()) {
+            conn->sending.clear();
+            conn->sent = 0;
+            {
+                std::lock_guard<std::mutex> lock(conn->mutex);
+                conn->sending.swap(conn->output);
+            }
+            conn->drained.notify_all();
+            if (conn->sending.empty()) break;
+        }
+        ssize_t n = ::send(conn->fd, conn->sending.data() + conn->sent, conn->sending.size() - conn->sent,
+                           MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                conn->wantWrite = true;
+                updateEvents(conn);
+                return;
+            }
+            close(conn);
+            return;
+        }
+        conn->sent += static_cast<size_t>(n);
+    }
+    conn->wantWrite = false;
+    updateEvents(conn);
+    closeIfDone(conn);
+}
+
+void Server::closeIfDone(const ConnectionPtr& conn) {
+    if (!conn->eof || conn->sent < conn->sending.size()) return;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->scheduled || !conn->statements.empty() || !conn->output.empty()) return;
+    }
+    close(conn);
+}
+
+void Server::close(const ConnectionPtr& conn) {
+    ConnectionPtr keep = conn;  // conn may be the map's own reference
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, keep->fd, nullptr);
+    ::close(keep->fd);
+    connections_.erase(keep->fd);
+    keep->fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(keep->mutex);
+        keep->closed = true;
+        keep->statements.clear();
+        keep->output.clear();
+    }
+    keep->drained.notify_all();
+}
+
+void Server::updateEvents(const ConnectionPtr& conn) {
+    uint32_t events = 0;
+    if (!conn->eof) events |= EPOLLIN;
+    if (conn->wantWrite) events |= EPOLLOUT;
+    if (events == conn->events) return;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = conn->fd;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->events = events;
+}
+
+void Server::flushReady() {
+    std::vector<ConnectionPtr> ready;
+    {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        ready.swap(outputReady_);
+    }
+    for (const auto& conn : ready) {
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            conn->outputQueued = false;
+        }
+        if (conn->fd >= 0) write(conn);
+    }
+}
+
+void Server::workerLoop() {
+    while (true) {
+        ConnectionPtr conn;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] { return workersStopping_ || !queue_.empty(); });
+            if (workersStopping_) return;
+            conn = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        serve(conn);
+    }
+}
+
+void Server::schedule(const ConnectionPtr& conn) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queue_.push_back(conn);
+    }
+    queueReady_.notify_one();
+}
+
+void Server::serve(const ConnectionPtr& conn) {
+    std::string sql;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed || conn->statements.empty()) {
+            conn->scheduled = false;
+            return;
+        }
+        sql = std::move(conn->statements.front());
+        conn->statements.pop_front();
+    }
+
+    ResponseSink sink([this, &conn](std::string& frames) {
+        std::unique_lock<std::mutex> lock(conn->mutex);
+        return deliver(conn, lock, frames);
+    });
+    conn->session->executeSQL(sql, sink);
+    sink.finish(conn->messages.str());
+    conn->messages.str("");
+
+    // The last output and the end of the turn go together, so the event
+    // loop never sees a finished statement's connection as still busy
+    std::unique_lock<std::mutex> lock(conn->mutex);
+    deliver(conn, lock, sink.frames());
+    bool more = !conn->closed && !conn->statements.empty();
+    if (!more) conn->scheduled = false;
+    lock.unlock();
+    // To the back of the queue, so connections take turns
+    if (more) schedule(conn);
+}
+
+bool Server::deliver(const ConnectionPtr& conn, std::unique_lock<std::mutex>& lock, std::string& frames) {
+    conn->drained.wait(lock, [&] { return conn->closed || conn->output.size() < kMaxPendingOutput; });
+    if (conn->closed) {
+        frames.clear();
+        return false;
+    }
+    if (conn->output.empty()) {
+        conn->output.swap(frames);
+    } else {
+        conn->output += frames;
+    }
+    frames.clear();
+    if (!conn->outputQueued) {
+        conn->outputQueued = true;
+        {
+            std::lock_guard<std::mutex> outputLock(outputMutex_);
+            outputReady_.push_back(conn);
+        }
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+        (void)n;
+    }
+    return true;
+}
+
+} // namespace nanodb
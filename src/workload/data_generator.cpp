@@ -0,0 +1,313 @@
+#include "nanodb/workload/data_generator.hpp"
+#include "nanodb/executor/buffered_writer.hpp"
+#include "nanodb/executor/copy_executor.hpp"
+#include "nanodb/executor/dml_executor.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace nanodb {
+
+namespace {
+
+std::vector<std::string_view> split(std::string_view text, char sep) {
+    std::vector<std::string_view> parts;
+    size_t start = 0;
+    while (true) {
+        size_t pos = text.find(sep, start);
+        parts.push_back(text.substr(start, pos == std::string_view::npos ? pos : pos - start));
+        if (pos == std::string_view::npos) break;
+        start = pos + 1;
+    }
+    return parts;
+}
+
+bool parseSize(std::string_view text, size_t& out) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseDouble(std::string_view text, double& out) {
+    std::string copy(text);
+    char* end = nullptr;
+    out = std::strtod(copy.c_str(), &end);
+    return !copy.empty() && end == copy.c_str() + copy.size();
+}
+
+// dist or dist(arg[,arg])
+bool parseDistribution(std::string_view text, GeneratedColumn& col, std::string& error) {
+    std::string_view name = text;
+    std::vector<std::string_view> args;
+    size_t open = text.find('(');
+    if (open != std::string_view::npos) {
+        if (text.back() != ')') {
+            error = "Missing ')' in '" + std::string(text) + "'.";
+            return false;
+        }
+        name = text.substr(0, open);
+        args = split(text.substr(open + 1, text.size() - open - 2), ',');
+    }
+
+    bool ok = true;
+    if (name == "seq" && args.empty()) {
+        col.distribution = Distribution::SEQUENTIAL;
+    } else if (name == "uniform" && args.size() == 1) {
+        col.distribution = Distribution::UNIFORM;
+        ok = parseSize(args[0], col.cardinality);
+    } else if (name == "zipf" && (args.size() == 1 || args.size() == 2)) {
+        col.distribution = Distribution::ZIPF;
+        ok = parseSize(args[0], col.cardinality) && (args.size() == 1 || parseDouble(args[1], col.skew));
+    } else if (name == "corr" && (args.size() == 1 || args.size() == 2)) {
+        col.distribution = Distribution::CORRELATED;
+        col.source = std::string(args[0]);
+        ok = args.size() == 1 || parseSize(args[1], col.spread);
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        error = "Bad distribution '" + std::string(text) + "' (seq, uniform(N), zipf(N[,skew]), corr(col[,spread])).";
+    }
+    return ok;
+}
+
+// Samples ZIPF keys by binary search over the cumulative distribution
+class ZipfSampler {
+public:
+    ZipfSampler(size_t cardinality, double skew) : cdf_(cardinality) {
+        double sum = 0;
+        for (size_t k = 0; k < cardinality; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf_[k] = sum;
+        }
+        for (double& p : cdf_) p /= sum;
+    }
+
+    template <typename Rng>
+    size_t operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t k = std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+        return std::min(k, cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+// Per-column sampling state
+struct ColumnState {
+    std::mt19937_64 rng;
+    std::unique_ptr<ZipfSampler> zipf;
+    size_t sourceIndex = 0;
+};
+
+// Collects generated rows and appends them kLoadBatchRows at a time
+class BatchAppendSink : public RowSink {
+public:
+    BatchAppendSink(Catalog& catalog, const std::string& table) : dml_(catalog), table_(table) {}
+
+    void begin(const std::vector<Column>&, bool) override {}
+
+    bool row(const Row& row, const std::vector<size_t>&) override {
+        batch_.push_back(row);
+        if (batch_.size() >= DataGenerator::kLoadBatchRows) return flush();
+        return true;
+    }
+
+    void end() override { flush(); }
+    void error(const std::string& message) override { error_ = message; }
+
+    bool flush() {
+        if (batch_.empty() || !error_.empty()) return error_.empty();
+        std::vector<Row> rows;
+        rows.swap(batch_);
+        return dml_.appendRows(table_, {}, std::move(rows), error_);
+    }
+
+    const std::string& error() const { return error_; }
+
+private:
+    DMLExecutor dml_;
+    std::string table_;
+    std::vector<Row> batch_;
+    std::string error_;
+};
+
+} // namespace
+
+bool TableSpec::parse(std::string_view text, TableSpec& spec, std::string& error) {
+    spec = TableSpec();
+    std::vector<std::string_view> words;
+    for (std::string_view word : split(text, ' ')) {
+        if (!word.empty()) words.push_back(word);
+    }
+    if (words.empty()) {
+        error = "Empty table spec.";
+        return false;
+    }
+
+    std::vector<std::string_view> head = split(words[0], ':');
+    if (head.size() != 2 || head[0].empty() || !parseSize(head[1], spec.rows)) {
+        error = "Expected 'table:rows', got '" + std::string(words[0]) + "'.";
+        return false;
+    }
+    spec.name = std::string(head[0]);
+
+    for (size_t i = 1; i < words.size(); ++i) {
+        std::vector<std::string_view> parts = split(words[i], ':');
+        if (parts.size() != 3) {
+            error = "Expected 'column:type:distribution', got '" + std::string(words[i]) + "'.";
+            return false;
+        }
+        GeneratedColumn col;
+        col.name = std::string(parts[0]);
+        if (parts[1] == "int") {
+            col.type = ColumnType::INT;
+        } else if (parts[1] == "string") {
+            col.type = ColumnType::STRING;
+        } else {
+            error = "Unknown column type '" + std::string(parts[1]) + "' (int or string).";
+            return false;
+        }
+        if (!parseDistribution(parts[2], col, error)) return false;
+        spec.columns.push_back(std::move(col));
+    }
+    return spec.validate(error);
+}
+
+bool TableSpec::validate(std::string& error) const {
+    if (name.empty() || columns.empty()) {
+        error = "Table spec needs a name and at least one column.";
+        return false;
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const GeneratedColumn& col = columns[i];
+        if (col.name.empty()) {
+            error = "Column " + std::to_string(i + 1) + " of '" + name + "' has no name.";
+            return false;
+        }
+        if ((col.distribution == Distribution::UNIFORM || col.distribution == Distribution::ZIPF) &&
+            col.cardinality == 0) {
+            error = "Column '" + col.name + "' needs a cardinality of at least 1.";
+            return false;
+        }
+        if (col.distribution == Distribution::CORRELATED) {
+            auto source = std::find_if(columns.begin(), columns.begin() + i,
+                                       [&](const GeneratedColumn& c) { return c.name == col.source; });
+            if (source == columns.begin() + i) {
+                error = "Column '" + col.name + "' must be correlated with an earlier column, not '" +
+                        col.source + "'.";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<Column> TableSpec::schema() const {
+    std::vector<Column> schema;
+    for (const auto& col : columns) {
+        schema.push_back({col.name, col.type});
+    }
+    return schema;
+}
+
+std::string TableSpec::createSQL() const {
+    std::string sql = "CREATE TABLE " + name + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) sql += ", ";
+        sql += columns[i].name + (columns[i].type == ColumnType::INT ? " INT" : " STRING");
+    }
+    return sql + ")";
+}
+
+DataGenerator::DataGenerator(TableSpec spec, uint64_t seed) : spec_(std::move(spec)), seed_(seed) {}
+
+void DataGenerator::generate(RowSink& sink) {
+    // Each column has its own stream, so adding a column leaves the others' values unchanged
+    std::vector<ColumnState> states(spec_.columns.size());
+    for (size_t c = 0; c < spec_.columns.size(); ++c) {
+        const GeneratedColumn& col = spec_.columns[c];
+        states[c].rng.seed(seed_ * 1000003 + c);
+        if (col.distribution == Distribution::ZIPF) {
+            states[c].zipf = std::make_unique<ZipfSampler>(col.cardinality, col.skew);
+        } else if (col.distribution == Distribution::CORRELATED) {
+            for (size_t s = 0; s < c; ++s) {
+                if (spec_.columns[s].name == col.source) states[c].sourceIndex = s;
+            }
+        }
+    }
+
+    std::vector<Column> schema = spec_.schema();
+    std::vector<size_t> projection(schema.size());
+    for (size_t i = 0; i < projection.size(); ++i) projection[i] = i;
+    sink.begin(schema, false);
+
+    std::vector<size_t> keys(spec_.columns.size());
+    Row row(spec_.columns.size());
+    for (size_t r = 0; r < spec_.rows; ++r) {
+        for (size_t c = 0; c < spec_.columns.size(); ++c) {
+            const GeneratedColumn& col = spec_.columns[c];
+            ColumnState& state = states[c];
+            size_t key = 0;
+            switch (col.distribution) {
+                case Distribution::SEQUENTIAL:
+                    key = r;
+                    break;
+                case Distribution::UNIFORM:
+                    key = std::uniform_int_distribution<size_t>(0, col.cardinality - 1)(state.rng);
+                    break;
+                case Distribution::ZIPF:
+                    key = (*state.zipf)(state.rng);
+                    break;
+                case Distribution::CORRELATED:
+                    key = keys[state.sourceIndex] +
+                          std::uniform_int_distribution<size_t>(0, col.spread)(state.rng);
+                    break;
+            }
+            keys[c] = key;
+            if (col.type == ColumnType::INT) {
+                row[c] = static_cast<int>(key);
+            } else {
+                row[c] = col.name + "_" + std::to_string(key);
+            }
+        }
+        if (!sink.row(row, projection)) return;
+    }
+    sink.end();
+}
+
+bool DataGenerator::load(Catalog& catalog, std::string& error) {
+    if (!spec_.validate(error)) return false;
+    if (!catalog.createTable(spec_.name, spec_.schema())) {
+        error = "Table '" + spec_.name + "' already exists.";
+        return false;
+    }
+    BatchAppendSink sink(catalog, spec_.name);
+    generate(sink);
+    if (!sink.error().empty()) {
+        error = sink.error();
+        return false;
+    }
+    return true;
+}
+
+bool DataGenerator::writeSnapshot(const std::string& path, std::string& error) {
+    if (!spec_.validate(error)) return false;
+    BufferedWriter out;
+    if (!out.open(path)) {
+        error = "Cannot open file '" + path + "' for writing.";
+        return false;
+    }
+    BinaryWriteSink sink(out);
+    generate(sink);
+    if (!out.close()) {
+        error = "Failed writing to '" + path + "'.";
+        return false;
+    }
+    return true;
+}
+
+} // namespace nanodb